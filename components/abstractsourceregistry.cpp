@@ -42,6 +42,11 @@ QObject *AbstractSourceRegistry::createModelFromConfigGroup(const QString &/*sou
     return 0;
 }
 
+void AbstractSourceRegistry::releaseModel(QObject *model)
+{
+    delete model;
+}
+
 } // namespace Homerun
 
 #include <abstractsourceregistry.moc>
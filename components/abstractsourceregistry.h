@@ -47,6 +47,12 @@ public:
     ~AbstractSourceRegistry();
 
     virtual QObject *createModelFromConfigGroup(const QString &sourceId, const KConfigGroup &configGroup, QObject *parent);
+
+    /**
+     * Called when a model returned by createModelFromConfigGroup() is not
+     * needed anymore. Default implementation deletes the model.
+     */
+    virtual void releaseModel(QObject *model);
 };
 
 } // namespace Homerun
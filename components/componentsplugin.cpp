@@ -24,11 +24,14 @@
 
 #include <action.h>
 #include <actionmanager.h>
+#include <globalsearchmodel.h>
 #include <globalsettings.h>
 #include <helpmenuactions.h>
 #include <icondialog.h>
 #include <image.h>
 #include <messagebox.h>
+#include <modellifecyclemanager.h>
+#include <rowdatacache.h>
 #include <shadoweffect.h>
 #include <sourceregistry.h>
 #include <tabmodel.h>
@@ -39,11 +42,14 @@ void ComponentsPlugin::registerTypes(const char *uri)
     qmlRegisterType<Action>(uri, 0, 1, "Action");
     qmlRegisterType<ActionManager>(uri, 0, 1, "ActionManager");
     qmlRegisterType<ShadowEffect>(uri, 0, 1, "ShadowEffect");
+    qmlRegisterType<GlobalSearchModel>(uri, 0, 1, "GlobalSearchModel");
     qmlRegisterType<GlobalSettings>(uri, 0, 1, "GlobalSettings");
     qmlRegisterType<HelpMenuActions>(uri, 0, 1, "HelpMenuActions");
     qmlRegisterType<IconDialog>(uri, 0, 1, "IconDialog");
     qmlRegisterType<Image>(uri, 0, 1, "Image");
     qmlRegisterType<MessageBox>(uri, 0, 1, "MessageBox");
+    qmlRegisterType<ModelLifecycleManager>(uri, 0, 1, "ModelLifecycleManager");
+    qmlRegisterType<RowDataCache>(uri, 0, 1, "RowDataCache");
     qmlRegisterType<Homerun::AbstractSourceRegistry>(uri, 0, 1, "AbstractSourceRegistry");
     qmlRegisterType<Homerun::SourceRegistry>(uri, 0, 1, "SourceRegistry");
     qmlRegisterType<TabModel>(uri, 0, 1, "TabModel");
@@ -0,0 +1,173 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <configtransaction.h>
+
+// Local
+
+// KDE
+#include <KConfigGroup>
+#include <KDebug>
+
+// Qt
+#include <QCoreApplication>
+#include <QHash>
+#include <QTimer>
+
+// How long to wait after the last commit before writing the file
+static const int SYNC_DELAY = 1000;
+
+/**
+ * Keeps track of the open transactions and of the pending syncs
+ */
+class ConfigSyncScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static ConfigSyncScheduler *instance()
+    {
+        static ConfigSyncScheduler scheduler;
+        return &scheduler;
+    }
+
+    void begin(KConfig *config)
+    {
+        Entry &entry = m_entries[config];
+        if (entry.depth == 0 && !entry.sharedConfig) {
+            // Keep the config alive until it is synced
+            KSharedConfig *sharedConfig = dynamic_cast<KSharedConfig *>(config);
+            if (sharedConfig) {
+                entry.sharedConfig = KSharedConfig::Ptr(sharedConfig);
+            }
+        }
+        ++entry.depth;
+    }
+
+    void commit(KConfig *config)
+    {
+        Hash::Iterator it = m_entries.find(config);
+        Q_ASSERT(it != m_entries.end());
+        Q_ASSERT(it->depth > 0);
+        if (--it->depth > 0) {
+            return;
+        }
+        if (!it->sharedConfig) {
+            m_entries.erase(it);
+            config->sync();
+            return;
+        }
+        m_timer.start();
+    }
+
+    void flush(KConfig *config)
+    {
+        Hash::Iterator it = m_entries.find(config);
+        if (it == m_entries.end() || it->depth > 0) {
+            return;
+        }
+        m_entries.erase(it);
+        config->sync();
+    }
+
+public Q_SLOTS:
+    void flushAll()
+    {
+        Hash::Iterator it = m_entries.begin();
+        while (it != m_entries.end()) {
+            if (it->depth > 0) {
+                // Will be synced when the transaction is committed
+                ++it;
+                continue;
+            }
+            it.key()->sync();
+            it = m_entries.erase(it);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        Entry()
+        : depth(0)
+        {}
+
+        int depth;
+        KSharedConfig::Ptr sharedConfig;
+    };
+    typedef QHash<KConfig *, Entry> Hash;
+
+    Hash m_entries;
+    QTimer m_timer;
+
+    ConfigSyncScheduler()
+    {
+        m_timer.setSingleShot(true);
+        m_timer.setInterval(SYNC_DELAY);
+        connect(&m_timer, SIGNAL(timeout()), SLOT(flushAll()));
+        if (QCoreApplication::instance()) {
+            connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), SLOT(flushAll()));
+        }
+    }
+};
+
+ConfigTransaction::ConfigTransaction(const KSharedConfig::Ptr &config)
+: m_config(config.data())
+, m_committed(false)
+{
+    Q_ASSERT(m_config);
+    ConfigSyncScheduler::instance()->begin(m_config);
+}
+
+ConfigTransaction::ConfigTransaction(const KConfigGroup &group)
+: m_config(const_cast<KConfig *>(group.config()))
+, m_committed(false)
+{
+    Q_ASSERT(m_config);
+    ConfigSyncScheduler::instance()->begin(m_config);
+}
+
+ConfigTransaction::~ConfigTransaction()
+{
+    if (!m_committed) {
+        commit();
+    }
+}
+
+void ConfigTransaction::commit()
+{
+    if (m_committed) {
+        kWarning() << "Transaction has already been committed";
+        return;
+    }
+    m_committed = true;
+    ConfigSyncScheduler::instance()->commit(m_config);
+}
+
+void ConfigTransaction::flush(KConfig *config)
+{
+    ConfigSyncScheduler::instance()->flush(config);
+}
+
+void ConfigTransaction::flushAll()
+{
+    ConfigSyncScheduler::instance()->flushAll();
+}
+
+#include <configtransaction.moc>
@@ -0,0 +1,75 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CONFIGTRANSACTION_H
+#define CONFIGTRANSACTION_H
+
+// Local
+
+// Qt
+
+// KDE
+#include <KSharedConfig>
+
+class KConfigGroup;
+
+/**
+ * Groups changes to a configuration so that they are written to disk at
+ * once.
+ *
+ * Writes made while a transaction is alive are not synced. When the last
+ * transaction on a configuration is committed, a sync is scheduled a short
+ * time later, so that a burst of changes, for example a tab being dragged
+ * around, results in a single write of the file. Pending syncs are flushed
+ * when the application quits.
+ *
+ * Transactions can be nested. A transaction is committed when it is
+ * destroyed, if commit() has not been called before.
+ *
+ * Only KSharedConfig instances can be kept alive until the delayed sync:
+ * other KConfig instances are synced as soon as the last transaction is
+ * committed.
+ */
+class ConfigTransaction
+{
+public:
+    explicit ConfigTransaction(const KSharedConfig::Ptr &config);
+    explicit ConfigTransaction(const KConfigGroup &group);
+    ~ConfigTransaction();
+
+    void commit();
+
+    /**
+     * Immediately syncs @p config if a sync is pending for it
+     */
+    static void flush(KConfig *config);
+
+    /**
+     * Immediately syncs all configurations with a pending sync
+     */
+    static void flushAll();
+
+private:
+    KConfig *m_config;
+    bool m_committed;
+
+    Q_DISABLE_COPY(ConfigTransaction)
+};
+
+#endif /* CONFIGTRANSACTION_H */
@@ -0,0 +1,389 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <globalsearchmodel.h>
+
+// Local
+#include <searchable.h>
+
+// KDE
+#include <KDebug>
+
+// Qt
+#include <QFutureWatcher>
+#include <QSharedPointer>
+#include <QtConcurrentRun>
+
+using namespace Homerun;
+
+static const int DEFAULT_MAX_RESULTS = 50;
+
+typedef QList<SearchResult> SearchResultList;
+
+struct GlobalSearchSource
+{
+    GlobalSearchSource(QAbstractItemModel *model_, Searchable *searchable_, QObject *parent)
+    : model(model_)
+    , searchable(searchable_)
+    , taskOutdated(true)
+    , watcher(new QFutureWatcher<SearchResultList>(parent))
+    {}
+
+    ~GlobalSearchSource()
+    {
+        // Deleting the watcher does not wait for the search: the worker
+        // keeps a reference to the task until it returns
+        delete watcher;
+    }
+
+    QAbstractItemModel *model;
+    Searchable *searchable;
+    QSharedPointer<SearchTask> task;
+    bool taskOutdated;
+    QFutureWatcher<SearchResultList> *watcher;
+    // The query of the running search, or of the last one
+    SearchQuery query;
+    SearchResultList results;
+};
+
+static SearchResultList runSearchTask(QSharedPointer<SearchTask> task, SearchQuery query)
+{
+    if (query.isCanceled()) {
+        return SearchResultList();
+    }
+    return task->run(query);
+}
+
+GlobalSearchModel::GlobalSearchModel(QObject *parent)
+: QAbstractListModel(parent)
+, m_maxResults(DEFAULT_MAX_RESULTS)
+, m_running(false)
+{
+    connect(this, SIGNAL(modelReset()), SIGNAL(countChanged()));
+}
+
+GlobalSearchModel::~GlobalSearchModel()
+{
+    Q_FOREACH(GlobalSearchSource *source, m_sources) {
+        source->query.cancel();
+    }
+    qDeleteAll(m_sources);
+}
+
+QString GlobalSearchModel::query() const
+{
+    return m_query;
+}
+
+void GlobalSearchModel::setQuery(const QString &query)
+{
+    if (m_query == query) {
+        return;
+    }
+    m_query = query;
+    startSearches();
+    queryChanged(m_query);
+}
+
+int GlobalSearchModel::maxResults() const
+{
+    return m_maxResults;
+}
+
+void GlobalSearchModel::setMaxResults(int maxResults)
+{
+    if (m_maxResults == maxResults) {
+        return;
+    }
+    m_maxResults = maxResults;
+    startSearches();
+    maxResultsChanged(m_maxResults);
+}
+
+int GlobalSearchModel::count() const
+{
+    return m_matches.count();
+}
+
+bool GlobalSearchModel::running() const
+{
+    return m_running;
+}
+
+QObject *GlobalSearchModel::containment() const
+{
+    return m_containment;
+}
+
+void GlobalSearchModel::setContainment(QObject *containment)
+{
+    m_containment = containment;
+    Q_FOREACH(GlobalSearchSource *source, m_sources) {
+        if (source->model->metaObject()->indexOfProperty("containment") != -1) {
+            source->model->setProperty("containment", QVariant::fromValue(containment));
+        }
+    }
+}
+
+bool GlobalSearchModel::addModel(QObject *object)
+{
+    QAbstractItemModel *model = qobject_cast<QAbstractItemModel *>(object);
+    Searchable *searchable = qobject_cast<Searchable *>(object);
+    if (!model || !searchable) {
+        kWarning() << object << "is not a searchable model";
+        return false;
+    }
+    if (sourceForModel(model)) {
+        return true;
+    }
+
+    GlobalSearchSource *source = new GlobalSearchSource(model, searchable, this);
+    connect(source->watcher, SIGNAL(finished()), SLOT(slotSearchFinished()));
+
+    connect(model, SIGNAL(modelReset()), SLOT(slotModelChanged()));
+    connect(model, SIGNAL(layoutChanged()), SLOT(slotModelChanged()));
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), SLOT(slotModelChanged()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), SLOT(slotModelChanged()));
+    connect(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), SLOT(slotModelChanged()));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), SLOT(slotModelChanged()));
+    connect(model, SIGNAL(destroyed(QObject *)), SLOT(slotModelDestroyed(QObject *)));
+
+    m_sources << source;
+    updateRoleNames();
+    if (m_containment && model->metaObject()->indexOfProperty("containment") != -1) {
+        model->setProperty("containment", QVariant::fromValue(m_containment.data()));
+    }
+    startSearch(source);
+    return true;
+}
+
+void GlobalSearchModel::removeModel(QObject *model)
+{
+    GlobalSearchSource *source = sourceForModel(model);
+    if (!source) {
+        return;
+    }
+    disconnect(model, 0, this, 0);
+    deleteSource(source);
+    updateRoleNames();
+    updateMatches();
+    updateRunning();
+}
+
+bool GlobalSearchModel::trigger(int row, const QString &actionId, const QVariant &actionArgument)
+{
+    if (row < 0 || row >= m_matches.count()) {
+        kWarning() << "Invalid row" << row;
+        return false;
+    }
+    const QPersistentModelIndex &index = m_matches.at(row).index;
+    if (!index.isValid()) {
+        // The row has been removed since the search
+        return false;
+    }
+    QAbstractItemModel *model = const_cast<QAbstractItemModel *>(index.model());
+    bool close = false;
+    bool ok = QMetaObject::invokeMethod(model, "trigger",
+        Q_RETURN_ARG(bool, close),
+        Q_ARG(int, index.row()),
+        Q_ARG(QString, actionId),
+        Q_ARG(QVariant, actionArgument));
+    if (!ok) {
+        kWarning() << "Failed to call trigger() on" << model;
+    }
+    return close;
+}
+
+int GlobalSearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_matches.count();
+}
+
+QVariant GlobalSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (index.parent().isValid() || index.row() < 0 || index.row() >= m_matches.count()) {
+        return QVariant();
+    }
+    return m_matches.at(index.row()).index.data(role);
+}
+
+GlobalSearchSource *GlobalSearchModel::sourceForModel(QObject *model) const
+{
+    Q_FOREACH(GlobalSearchSource *source, m_sources) {
+        if (source->model == model) {
+            return source;
+        }
+    }
+    return 0;
+}
+
+void GlobalSearchModel::startSearch(GlobalSearchSource *source)
+{
+    if (source->watcher->isRunning()) {
+        // slotSearchFinished() starts again once the worker returns, we
+        // cannot run two searches on the same task
+        source->query.cancel();
+        return;
+    }
+    if (m_query.isEmpty()) {
+        source->query = SearchQuery();
+        if (!source->results.isEmpty()) {
+            source->results.clear();
+            updateMatches();
+        }
+        return;
+    }
+    if (source->taskOutdated) {
+        source->task = QSharedPointer<SearchTask>(source->searchable->createSearchTask());
+        source->taskOutdated = false;
+    }
+    source->query = SearchQuery(m_query, m_maxResults);
+    source->watcher->setFuture(QtConcurrent::run(runSearchTask, source->task, source->query));
+    updateRunning();
+}
+
+void GlobalSearchModel::startSearches()
+{
+    Q_FOREACH(GlobalSearchSource *source, m_sources) {
+        startSearch(source);
+    }
+}
+
+void GlobalSearchModel::slotSearchFinished()
+{
+    GlobalSearchSource *source = 0;
+    Q_FOREACH(GlobalSearchSource *item, m_sources) {
+        if (item->watcher == sender()) {
+            source = item;
+            break;
+        }
+    }
+    if (!source) {
+        return;
+    }
+    const SearchQuery &query = source->query;
+    if (query.isCanceled() || source->taskOutdated
+        || query.text() != m_query || query.maxResults() != m_maxResults)
+    {
+        // Results are obsolete
+        startSearch(source);
+    } else {
+        source->results = source->watcher->result();
+        updateMatches();
+    }
+    updateRunning();
+}
+
+void GlobalSearchModel::slotModelChanged()
+{
+    GlobalSearchSource *source = sourceForModel(sender());
+    if (!source) {
+        return;
+    }
+    source->taskOutdated = true;
+    if (!source->results.isEmpty()) {
+        // Rows of the results may not exist anymore
+        source->results.clear();
+        updateMatches();
+    }
+    if (!m_query.isEmpty()) {
+        startSearch(source);
+    }
+}
+
+void GlobalSearchModel::slotModelDestroyed(QObject *model)
+{
+    GlobalSearchSource *source = sourceForModel(model);
+    if (!source) {
+        return;
+    }
+    deleteSource(source);
+    updateMatches();
+    updateRunning();
+}
+
+void GlobalSearchModel::deleteSource(GlobalSearchSource *source)
+{
+    source->query.cancel();
+    m_sources.removeOne(source);
+    delete source;
+}
+
+bool GlobalSearchModel::matchGreaterThan(const Match &m1, const Match &m2)
+{
+    return m1.score > m2.score;
+}
+
+void GlobalSearchModel::updateMatches()
+{
+    QList<Match> matches;
+    Q_FOREACH(const GlobalSearchSource *source, m_sources) {
+        Q_FOREACH(const SearchResult &result, source->results) {
+            Match match;
+            match.index = source->model->index(result.row, 0);
+            match.score = result.score;
+            matches << match;
+        }
+    }
+    // Stable, so that equally relevant rows keep the order of the models
+    qStableSort(matches.begin(), matches.end(), matchGreaterThan);
+    if (m_maxResults >= 0 && matches.count() > m_maxResults) {
+        matches.erase(matches.begin() + m_maxResults, matches.end());
+    }
+
+    beginResetModel();
+    m_matches = matches;
+    endResetModel();
+}
+
+void GlobalSearchModel::updateRunning()
+{
+    bool running = false;
+    Q_FOREACH(const GlobalSearchSource *source, m_sources) {
+        if (source->watcher->isRunning()) {
+            running = true;
+            break;
+        }
+    }
+    if (m_running != running) {
+        m_running = running;
+        runningChanged(m_running);
+    }
+}
+
+void GlobalSearchModel::updateRoleNames()
+{
+    QHash<int, QByteArray> roles;
+    Q_FOREACH(const GlobalSearchSource *source, m_sources) {
+        QHash<int, QByteArray> modelRoles = source->model->roleNames();
+        QHash<int, QByteArray>::ConstIterator it = modelRoles.constBegin(), end = modelRoles.constEnd();
+        for (; it != end; ++it) {
+            roles.insert(it.key(), it.value());
+        }
+    }
+    beginResetModel();
+    setRoleNames(roles);
+    endResetModel();
+}
+
+#include <globalsearchmodel.moc>
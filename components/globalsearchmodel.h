@@ -0,0 +1,128 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef GLOBALSEARCHMODEL_H
+#define GLOBALSEARCHMODEL_H
+
+// Local
+
+// Qt
+#include <QAbstractListModel>
+#include <QList>
+#include <QPersistentModelIndex>
+#include <QPointer>
+
+// KDE
+
+struct GlobalSearchSource;
+
+/**
+ * Searches several models with a single query and merges their results.
+ *
+ * Models are searched in parallel, in worker threads, through the
+ * Homerun::Searchable interface. Results are merged by relevance as soon as
+ * each model is done, and only the maxResults most relevant rows are kept.
+ *
+ * When the query changes while a search is running, the running search is
+ * canceled and the new one starts as soon as it returns.
+ *
+ * Rows expose the roles of the model they come from, and trigger() is
+ * forwarded to it.
+ */
+class GlobalSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    /**
+     * Defaults to 50. Set it to -1 to keep all the matching rows.
+     */
+    Q_PROPERTY(int maxResults READ maxResults WRITE setMaxResults NOTIFY maxResultsChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    /**
+     * Forwarded to the searched models which have a containment property
+     */
+    Q_PROPERTY(QObject *containment READ containment WRITE setContainment)
+
+public:
+    explicit GlobalSearchModel(QObject *parent = 0);
+    ~GlobalSearchModel();
+
+    QString query() const;
+    void setQuery(const QString &query);
+
+    int maxResults() const;
+    void setMaxResults(int maxResults);
+
+    int count() const;
+
+    bool running() const;
+
+    QObject *containment() const;
+    void setContainment(QObject *containment);
+
+    /**
+     * Adds @p model to the searched models.
+     * @return false if @p model does not implement Homerun::Searchable
+     */
+    Q_INVOKABLE bool addModel(QObject *model);
+
+    Q_INVOKABLE void removeModel(QObject *model);
+
+    Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+Q_SIGNALS:
+    void queryChanged(const QString &);
+    void maxResultsChanged(int);
+    void countChanged();
+    void runningChanged(bool);
+
+private Q_SLOTS:
+    void slotSearchFinished();
+    void slotModelChanged();
+    void slotModelDestroyed(QObject *);
+
+private:
+    struct Match {
+        QPersistentModelIndex index;
+        int score;
+    };
+
+    QString m_query;
+    int m_maxResults;
+    bool m_running;
+    QPointer<QObject> m_containment;
+    QList<GlobalSearchSource *> m_sources;
+    QList<Match> m_matches;
+
+    GlobalSearchSource *sourceForModel(QObject *model) const;
+    void startSearch(GlobalSearchSource *source);
+    void startSearches();
+    void deleteSource(GlobalSearchSource *source);
+    void updateMatches();
+    void updateRunning();
+    void updateRoleNames();
+
+    static bool matchGreaterThan(const Match &m1, const Match &m2);
+};
+
+#endif /* GLOBALSEARCHMODEL_H */
@@ -0,0 +1,248 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <iconpixmapcache.h>
+
+// Local
+
+// libhomerun
+#include <trace.h>
+
+// KDE
+#include <KDebug>
+#include <KIcon>
+#include <KIconLoader>
+
+// Qt
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QtConcurrentRun>
+
+// Cost is in KB of pixel data
+static const int MAX_COST = 32 * 1024;
+
+static int pixmapCost(const QPixmap &pixmap)
+{
+    return qMax(pixmap.width() * pixmap.height() * 4 / 1024, 1);
+}
+
+/**
+ * Rasterizes the icon file @p path at size @p extent. Only uses classes which
+ * are safe to use outside of the GUI thread.
+ */
+static QImage renderIcon(const QString &path, int extent)
+{
+    Homerun::TraceSpan span("IconPixmapCache renderIcon", path);
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "svg" || suffix == "svgz") {
+        QSvgRenderer renderer(path);
+        if (!renderer.isValid()) {
+            kWarning() << "Invalid svg" << path;
+            return QImage();
+        }
+        QImage image(extent, extent, QImage::Format_ARGB32_Premultiplied);
+        image.fill(0);
+        QSizeF size = renderer.defaultSize();
+        size.scale(extent, extent, Qt::KeepAspectRatio);
+        QPainter painter(&image);
+        renderer.render(&painter, QRectF(QPointF((extent - size.width()) / 2, (extent - size.height()) / 2), size));
+        return image;
+    }
+
+    QImageReader reader(path);
+    QSize size = reader.size();
+    if (size.isValid() && (size.width() > extent || size.height() > extent)) {
+        // Let the reader downscale, this is faster for formats which support it
+        size.scale(extent, extent, Qt::KeepAspectRatio);
+        reader.setScaledSize(size);
+    }
+    QImage image = reader.read();
+    if (image.isNull()) {
+        kWarning() << "Failed to read" << path << reader.errorString();
+        return QImage();
+    }
+    if (image.width() < extent && image.height() < extent) {
+        image = image.scaled(extent, extent, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+IconPixmapCache *IconPixmapCache::instance()
+{
+    static IconPixmapCache cache;
+    return &cache;
+}
+
+IconPixmapCache::IconPixmapCache()
+{
+    m_cache.setMaxCost(MAX_COST);
+}
+
+QString IconPixmapCache::iconKey(const QString &name, QIcon::Mode mode)
+{
+    return QString::number(int(mode)) + ':' + name;
+}
+
+QString IconPixmapCache::key(const QString &name, int extent, QIcon::Mode mode)
+{
+    return QString::number(extent) + ':' + iconKey(name, mode);
+}
+
+QPixmap IconPixmapCache::pixmap(const QString &name, int extent, QIcon::Mode mode, bool *exact)
+{
+    *exact = false;
+    if (name.isEmpty() || extent <= 0) {
+        return QPixmap();
+    }
+    PixmapForExtent *pixmaps = m_cache.object(iconKey(name, mode));
+    if (pixmaps) {
+        auto it = pixmaps->constFind(extent);
+        if (it != pixmaps->constEnd()) {
+            *exact = true;
+            return it.value();
+        }
+    }
+
+    const QString requestKey = key(name, extent, mode);
+    if (!m_pendingWatchers.contains(requestKey)) {
+        // Finding the file is a theme lookup which must happen in the GUI
+        // thread, but it is cached by KIconLoader. Rasterizing is what is
+        // expensive.
+        QString path;
+        if (mode == QIcon::Normal) {
+            path = QFileInfo(name).isAbsolute()
+                ? name
+                : KIconLoader::global()->iconPath(name, -extent, true /* canReturnNull */);
+        }
+        if (path.isEmpty()) {
+            // Not a theme icon or it needs KIconLoader effects: let KIcon
+            // handle it
+            QPixmap pixmap = KIcon(name).pixmap(extent, mode);
+            insert(name, extent, mode, pixmap);
+            *exact = true;
+            return pixmap;
+        }
+        QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+        watcher->setProperty("name", name);
+        watcher->setProperty("extent", extent);
+        watcher->setProperty("mode", int(mode));
+        connect(watcher, SIGNAL(finished()), SLOT(slotRenderFinished()));
+        watcher->setFuture(QtConcurrent::run(renderIcon, path, extent));
+        m_pendingWatchers.insert(requestKey, watcher);
+    }
+    return closestPixmap(name, extent, mode);
+}
+
+QPixmap IconPixmapCache::closestPixmap(const QString &name, int extent, QIcon::Mode mode)
+{
+    PixmapForExtent *pixmaps = m_cache.object(iconKey(name, mode));
+    if (!pixmaps || pixmaps->isEmpty()) {
+        return QPixmap();
+    }
+    // Prefer the smallest bigger size, downscaling looks better
+    auto it = pixmaps->lowerBound(extent);
+    if (it == pixmaps->end()) {
+        --it;
+    }
+    return it.value();
+}
+
+void IconPixmapCache::insert(const QString &name, int extent, QIcon::Mode mode, const QPixmap &pixmap)
+{
+    const QString iconKey = IconPixmapCache::iconKey(name, mode);
+    PixmapForExtent *pixmaps = m_cache.take(iconKey);
+    if (!pixmaps) {
+        pixmaps = new PixmapForExtent;
+    }
+    pixmaps->insert(extent, pixmap);
+    int cost = 0;
+    Q_FOREACH(const QPixmap &pix, *pixmaps) {
+        cost += pixmapCost(pix);
+    }
+    m_cache.insert(iconKey, pixmaps, cost);
+}
+
+void IconPixmapCache::addWaiter(const QString &key, QObject *receiver, const char *member)
+{
+    Waiter waiter;
+    waiter.receiver = receiver;
+    waiter.member = member;
+    m_waiters[key] << waiter;
+}
+
+void IconPixmapCache::removeWaiter(const QString &key, QObject *receiver)
+{
+    auto it = m_waiters.find(key);
+    if (it == m_waiters.end()) {
+        return;
+    }
+    QList<Waiter> &waiters = it.value();
+    for (int idx = waiters.count() - 1; idx >= 0; --idx) {
+        // Also drop waiters which have been deleted
+        if (waiters.at(idx).receiver == receiver || !waiters.at(idx).receiver) {
+            waiters.removeAt(idx);
+        }
+    }
+    if (waiters.isEmpty()) {
+        m_waiters.erase(it);
+    }
+}
+
+int IconPixmapCache::totalCost() const
+{
+    return m_cache.totalCost();
+}
+
+int IconPixmapCache::maxCost() const
+{
+    return m_cache.maxCost();
+}
+
+void IconPixmapCache::slotRenderFinished()
+{
+    QFutureWatcher<QImage> *watcher = static_cast<QFutureWatcher<QImage> *>(sender());
+    const QString name = watcher->property("name").toString();
+    const int extent = watcher->property("extent").toInt();
+    const QIcon::Mode mode = QIcon::Mode(watcher->property("mode").toInt());
+    const QString requestKey = key(name, extent, mode);
+    m_pendingWatchers.remove(requestKey);
+    watcher->deleteLater();
+
+    QPixmap pixmap;
+    QImage image = watcher->result();
+    if (image.isNull()) {
+        pixmap = KIcon(name).pixmap(extent, mode);
+    } else {
+        pixmap = QPixmap::fromImage(image);
+    }
+    insert(name, extent, mode, pixmap);
+
+    const QList<Waiter> waiters = m_waiters.take(requestKey);
+    Q_FOREACH(const Waiter &waiter, waiters) {
+        if (waiter.receiver) {
+            QMetaObject::invokeMethod(waiter.receiver, waiter.member.constData(), Q_ARG(QString, requestKey));
+        }
+    }
+}
+
+#include <iconpixmapcache.moc>
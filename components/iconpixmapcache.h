@@ -0,0 +1,111 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ICONPIXMAPCACHE_H
+#define ICONPIXMAPCACHE_H
+
+// Local
+
+// Qt
+#include <QCache>
+#include <QHash>
+#include <QIcon>
+#include <QMap>
+#include <QObject>
+#include <QPixmap>
+#include <QPointer>
+
+// KDE
+
+template <class T> class QFutureWatcher;
+
+/**
+ * A process-wide cache of icon pixmaps, keyed by icon name, size and mode.
+ *
+ * Icons which are not in the cache yet are rasterized on a worker thread.
+ * Until then, pixmap() returns the closest size available for the icon, if
+ * any. Objects registered with addWaiter() are notified once the requested
+ * size is available.
+ */
+class IconPixmapCache : public QObject
+{
+    Q_OBJECT
+public:
+    static IconPixmapCache *instance();
+
+    /**
+     * Returns the pixmap of icon @p name at size @p extent. If it is not
+     * cached yet, rasterizing it is scheduled and the closest cached size is
+     * returned instead, or a null pixmap if there is none. @p exact is set to
+     * true if the returned pixmap is the requested one.
+     */
+    QPixmap pixmap(const QString &name, int extent, QIcon::Mode mode, bool *exact);
+
+    static QString key(const QString &name, int extent, QIcon::Mode mode);
+
+    /**
+     * Calls the slot @p member of @p receiver, with @p key as argument, when
+     * the pixmap identified by @p key, as returned by key(), is in the cache.
+     * @p member is a slot name, for example "slotPixmapReady". Each waiter is
+     * called once.
+     */
+    void addWaiter(const QString &key, QObject *receiver, const char *member);
+
+    /**
+     * Cancels a call registered with addWaiter()
+     */
+    void removeWaiter(const QString &key, QObject *receiver);
+
+    /**
+     * Total cost of the cached pixmaps, in KB of pixel data. Used by tests.
+     */
+    int totalCost() const;
+
+    /**
+     * Maximum value of totalCost(). Used by tests.
+     */
+    int maxCost() const;
+
+private Q_SLOTS:
+    void slotRenderFinished();
+
+private:
+    IconPixmapCache();
+
+    typedef QMap<int, QPixmap> PixmapForExtent;
+
+    // Icon name and mode => pixmaps of this icon, by size
+    QCache<QString, PixmapForExtent> m_cache;
+    // Watchers of the icons being rasterized, by key
+    QHash<QString, QFutureWatcher<QImage> *> m_pendingWatchers;
+
+    struct Waiter
+    {
+        QPointer<QObject> receiver;
+        QByteArray member;
+    };
+    // Objects to notify when an icon has been rasterized, by key
+    QHash<QString, QList<Waiter> > m_waiters;
+
+    static QString iconKey(const QString &name, QIcon::Mode mode);
+    void insert(const QString &name, int extent, QIcon::Mode mode, const QPixmap &pixmap);
+    QPixmap closestPixmap(const QString &name, int extent, QIcon::Mode mode);
+};
+
+#endif /* ICONPIXMAPCACHE_H */
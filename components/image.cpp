@@ -21,6 +21,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <image.h>
 
 // Local
+#include <iconpixmapcache.h>
+
+// libhomerun
+#include <trace.h>
 
 // KDE
 #include <KDebug>
@@ -38,6 +42,9 @@ Image::Image(QDeclarativeItem *parent)
 
 Image::~Image()
 {
+    if (!m_pendingKey.isEmpty()) {
+        IconPixmapCache::instance()->removeWaiter(m_pendingKey, this);
+    }
 }
 
 QVariant Image::source() const
@@ -57,10 +64,24 @@ void Image::setSource(const QVariant &source)
 
 void Image::reload()
 {
+    Homerun::TraceSpan span("Image::reload", Homerun::Trace::isEnabled() ? m_source.toString() : QString());
     const int extent = qMin(width(), height());
-    if (m_source.canConvert<QString>()) {
-        KIcon icon(m_source.toString());
-        m_pixmap = icon.pixmap(extent);
+    if (!m_pendingKey.isEmpty()) {
+        IconPixmapCache::instance()->removeWaiter(m_pendingKey, this);
+        m_pendingKey.clear();
+    }
+    if (extent <= 0) {
+        m_pixmap = QPixmap();
+    } else if (m_source.canConvert<QString>()) {
+        const QString name = m_source.toString();
+        bool exact;
+        m_pixmap = IconPixmapCache::instance()->pixmap(name, extent, QIcon::Normal, &exact);
+        if (!exact) {
+            // Show the closest size, or a placeholder, until the icon has
+            // been rendered
+            m_pendingKey = IconPixmapCache::key(name, extent, QIcon::Normal);
+            IconPixmapCache::instance()->addWaiter(m_pendingKey, this, "slotPixmapReady");
+        }
     } else if (m_source.canConvert<QIcon>()) {
         QIcon icon = m_source.value<QIcon>();
         m_pixmap = icon.pixmap(extent);
@@ -82,15 +103,44 @@ void Image::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry
     }
 }
 
+void Image::slotPixmapReady(const QString &key)
+{
+    if (key == m_pendingKey) {
+        reload();
+    }
+}
+
 void Image::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
 {
+    const QRect &rect = option->rect;
     if (m_pixmap.isNull()) {
+        if (!m_pendingKey.isEmpty()) {
+            // Placeholder while the icon is being rendered
+            const int extent = qMin(rect.width(), rect.height()) / 2;
+            QColor color = option->palette.color(QPalette::Text);
+            color.setAlphaF(0.1);
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->setPen(Qt::NoPen);
+            painter->setBrush(color);
+            painter->drawEllipse(QRect(
+                rect.x() + (rect.width() - extent) / 2,
+                rect.y() + (rect.height() - extent) / 2,
+                extent, extent));
+        }
         return;
     }
-    const QRect &rect = option->rect;
-    painter->drawPixmap(
-        rect.x() + (rect.width() - m_pixmap.width())/ 2,
-        rect.y() + (rect.height() - m_pixmap.height()) / 2,
+    const int extent = qMin(rect.width(), rect.height());
+    QSize size = m_pixmap.size();
+    if (!m_pendingKey.isEmpty()) {
+        // We got a pixmap of a different size from the cache, stretch it
+        // until the right one is ready
+        size.scale(extent, extent, Qt::KeepAspectRatio);
+        painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    }
+    painter->drawPixmap(QRect(
+        rect.x() + (rect.width() - size.width()) / 2,
+        rect.y() + (rect.height() - size.height()) / 2,
+        size.width(), size.height()),
         m_pixmap);
 }
 
@@ -51,9 +51,14 @@ Q_SIGNALS:
 protected:
     void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
 
+private Q_SLOTS:
+    void slotPixmapReady(const QString &key);
+
 private:
     QVariant m_source;
     QPixmap m_pixmap;
+    // Key of the pixmap we are waiting for in IconPixmapCache
+    QString m_pendingKey;
 
     void reload();
 };
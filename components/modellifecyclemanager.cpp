@@ -0,0 +1,257 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <modellifecyclemanager.h>
+
+// Local
+#include <sourcemodel.h>
+#include <tabmodel.h>
+
+// KDE
+#include <KDebug>
+
+// Qt
+#include <QMap>
+#include <QTimer>
+
+static const int EVICT_CHECK_INTERVAL = 60 * 1000;
+// Wait for the tab switch to be over before preloading
+static const int PRELOAD_DELAY = 1000;
+// Let events be processed between two preloaded tabs
+static const int PRELOAD_INTERVAL = 200;
+
+static const int DEFAULT_IDLE_TIMEOUT = 15;
+static const int DEFAULT_ROW_BUDGET = 20000;
+
+ModelLifecycleManager::ModelLifecycleManager(QObject *parent)
+: QObject(parent)
+, m_tabModel(0)
+, m_currentTab(-1)
+, m_idleTimeout(DEFAULT_IDLE_TIMEOUT)
+, m_rowBudget(DEFAULT_ROW_BUDGET)
+, m_preloadAdjacentTabs(true)
+, m_evictTimer(new QTimer(this))
+, m_preloadTimer(new QTimer(this))
+{
+    m_clock.start();
+
+    m_evictTimer->setInterval(EVICT_CHECK_INTERVAL);
+    connect(m_evictTimer, SIGNAL(timeout()), SLOT(evictModels()));
+    m_evictTimer->start();
+
+    m_preloadTimer->setSingleShot(true);
+    connect(m_preloadTimer, SIGNAL(timeout()), SLOT(preloadNextTab()));
+}
+
+ModelLifecycleManager::~ModelLifecycleManager()
+{
+}
+
+QObject *ModelLifecycleManager::tabModel() const
+{
+    return m_tabModel;
+}
+
+void ModelLifecycleManager::setTabModel(QObject *model)
+{
+    TabModel *tabModel = qobject_cast<TabModel *>(model);
+    if (model && !tabModel) {
+        kWarning() << "Not a TabModel" << model;
+        return;
+    }
+    if (m_tabModel == tabModel) {
+        return;
+    }
+    m_tabModel = tabModel;
+    m_lastShownForModel.clear();
+    m_preloadQueue.clear();
+    markShown(currentSourceModel());
+    schedulePreload();
+    tabModelChanged();
+}
+
+int ModelLifecycleManager::currentTab() const
+{
+    return m_currentTab;
+}
+
+void ModelLifecycleManager::setCurrentTab(int row)
+{
+    if (m_currentTab == row) {
+        return;
+    }
+    // The previous tab was shown until now
+    markShown(currentSourceModel());
+    m_currentTab = row;
+    SourceModel *sourceModel = currentSourceModel();
+    if (sourceModel) {
+        sourceModel->restoreModels();
+        markShown(sourceModel);
+    }
+    schedulePreload();
+    currentTabChanged(m_currentTab);
+}
+
+int ModelLifecycleManager::idleTimeout() const
+{
+    return m_idleTimeout;
+}
+
+void ModelLifecycleManager::setIdleTimeout(int minutes)
+{
+    if (m_idleTimeout == minutes) {
+        return;
+    }
+    m_idleTimeout = minutes;
+    idleTimeoutChanged(m_idleTimeout);
+}
+
+int ModelLifecycleManager::rowBudget() const
+{
+    return m_rowBudget;
+}
+
+void ModelLifecycleManager::setRowBudget(int rows)
+{
+    if (m_rowBudget == rows) {
+        return;
+    }
+    m_rowBudget = rows;
+    rowBudgetChanged(m_rowBudget);
+}
+
+bool ModelLifecycleManager::preloadAdjacentTabs() const
+{
+    return m_preloadAdjacentTabs;
+}
+
+void ModelLifecycleManager::setPreloadAdjacentTabs(bool value)
+{
+    if (m_preloadAdjacentTabs == value) {
+        return;
+    }
+    m_preloadAdjacentTabs = value;
+    schedulePreload();
+    preloadAdjacentTabsChanged(m_preloadAdjacentTabs);
+}
+
+SourceModel *ModelLifecycleManager::currentSourceModel() const
+{
+    return m_tabModel ? m_tabModel->sourceModelForRow(m_currentTab) : 0;
+}
+
+void ModelLifecycleManager::markShown(SourceModel *sourceModel)
+{
+    if (!sourceModel) {
+        return;
+    }
+    if (!m_lastShownForModel.contains(sourceModel)) {
+        connect(sourceModel, SIGNAL(destroyed(QObject *)), SLOT(slotSourceModelDestroyed(QObject *)), Qt::UniqueConnection);
+    }
+    m_lastShownForModel.insert(sourceModel, m_clock.elapsed());
+}
+
+void ModelLifecycleManager::slotSourceModelDestroyed(QObject *object)
+{
+    SourceModel *sourceModel = static_cast<SourceModel *>(object);
+    m_lastShownForModel.remove(sourceModel);
+    m_preloadQueue.removeAll(sourceModel);
+}
+
+int ModelLifecycleManager::loadedRowCount() const
+{
+    int count = 0;
+    for (int row = 0, tabCount = m_tabModel->rowCount(); row < tabCount; ++row) {
+        count += m_tabModel->sourceModelForRow(row)->loadedRowCount();
+    }
+    return count;
+}
+
+void ModelLifecycleManager::schedulePreload()
+{
+    m_preloadQueue.clear();
+    if (!m_tabModel || !m_preloadAdjacentTabs) {
+        m_preloadTimer->stop();
+        return;
+    }
+    Q_FOREACH(int row, QList<int>() << m_currentTab + 1 << m_currentTab - 1) {
+        SourceModel *sourceModel = m_tabModel->sourceModelForRow(row);
+        if (sourceModel) {
+            m_preloadQueue << sourceModel;
+        }
+    }
+    m_preloadTimer->start(PRELOAD_DELAY);
+}
+
+void ModelLifecycleManager::preloadNextTab()
+{
+    if (m_preloadQueue.isEmpty()) {
+        // Preloading may have gone over budget
+        evictModels();
+        return;
+    }
+    if (m_rowBudget > 0 && loadedRowCount() >= m_rowBudget) {
+        // Preloading would only make us evict something else
+        m_preloadQueue.clear();
+        return;
+    }
+    SourceModel *sourceModel = m_preloadQueue.takeFirst();
+    sourceModel->preloadModels();
+    // Preloaded tabs count as shown, otherwise they could be evicted right
+    // away
+    markShown(sourceModel);
+    m_preloadTimer->start(PRELOAD_INTERVAL);
+}
+
+void ModelLifecycleManager::evictModels()
+{
+    if (!m_tabModel) {
+        return;
+    }
+    SourceModel *current = currentSourceModel();
+    const qint64 now = m_clock.elapsed();
+
+    // Candidates, least recently shown first
+    QMultiMap<qint64, SourceModel *> candidates;
+    for (int row = 0, count = m_tabModel->rowCount(); row < count; ++row) {
+        SourceModel *sourceModel = m_tabModel->sourceModelForRow(row);
+        if (sourceModel == current || !sourceModel->hasLoadedModels()) {
+            continue;
+        }
+        const qint64 lastShown = m_lastShownForModel.value(sourceModel, 0);
+        if (m_idleTimeout > 0 && now - lastShown >= qint64(m_idleTimeout) * 60 * 1000) {
+            sourceModel->evictModels();
+            continue;
+        }
+        candidates.insert(lastShown, sourceModel);
+    }
+
+    if (m_rowBudget <= 0) {
+        return;
+    }
+    int rowCount = loadedRowCount();
+    for (auto it = candidates.constBegin(), end = candidates.constEnd(); it != end && rowCount > m_rowBudget; ++it) {
+        const int modelRowCount = it.value()->loadedRowCount();
+        it.value()->evictModels();
+        rowCount -= modelRowCount;
+    }
+}
+
+#include <modellifecyclemanager.moc>
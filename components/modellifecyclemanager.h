@@ -0,0 +1,117 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef MODELLIFECYCLEMANAGER_H
+#define MODELLIFECYCLEMANAGER_H
+
+// Local
+
+// Qt
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+// KDE
+
+class QTimer;
+
+class SourceModel;
+class TabModel;
+
+/**
+ * Bounds the memory used by the models of a TabModel, without making tab
+ * switches slower.
+ *
+ * - Models of tabs which have not been shown for idleTimeout minutes are
+ *   evicted.
+ * - If the models loaded by all tabs have more than rowBudget rows, models of
+ *   the least recently shown tabs are evicted until they fit.
+ * - When idle, models of the tabs next to the current one are preloaded.
+ *
+ * Evicted tabs keep their configuration: their models are recreated when they
+ * are shown again.
+ */
+class ModelLifecycleManager : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QObject *tabModel READ tabModel WRITE setTabModel NOTIFY tabModelChanged)
+    Q_PROPERTY(int currentTab READ currentTab WRITE setCurrentTab NOTIFY currentTabChanged)
+    /**
+     * In minutes, 0 to never evict tabs because they have not been shown
+     */
+    Q_PROPERTY(int idleTimeout READ idleTimeout WRITE setIdleTimeout NOTIFY idleTimeoutChanged)
+    /**
+     * Maximum number of rows of all loaded models, 0 for no limit
+     */
+    Q_PROPERTY(int rowBudget READ rowBudget WRITE setRowBudget NOTIFY rowBudgetChanged)
+    Q_PROPERTY(bool preloadAdjacentTabs READ preloadAdjacentTabs WRITE setPreloadAdjacentTabs NOTIFY preloadAdjacentTabsChanged)
+
+public:
+    explicit ModelLifecycleManager(QObject *parent = 0);
+    ~ModelLifecycleManager();
+
+    QObject *tabModel() const;
+    void setTabModel(QObject *model);
+
+    int currentTab() const;
+    void setCurrentTab(int row);
+
+    int idleTimeout() const;
+    void setIdleTimeout(int minutes);
+
+    int rowBudget() const;
+    void setRowBudget(int rows);
+
+    bool preloadAdjacentTabs() const;
+    void setPreloadAdjacentTabs(bool value);
+
+Q_SIGNALS:
+    void tabModelChanged();
+    void currentTabChanged(int row);
+    void idleTimeoutChanged(int minutes);
+    void rowBudgetChanged(int rows);
+    void preloadAdjacentTabsChanged(bool value);
+
+private Q_SLOTS:
+    void evictModels();
+    void preloadNextTab();
+    void slotSourceModelDestroyed(QObject *);
+
+private:
+    TabModel *m_tabModel;
+    int m_currentTab;
+    int m_idleTimeout;
+    int m_rowBudget;
+    bool m_preloadAdjacentTabs;
+
+    QElapsedTimer m_clock;
+    QTimer *m_evictTimer;
+    QTimer *m_preloadTimer;
+    // Time when each SourceModel was last shown, from m_clock
+    QHash<SourceModel *, qint64> m_lastShownForModel;
+    QList<SourceModel *> m_preloadQueue;
+
+    SourceModel *currentSourceModel() const;
+    void markShown(SourceModel *sourceModel);
+    void schedulePreload();
+    int loadedRowCount() const;
+};
+
+#endif /* MODELLIFECYCLEMANAGER_H */
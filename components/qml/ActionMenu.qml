@@ -25,7 +25,9 @@ Item {
     id: main
     /// Public
 
-    /// type:list<map<string,variant>> list of actions
+    /// type:list<map<string,variant>> list of actions. Elements can also be
+    /// nested lists or Homerun::ActionListModel instances, whose actions are
+    /// read directly from the model.
     property variant actionList
 
     property Item visualParent
@@ -69,6 +71,28 @@ Item {
         }
     }
 
+    Component {
+        id: modelMenuItemComponent
+
+        PlasmaComponents.MenuItem {
+            property QtObject actionModel
+            property int row
+            property string type
+
+            text: type != "separator" ? actionModel.text(row) : ""
+            enabled: type != "title" && actionModel.isEnabled(row)
+            separator: type == "separator"
+            icon: {
+                var value = actionModel.icon(row);
+                return value ? value : null;
+            }
+
+            onClicked: {
+                actionClicked(actionModel.actionId(row), actionModel.actionArgument(row));
+            }
+        }
+    }
+
     Component {
         id: emptyMenuItemComponent
         PlasmaComponents.MenuItem {
@@ -87,17 +111,62 @@ Item {
 
         menu = contextMenuComponent.createObject(main);
 
-        if (!actionList || actionList.length == 0) {
+        var entries = [];
+        collectEntries(actionList, entries);
+        if (entries.length > 0 && entries[entries.length - 1].type == "separator") {
+            entries.pop();
+        }
+
+        if (entries.length == 0) {
             var item = emptyMenuItemComponent.createObject(menu);
             menu.addMenuItem(item);
             return;
         }
 
-        actionList.forEach(function(actionItem) {
-            var item = contextMenuItemComponent.createObject(menu, {
-                "actionItem": actionItem,
-            });
+        entries.forEach(function(entry) {
+            var item;
+            if (entry.model) {
+                item = modelMenuItemComponent.createObject(menu, {
+                    "actionModel": entry.model,
+                    "row": entry.row,
+                    "type": entry.type,
+                });
+            } else {
+                item = contextMenuItemComponent.createObject(menu, {
+                    "actionItem": entry.actionItem,
+                });
+            }
             menu.addMenuItem(item);
         });
     }
+
+    function isActionListModel(value) {
+        return typeof(value.actionId) == "function";
+    }
+
+    // Flattens lst into entries, skipping leading and consecutive separators
+    function collectEntries(lst, entries) {
+        if (!lst) {
+            return;
+        }
+        if (isActionListModel(lst)) {
+            for (var row = 0; row < lst.count; ++row) {
+                appendEntry(entries, { "model": lst, "row": row, "type": lst.type(row) });
+            }
+        } else if (lst instanceof Array) {
+            lst.forEach(function(value) {
+                collectEntries(value, entries);
+            });
+        } else {
+            appendEntry(entries, { "actionItem": lst, "type": lst.type });
+        }
+    }
+
+    function appendEntry(entries, entry) {
+        if (entry.type == "separator"
+            && (entries.length == 0 || entries[entries.length - 1].type == "separator")) {
+            return;
+        }
+        entries.push(entry);
+    }
 }
@@ -0,0 +1,159 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <rowdatacache.h>
+
+// Local
+
+// KDE
+
+// Qt
+#include <QAbstractItemModel>
+
+RowDataCache::RowDataCache(QObject *parent)
+: QObject(parent)
+, m_modelHasRowData(false)
+, m_generation(0)
+{
+}
+
+RowDataCache::~RowDataCache()
+{
+}
+
+QObject *RowDataCache::model() const
+{
+    return m_model.data();
+}
+
+void RowDataCache::setModel(QObject *object)
+{
+    QAbstractItemModel *model = qobject_cast<QAbstractItemModel *>(object);
+    if (m_model.data() == model) {
+        return;
+    }
+    if (m_model) {
+        disconnect(m_model.data(), 0, this, 0);
+    }
+    m_model = model;
+    m_modelHasRowData = model && model->metaObject()->indexOfMethod("rowData(int,int,QStringList)") != -1;
+    if (m_modelHasRowData) {
+        connect(model, SIGNAL(modelReset()), SLOT(clear()));
+        connect(model, SIGNAL(layoutChanged()), SLOT(clear()));
+        connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), SLOT(slotDataChanged(QModelIndex, QModelIndex)));
+        connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), SLOT(slotRowsInsertedOrRemoved(QModelIndex, int, int)));
+        connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), SLOT(slotRowsInsertedOrRemoved(QModelIndex, int, int)));
+        connect(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), SLOT(slotRowsMoved(QModelIndex, int, int, QModelIndex, int)));
+        connect(model, SIGNAL(destroyed()), SLOT(clear()));
+    }
+    clear();
+    modelChanged();
+}
+
+QStringList RowDataCache::roleNames() const
+{
+    return m_roleNames;
+}
+
+void RowDataCache::setRoleNames(const QStringList &roleNames)
+{
+    if (m_roleNames == roleNames) {
+        return;
+    }
+    m_roleNames = roleNames;
+    clear();
+    roleNamesChanged();
+}
+
+int RowDataCache::generation() const
+{
+    return m_generation;
+}
+
+QVariant RowDataCache::rowData(int row, int /*generation*/)
+{
+    if (!m_model || !m_modelHasRowData || row < 0) {
+        return QVariant();
+    }
+    const int first = row - row % BlockSize;
+    auto it = m_blocks.find(first);
+    if (it == m_blocks.end()) {
+        QVariantList rows;
+        QMetaObject::invokeMethod(m_model.data(), "rowData",
+            Q_RETURN_ARG(QVariantList, rows),
+            Q_ARG(int, first),
+            Q_ARG(int, BlockSize),
+            Q_ARG(QStringList, m_roleNames));
+        it = m_blocks.insert(first, rows);
+    }
+    return it.value().value(row - first);
+}
+
+void RowDataCache::clear()
+{
+    m_blocks.clear();
+    ++m_generation;
+    generationChanged();
+}
+
+void RowDataCache::invalidateRows(int first, int last)
+{
+    bool changed = false;
+    for (auto it = m_blocks.begin(); it != m_blocks.end();) {
+        if (it.key() + BlockSize > first && (last == -1 || it.key() <= last)) {
+            it = m_blocks.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    // Only the delegates of cached blocks can be showing outdated data
+    if (changed) {
+        ++m_generation;
+        generationChanged();
+    }
+}
+
+void RowDataCache::slotDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (topLeft.parent().isValid()) {
+        return;
+    }
+    invalidateRows(topLeft.row(), bottomRight.row());
+}
+
+void RowDataCache::slotRowsInsertedOrRemoved(const QModelIndex &parent, int first, int /*last*/)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    invalidateRows(first);
+}
+
+void RowDataCache::slotRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow)
+{
+    if (sourceParent.isValid() || destinationParent.isValid()) {
+        return;
+    }
+    // Rows between the old and the new position shift as well
+    invalidateRows(qMin(sourceStart, destinationRow), qMax(sourceEnd, destinationRow));
+}
+
+#include <rowdatacache.moc>
@@ -0,0 +1,105 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ROWDATACACHE_H
+#define ROWDATACACHE_H
+
+// Local
+
+// Qt
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QVariant>
+
+// KDE
+
+class QAbstractItemModel;
+class QModelIndex;
+
+/**
+ * Caches what the rowData() method of a Homerun model returns, by blocks of
+ * BlockSize rows, so that the delegates of a view are filled with a few calls.
+ *
+ * When the model changes, only the blocks covering the changed rows are
+ * dropped. Inserting or removing rows drops the blocks from the first changed
+ * row to the end, since the rows after it move.
+ */
+class RowDataCache : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QObject *model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QStringList roleNames READ roleNames WRITE setRoleNames NOTIFY roleNamesChanged)
+    /**
+     * Incremented each time cached data is dropped. Bindings calling
+     * rowData() should pass it so that they are reevaluated.
+     */
+    Q_PROPERTY(int generation READ generation NOTIFY generationChanged)
+
+public:
+    enum {
+        BlockSize = 32
+    };
+
+    explicit RowDataCache(QObject *parent = 0);
+    ~RowDataCache();
+
+    QObject *model() const;
+    void setModel(QObject *model);
+
+    QStringList roleNames() const;
+    void setRoleNames(const QStringList &roleNames);
+
+    int generation() const;
+
+    /**
+     * Returns the data of @p row, as a map keyed by role name, or an invalid
+     * variant if the model has no rowData() method or @p row does not exist.
+     * @p generation is not used, see the generation property.
+     */
+    Q_INVOKABLE QVariant rowData(int row, int generation = 0);
+
+Q_SIGNALS:
+    void modelChanged();
+    void roleNamesChanged();
+    void generationChanged();
+
+private Q_SLOTS:
+    void clear();
+    void slotDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void slotRowsInsertedOrRemoved(const QModelIndex &parent, int first, int last);
+    void slotRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow);
+
+private:
+    QPointer<QAbstractItemModel> m_model;
+    bool m_modelHasRowData;
+    QStringList m_roleNames;
+    int m_generation;
+    // First row of a block => data of its rows
+    QHash<int, QVariantList> m_blocks;
+
+    /**
+     * Drops the blocks covering rows @p first to @p last, -1 meaning up to
+     * the end of the model
+     */
+    void invalidateRows(int first, int last = -1);
+};
+
+#endif /* ROWDATACACHE_H */
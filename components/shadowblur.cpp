@@ -0,0 +1,258 @@
+/*
+ * Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+// Self
+#include <shadowblur.h>
+
+// Local
+
+// KDE
+#include <KDebug>
+
+// Qt
+#include <QVector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HOMERUN_HAVE_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace ShadowBlur
+{
+
+// Sums of a box of 2 * MAX_BOX_RADIUS + 1 alpha values must fit in 16 bits
+static const int MAX_BOX_RADIUS = 127;
+
+/**
+ * The blur is computed with a running sum: for each row of the output, the
+ * sums of the input column boxes are updated by adding the row entering the
+ * box and subtracting the row leaving it. A step does this for one row.
+ *
+ * Dividing by the box size is done with a 16 bit fixed-point multiplication:
+ * dst = (sum * mul) >> 16.
+ */
+typedef void (*BoxStepFunction)(quint16 *sums, const uchar *addRow, const uchar *subRow, uchar *dstRow, int width, quint16 mul);
+
+static inline void boxStepScalarRange(quint16 *sums, const uchar *addRow, const uchar *subRow, uchar *dstRow, int begin, int end, quint16 mul)
+{
+    for (int x = begin; x < end; ++x) {
+        const uint sum = sums[x] + addRow[x];
+        dstRow[x] = (sum * mul) >> 16;
+        sums[x] = sum - subRow[x];
+    }
+}
+
+static void boxStepScalar(quint16 *sums, const uchar *addRow, const uchar *subRow, uchar *dstRow, int width, quint16 mul)
+{
+    boxStepScalarRange(sums, addRow, subRow, dstRow, 0, width, mul);
+}
+
+#ifdef HOMERUN_HAVE_X86_DISPATCH
+__attribute__((target("sse2")))
+static void boxStepSse2(quint16 *sums, const uchar *addRow, const uchar *subRow, uchar *dstRow, int width, quint16 mul)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vmul = _mm_set1_epi16(mul);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sums + x));
+        const __m128i add = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(addRow + x)), zero);
+        const __m128i sub = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(subRow + x)), zero);
+        sum = _mm_add_epi16(sum, add);
+        const __m128i out = _mm_mulhi_epu16(sum, vmul);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dstRow + x), _mm_packus_epi16(out, out));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sums + x), _mm_sub_epi16(sum, sub));
+    }
+    boxStepScalarRange(sums, addRow, subRow, dstRow, x, width, mul);
+}
+
+__attribute__((target("avx2")))
+static void boxStepAvx2(quint16 *sums, const uchar *addRow, const uchar *subRow, uchar *dstRow, int width, quint16 mul)
+{
+    const __m256i vmul = _mm256_set1_epi16(mul);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sums + x));
+        const __m256i add = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(addRow + x)));
+        const __m256i sub = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(subRow + x)));
+        sum = _mm256_add_epi16(sum, add);
+        const __m256i out = _mm256_mulhi_epu16(sum, vmul);
+        // _mm256_packus_epi16() interleaves 128 bit lanes, pack the halves
+        // instead to keep the bytes in order
+        const __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(out), _mm256_extracti128_si256(out, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstRow + x), packed);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums + x), _mm256_sub_epi16(sum, sub));
+    }
+    boxStepScalarRange(sums, addRow, subRow, dstRow, x, width, mul);
+}
+#endif
+
+static BoxStepFunction boxStepFunction(Implementation implementation)
+{
+    switch (implementation) {
+#ifdef HOMERUN_HAVE_X86_DISPATCH
+    case Sse2Implementation:
+        return boxStepSse2;
+    case Avx2Implementation:
+        return boxStepAvx2;
+#else
+    case Sse2Implementation:
+    case Avx2Implementation:
+        break;
+#endif
+    case ScalarImplementation:
+        break;
+    }
+    return boxStepScalar;
+}
+
+bool isSupported(Implementation implementation)
+{
+    switch (implementation) {
+    case ScalarImplementation:
+        return true;
+#ifdef HOMERUN_HAVE_X86_DISPATCH
+    case Sse2Implementation:
+        return __builtin_cpu_supports("sse2");
+    case Avx2Implementation:
+        return __builtin_cpu_supports("avx2");
+#else
+    case Sse2Implementation:
+    case Avx2Implementation:
+        break;
+#endif
+    }
+    return false;
+}
+
+Implementation bestImplementation()
+{
+    static const Implementation implementation =
+        isSupported(Avx2Implementation) ? Avx2Implementation
+        : isSupported(Sse2Implementation) ? Sse2Implementation
+        : ScalarImplementation;
+    return implementation;
+}
+
+/**
+ * Box-blurs the columns of the @p width x @p height plane @p src into @p dst.
+ * Pixels outside the plane are considered transparent.
+ */
+static void boxBlurColumns(const uchar *src, uchar *dst, int width, int height, int radius, BoxStepFunction step)
+{
+    const int boxSize = 2 * radius + 1;
+    const quint16 mul = (65536 + boxSize - 1) / boxSize;
+    QVector<quint16> sums(width, 0);
+    const QVector<uchar> zeroRow(width, 0);
+
+    for (int y = 0; y < qMin(radius, height); ++y) {
+        const uchar *row = src + y * width;
+        for (int x = 0; x < width; ++x) {
+            sums[x] += row[x];
+        }
+    }
+    for (int y = 0; y < height; ++y) {
+        const uchar *addRow = y + radius < height ? src + (y + radius) * width : zeroRow.constData();
+        const uchar *subRow = y - radius >= 0 ? src + (y - radius) * width : zeroRow.constData();
+        step(sums.data(), addRow, subRow, dst + y * width, width, mul);
+    }
+}
+
+static void transpose(const uchar *src, uchar *dst, int width, int height)
+{
+    for (int y = 0; y < height; ++y) {
+        const uchar *row = src + y * width;
+        for (int x = 0; x < width; ++x) {
+            dst[x * height + y] = row[x];
+        }
+    }
+}
+
+void blur(QImage &image, int radius, const QColor &color)
+{
+    blur(image, radius, color, bestImplementation());
+}
+
+void blur(QImage &image, int radius, const QColor &color, Implementation implementation)
+{
+    if (image.isNull()) {
+        return;
+    }
+    if (!isSupported(implementation)) {
+        kWarning() << "Unsupported blur implementation" << implementation;
+        implementation = ScalarImplementation;
+    }
+    if (image.format() != QImage::Format_ARGB32_Premultiplied) {
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    const int width = image.width();
+    const int height = image.height();
+
+    QVector<uchar> alpha(width * height);
+    QVector<uchar> tmp(width * height);
+    for (int y = 0; y < height; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        uchar *alphaLine = alpha.data() + y * width;
+        for (int x = 0; x < width; ++x) {
+            alphaLine[x] = qAlpha(line[x]);
+        }
+    }
+
+    if (radius > 0) {
+        // Three box blurs of radius r have the variance of a gaussian of
+        // sigma sqrt(r * (r + 1)), that is about r + 0.5, so sigma ends up
+        // close to (radius + 1) / 2. This is the box radius which best
+        // matches the exponential blur of Plasma::PaintUtils::shadowBlur(),
+        // see ShadowBlurTest::testMatchesPlasma().
+        const int boxRadius = qBound(1, qRound(radius / 2.0), MAX_BOX_RADIUS);
+        const BoxStepFunction step = boxStepFunction(implementation);
+
+        // Vertical passes
+        uchar *src = alpha.data();
+        uchar *dst = tmp.data();
+        for (int pass = 0; pass < 3; ++pass) {
+            boxBlurColumns(src, dst, width, height, boxRadius, step);
+            qSwap(src, dst);
+        }
+        // Horizontal passes, done as vertical passes on the transposed plane
+        // so that they can use SIMD too
+        transpose(src, dst, width, height);
+        qSwap(src, dst);
+        for (int pass = 0; pass < 3; ++pass) {
+            boxBlurColumns(src, dst, height, width, boxRadius, step);
+            qSwap(src, dst);
+        }
+        // src is tmp at this point, so this puts the result back in alpha
+        transpose(src, dst, height, width);
+    }
+
+    const int colorAlpha = color.alpha();
+    const int red = color.red();
+    const int green = color.green();
+    const int blue = color.blue();
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        const uchar *alphaLine = alpha.constData() + y * width;
+        for (int x = 0; x < width; ++x) {
+            const int a = alphaLine[x] * colorAlpha / 255;
+            line[x] = qRgba(red * a / 255, green * a / 255, blue * a / 255, a);
+        }
+    }
+}
+
+} // namespace
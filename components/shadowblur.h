@@ -0,0 +1,67 @@
+/*
+ * Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Library General Public License as
+ * published by the Free Software Foundation; either version 2, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#ifndef SHADOWBLUR_H
+#define SHADOWBLUR_H
+
+// Qt
+#include <QColor>
+#include <QImage>
+
+/**
+ * A separable blur for shadows, used by ShadowEffect instead of
+ * Plasma::PaintUtils::shadowBlur()
+ *
+ * Only the alpha channel of the image is blurred, the result is filled with a
+ * single color, like shadowBlur() does. The blur approximates a gaussian with
+ * three successive box blurs in each direction, whose inner loops use SIMD
+ * instructions when the CPU supports them.
+ */
+namespace ShadowBlur
+{
+
+enum Implementation {
+    ScalarImplementation,
+    Sse2Implementation,
+    Avx2Implementation,
+};
+
+/**
+ * Returns true if @p implementation can run on this CPU
+ */
+bool isSupported(Implementation implementation);
+
+/**
+ * Returns the fastest implementation supported by this CPU
+ */
+Implementation bestImplementation();
+
+/**
+ * Replaces @p image with a blurred version of its alpha channel, filled with
+ * @p color. The image is converted to ARGB32_Premultiplied if necessary.
+ */
+void blur(QImage &image, int radius, const QColor &color);
+
+/**
+ * Same as the above, but forces the implementation. Mostly useful for tests.
+ */
+void blur(QImage &image, int radius, const QColor &color, Implementation implementation);
+
+} // namespace
+
+#endif /* SHADOWBLUR_H */
@@ -20,20 +20,46 @@
 #include <shadoweffect.h>
 
 // Local
+#include <shadowblur.h>
 
 // KDE
 #include <KDebug>
-#include <Plasma/PaintUtils>
 
 // Qt
+#include <QCache>
 #include <QPainter>
 #include <QPaintEngine>
 
+// Cost is in KB of pixel data
+static const int SHADOW_CACHE_MAX_COST = 8 * 1024;
+
+/**
+ * Shadows are shared between effects: text items showing the same text with
+ * the same shadow parameters only get blurred once. Shadows of other items
+ * are keyed by their source pixmap.
+ */
+static QCache<QByteArray, QImage> *shadowCache()
+{
+    static QCache<QByteArray, QImage> cache(SHADOW_CACHE_MAX_COST);
+    return &cache;
+}
+
+// Properties of text items which define the pixels of their source pixmap,
+// together with its size
+static const char *TEXT_PROPERTIES[] = {
+    "text", "font", "color", "style", "textFormat",
+    "horizontalAlignment", "verticalAlignment", "wrapMode", "elide",
+    0
+};
+
+int ShadowEffect::s_generatedShadowCount = 0;
+
 ShadowEffect::ShadowEffect(QObject *parent)
 : QGraphicsEffect(parent)
 , m_xOffset(0)
 , m_yOffset(1)
 , m_blurRadius(3)
+, m_shadowSourceKey(0)
 {
 }
 
@@ -119,13 +145,12 @@ QRectF ShadowEffect::boundingRectFor(const QRectF &rect) const
         );
 }
 
-QImage ShadowEffect::generateShadow(const QPixmap &px) const
+QImage ShadowEffect::generateShadow(const QPixmap &px, const QColor &color) const
 {
     if (px.isNull()) {
         return QImage();
     }
-
-    QColor color = m_color.isValid() ? m_color : computeColorFromSource();
+    ++s_generatedShadowCount;
 
     QImage tmp(px.size(), QImage::Format_ARGB32_Premultiplied);
     tmp.fill(0);
@@ -134,7 +159,7 @@ QImage ShadowEffect::generateShadow(const QPixmap &px) const
         painter.setCompositionMode(QPainter::CompositionMode_Source);
         painter.drawPixmap(m_xOffset, m_yOffset, px);
         painter.end();
-        Plasma::PaintUtils::shadowBlur(tmp, m_blurRadius, color);
+        ShadowBlur::blur(tmp, qRound(m_blurRadius), color);
     } else {
         QPainter painter(&tmp);
         painter.setCompositionMode(QPainter::CompositionMode_Source);
@@ -142,7 +167,48 @@ QImage ShadowEffect::generateShadow(const QPixmap &px) const
         painter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
         painter.drawPixmap(m_xOffset, m_yOffset, px);
     }
-    return tmp;
+
+    // Darken the shadow now, so that drawing it is a single blit. This gives
+    // the same result as drawing the shadow twice.
+    QImage shadow = tmp;
+    QPainter painter(&shadow);
+    painter.drawImage(0, 0, tmp);
+    return shadow;
+}
+
+QByteArray ShadowEffect::shadowKey(const QPixmap &px, const QColor &color) const
+{
+    QByteArray key;
+    const QGraphicsObject *obj = sourceObject();
+    if (obj && obj->property("text").isValid()) {
+        // Identical labels share their shadow, whichever item they belong to
+        key = "text";
+        for (const char **name = TEXT_PROPERTIES; *name; ++name) {
+            key += ':' + obj->property(*name).toString().toUtf8();
+        }
+    } else {
+        // Qt keeps the source pixmap until the item changes
+        key = "pixmap:" + QByteArray::number(px.cacheKey());
+    }
+    key += ':' + QByteArray::number(px.width()) + 'x' + QByteArray::number(px.height())
+        + ':' + QByteArray::number(m_xOffset) + ',' + QByteArray::number(m_yOffset)
+        + ':' + QByteArray::number(m_blurRadius)
+        + ':' + QByteArray::number(color.rgba());
+    return key;
+}
+
+QImage ShadowEffect::cachedShadow(const QPixmap &px)
+{
+    const QColor color = m_color.isValid() ? m_color : computeColorFromSource();
+    const QByteArray key = shadowKey(px, color);
+    const QImage *shadow = shadowCache()->object(key);
+    if (shadow) {
+        return *shadow;
+    }
+    QImage image = generateShadow(px, color);
+    const int cost = qMax(image.byteCount() / 1024, 1);
+    shadowCache()->insert(key, new QImage(image), cost);
+    return image;
 }
 
 void ShadowEffect::draw(QPainter *painter)
@@ -166,11 +232,10 @@ void ShadowEffect::draw(QPainter *painter)
 
     QTransform restoreTransform = painter->worldTransform();
     painter->setWorldTransform(QTransform());
-    if (m_shadow.isNull()) {
-        m_shadow = generateShadow(pixmap);
+    if (m_shadow.isNull() || m_shadowSourceKey != pixmap.cacheKey()) {
+        m_shadow = cachedShadow(pixmap);
+        m_shadowSourceKey = pixmap.cacheKey();
     }
-    // Draw shadow (draw it twice to darken it)
-    painter->drawImage(offset, m_shadow);
     painter->drawImage(offset, m_shadow);
     // Draw the actual pixmap
     painter->drawPixmap(offset, pixmap);
@@ -216,6 +281,12 @@ public:
 };
 
 
+const QGraphicsObject *ShadowEffect::sourceObject() const
+{
+    const QGraphicsItem *item = source() ? source()->graphicsItem() : 0;
+    return item ? item->toGraphicsObject() : 0;
+}
+
 QColor ShadowEffect::computeColorFromSource() const
 {
     const QGraphicsItem *item = source()->graphicsItem();
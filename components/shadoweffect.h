@@ -22,9 +22,10 @@
 // Qt
 #include <QGraphicsEffect>
 
+class ShadowEffectTest;
+
 /**
- * An effect which draws a shadow behind an item, using
- * Plasma::PaintUtils::shadowBlur()
+ * An effect which draws a shadow behind an item, using ShadowBlur
  *
  * If the color is not specified, it will attempt to compute the best
  * appropriate color, based on the item "color" property (if it has any).
@@ -73,16 +74,27 @@ protected:
     void sourceChanged(ChangeFlags flags); // reimp
 
 private:
+    friend class ShadowEffectTest;
+
     qreal m_xOffset;
     qreal m_yOffset;
     qreal m_blurRadius;
     QColor m_color;
 
+    // Shadow of the last source pixmap, whose cacheKey() is m_shadowSourceKey
     QImage m_shadow;
+    qint64 m_shadowSourceKey;
 
-    QImage generateShadow(const QPixmap &px) const;
+    QImage generateShadow(const QPixmap &px, const QColor &color) const;
+    QByteArray shadowKey(const QPixmap &px, const QColor &color) const;
+    QImage cachedShadow(const QPixmap &px);
 
+    const QGraphicsObject *sourceObject() const;
     QColor computeColorFromSource() const;
+
+    // Number of shadows which have been blurred so far, by all effects. Used
+    // by tests.
+    static int s_generatedShadowCount;
 };
 
 #endif /* SHADOWEFFECT_H */
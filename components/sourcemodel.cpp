@@ -22,12 +22,15 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <abstractsourceregistry.h>
+#include <configtransaction.h>
 #include <customtypes.h>
+#include <trace.h>
 
 // KDE
 #include <KDebug>
 
 // Qt
+#include <QPointer>
 
 using namespace Homerun;
 
@@ -36,6 +39,28 @@ static const char *TAB_SOURCES_KEY = "sources";
 static const char *SOURCE_GROUP_PREFIX = "Source";
 static const char *SOURCE_SOURCEID_KEY = "sourceId";
 
+/**
+ * Returns the row count of @p model, including the rows of the sub-models
+ * returned by its modelForRow() method, if it has one
+ */
+static int totalRowCount(QAbstractItemModel *model)
+{
+    const int rowCount = model->rowCount();
+    int count = rowCount;
+    if (model->metaObject()->indexOfMethod("modelForRow(int)") == -1) {
+        return count;
+    }
+    for (int row = 0; row < rowCount; ++row) {
+        QObject *subModel = 0;
+        QMetaObject::invokeMethod(model, "modelForRow", Q_RETURN_ARG(QObject *, subModel), Q_ARG(int, row));
+        QAbstractItemModel *itemModel = qobject_cast<QAbstractItemModel *>(subModel);
+        if (itemModel) {
+            count += totalRowCount(itemModel);
+        }
+    }
+    return count;
+}
+
 class SourceModelItem
 {
 public:
@@ -47,17 +72,39 @@ public:
     , m_parent(parent)
     {}
 
+    ~SourceModelItem()
+    {
+        deleteModel();
+    }
+
+    bool hasModel() const
+    {
+        return m_model;
+    }
+
+    QObject *loadedModel() const
+    {
+        return m_model;
+    }
+
     QObject *model() const
     {
         if (!m_model) {
+            qint64 startTime = Trace::now();
             m_model = m_sourceRegistry->createModelFromConfigGroup(m_sourceId, m_group, m_parent);
+            Trace::addPopulationSpan(m_model, "SourceModel first population", startTime, m_sourceId);
         }
         return m_model;
     }
 
     void deleteModel()
     {
-        delete m_model;
+        // If the registry is already gone, it released its shared models
+        // when it was destroyed, and unshared ones are deleted with their
+        // parent
+        if (m_model && m_sourceRegistry) {
+            m_sourceRegistry->releaseModel(m_model);
+        }
         m_model = 0;
     }
 
@@ -65,7 +112,7 @@ public:
     KConfigGroup m_group;
 
 private:
-    AbstractSourceRegistry *m_sourceRegistry;
+    QPointer<AbstractSourceRegistry> m_sourceRegistry;
     mutable QObject *m_model;
     QObject *m_parent;
 };
@@ -75,6 +122,7 @@ SourceModel::SourceModel(AbstractSourceRegistry *registry, const KConfigGroup &t
 : QAbstractListModel(parent)
 , m_sourceRegistry(registry)
 , m_tabGroup(tabGroup)
+, m_evicted(false)
 {
     Q_ASSERT(registry);
     QHash<int, QByteArray> roles;
@@ -110,6 +158,9 @@ QVariant SourceModel::data(const QModelIndex &index, int role) const
     case SourceIdRole:
         return item->m_sourceId;
     case ModelRole:
+        if (m_evicted) {
+            return QVariant::fromValue<QObject *>(0);
+        }
         return QVariant::fromValue(item->model());
     case ConfigGroupRole:
         return QVariant::fromValue(&item->m_group);
@@ -121,6 +172,7 @@ QVariant SourceModel::data(const QModelIndex &index, int role) const
 
 void SourceModel::reload()
 {
+    TraceSpan span("SourceModel::reload", Trace::isEnabled() ? m_tabGroup.name() : QString());
     qDeleteAll(m_list);
     m_list.clear();
 
@@ -145,11 +197,11 @@ void SourceModel::appendSource(const QString &sourceId)
         }
     }
 
+    ConfigTransaction transaction(m_tabGroup);
     beginInsertRows(QModelIndex(), m_list.count(), m_list.count());
     SourceModelItem *item = new SourceModelItem(m_sourceRegistry, sourceId, sourceGroup, this);
     m_list << item;
     item->m_group.writeEntry(SOURCE_SOURCEID_KEY, sourceId);
-    item->m_group.sync();
     writeSourcesEntry();
     endInsertRows();
 }
@@ -161,7 +213,6 @@ void SourceModel::writeSourcesEntry()
         lst << item->m_group.name();
     }
     m_tabGroup.writeEntry(TAB_SOURCES_KEY, lst);
-    m_tabGroup.sync();
 }
 
 void SourceModel::recreateModel(int row)
@@ -179,6 +230,68 @@ void SourceModel::recreateModel(int row)
     dataChanged(idx, idx);
 }
 
+void SourceModel::evictModels()
+{
+    if (m_evicted) {
+        return;
+    }
+    TraceSpan span("SourceModel::evictModels", Trace::isEnabled() ? m_tabGroup.name() : QString());
+    m_evicted = true;
+    Q_FOREACH(SourceModelItem *item, m_list) {
+        item->deleteModel();
+    }
+    if (!m_list.isEmpty()) {
+        dataChanged(index(0, 0), index(m_list.count() - 1, 0));
+    }
+}
+
+void SourceModel::restoreModels()
+{
+    if (!m_evicted) {
+        return;
+    }
+    m_evicted = false;
+    if (!m_list.isEmpty()) {
+        dataChanged(index(0, 0), index(m_list.count() - 1, 0));
+    }
+}
+
+void SourceModel::preloadModels()
+{
+    TraceSpan span("SourceModel::preloadModels", Trace::isEnabled() ? m_tabGroup.name() : QString());
+    restoreModels();
+    Q_FOREACH(SourceModelItem *item, m_list) {
+        item->model();
+    }
+}
+
+bool SourceModel::isEvicted() const
+{
+    return m_evicted;
+}
+
+bool SourceModel::hasLoadedModels() const
+{
+    Q_FOREACH(const SourceModelItem *item, m_list) {
+        if (item->hasModel()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int SourceModel::loadedRowCount() const
+{
+    int count = 0;
+    Q_FOREACH(const SourceModelItem *item, m_list) {
+        QAbstractItemModel *model = qobject_cast<QAbstractItemModel *>(item->loadedModel());
+        if (model) {
+            count += totalRowCount(model);
+        }
+    }
+    return count;
+}
+
 #define CHECK_ROW(row) \
     if (row < 0 || row >= m_list.count()) { \
         kWarning() << "Invalid row number" << row; \
@@ -188,6 +301,7 @@ void SourceModel::recreateModel(int row)
 void SourceModel::remove(int row)
 {
     CHECK_ROW(row)
+    ConfigTransaction transaction(m_tabGroup);
     beginRemoveRows(QModelIndex(), row, row);
     SourceModelItem *item = m_list.takeAt(row);
     item->m_group.deleteGroup();
@@ -206,6 +320,7 @@ void SourceModel::move(int from, int to)
     }
     // See beginMoveRows() doc for an explanation on modelTo
     int modelTo = to + (to > from ? 1 : 0);
+    ConfigTransaction transaction(m_tabGroup);
     beginMoveRows(QModelIndex(), from, from, QModelIndex(), modelTo);
     m_list.move(from, to);
     writeSourcesEntry();
@@ -62,10 +62,39 @@ public:
     Q_INVOKABLE void remove(int row);
     Q_INVOKABLE void move(int from, int to);
 
+    /**
+     * Releases the models of all sources. Until restoreModels() is called,
+     * ModelRole returns a null model for all rows and models are not
+     * recreated. The source configurations are kept.
+     */
+    void evictModels();
+
+    /**
+     * Lets models of evicted sources be recreated, on next access
+     */
+    void restoreModels();
+
+    /**
+     * Creates the models of all sources now instead of on first access
+     */
+    void preloadModels();
+
+    bool isEvicted() const;
+
+    bool hasLoadedModels() const;
+
+    /**
+     * Returns the total row count of the models which are currently loaded,
+     * including the rows of the sub-models returned by their modelForRow()
+     * method. This is used as an estimate of their memory use.
+     */
+    int loadedRowCount() const;
+
 private:
     Homerun::AbstractSourceRegistry *m_sourceRegistry;
     KConfigGroup m_tabGroup;
     QList<SourceModelItem *> m_list;
+    bool m_evicted;
 
     void writeSourcesEntry();
 };
@@ -25,10 +25,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <customtypes.h>
 #include <libhomerun_config.h>
 #include <sourceconfigurationdialog.h>
+#include <trace.h>
 
 #include <sources/dir/dirmodel.h>
 #include <sources/favorites/favoriteappsmodel.h>
 #include <sources/favorites/favoriteplacesmodel.h>
+#include <sources/favorites/favoritesindex.h>
 #include <sources/installedapps/installedappsmodel.h>
 #include <sources/installedapps/groupedinstalledappsmodel.h>
 #include <sources/installedapps/filterableinstalledappsmodel.h>
@@ -47,13 +49,23 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <KPluginInfo>
 #include <KPluginLoader>
 #include <KServiceTypeTrader>
+#include <KSycoca>
 #include <Plasma/PluginLoader>
 
 // Qt
 #include <QApplication>
+#include <QFuture>
+#include <QPluginLoader>
+#include <QSet>
+#include <QtConcurrentRun>
 
 namespace Homerun {
 
+static const char *GENERAL_GROUP = "General";
+static const char *GENERAL_TABS_KEY = "tabs";
+static const char *TAB_SOURCES_KEY = "sources";
+static const char *SOURCE_SOURCEID_KEY = "sourceId";
+
 //- SingletonSource -------------------------------------------
 class SingletonSource : public AbstractSource
 {
@@ -72,17 +84,194 @@ private:
     QAbstractItemModel *m_model;
 };
 
+//- SharedModels ----------------------------------------------
+/**
+ * Models created from equivalent configurations by shareable sources are
+ * shared by all registries of the process. Models are refcounted: each
+ * registry holds one reference per model it handed out.
+ *
+ * Views never change a shared model. Models with per-view state, like a
+ * containment or navigation signals, are handed out wrapped in a per-view
+ * proxy holding that state, see ViewProxyFactory. Views which filter a shared
+ * model do it through their own proxy (SortFilterModel in QML).
+ */
+class SharedModels
+{
+public:
+    static SharedModels *instance()
+    {
+        static SharedModels sharedModels;
+        return &sharedModels;
+    }
+
+    QObject *ref(const QString &key)
+    {
+        auto it = m_entryForKey.find(key);
+        if (it == m_entryForKey.end()) {
+            return 0;
+        }
+        ++it->refCount;
+        return it->model;
+    }
+
+    void insert(const QString &key, QObject *model)
+    {
+        Entry entry;
+        entry.model = model;
+        entry.refCount = 1;
+        m_entryForKey.insert(key, entry);
+        m_keyForModel.insert(model, key);
+    }
+
+    bool contains(QObject *model) const
+    {
+        return m_keyForModel.contains(model);
+    }
+
+    void deref(QObject *model)
+    {
+        auto keyIt = m_keyForModel.find(model);
+        if (keyIt == m_keyForModel.end()) {
+            kWarning() << "Not a shared model" << model;
+            return;
+        }
+        auto it = m_entryForKey.find(keyIt.value());
+        Q_ASSERT(it != m_entryForKey.end());
+        if (--it->refCount > 0) {
+            return;
+        }
+        m_entryForKey.erase(it);
+        m_keyForModel.erase(keyIt);
+        // Views may still be using the model until the end of this event
+        model->deleteLater();
+    }
+
+private:
+    struct Entry {
+        QObject *model;
+        int refCount;
+    };
+    QHash<QString, Entry> m_entryForKey;
+    QHash<QObject *, QString> m_keyForModel;
+};
+
+//- PluginMetadataCache ---------------------------------------
+struct PluginMetadata
+{
+    QString id;
+    QString visibleName;
+    QString comment;
+    KService::Ptr service;
+};
+
+/**
+ * Metadata of source plugins, shared by all registries of the process. It is
+ * valid as long as the sycoca database has not been rebuilt.
+ */
+struct PluginMetadataCache
+{
+    bool valid;
+    quint32 sycocaTimeStamp;
+    QList<PluginMetadata> list;
+    int queryCount;
+
+    PluginMetadataCache()
+    : valid(false)
+    , sycocaTimeStamp(0)
+    , queryCount(0)
+    {}
+
+    static PluginMetadataCache *instance()
+    {
+        static PluginMetadataCache cache;
+        return &cache;
+    }
+
+    const QList<PluginMetadata> &metadataList()
+    {
+        const quint32 timeStamp = KSycoca::self()->timeStamp();
+        if (valid && sycocaTimeStamp == timeStamp) {
+            return list;
+        }
+        TraceSpan span("PluginMetadataCache::query");
+        ++queryCount;
+        list.clear();
+        KService::List offers = KServiceTypeTrader::self()->query(
+            "Homerun/Source",
+            QString("[X-KDE-Homerun-APIVersion] == %1").arg(HOMERUN_API_VERSION)
+            );
+
+        Q_FOREACH(KService::Ptr ptr, offers) {
+            KPluginInfo pluginInfo(ptr);
+            if (pluginInfo.pluginName().isEmpty()) {
+                kWarning() << "Missing X-KDE-PluginInfo-Name key in" << ptr->entryPath();
+                continue;
+            }
+            PluginMetadata metadata;
+            metadata.service = ptr;
+            metadata.id = pluginInfo.pluginName();
+            metadata.visibleName = pluginInfo.name();
+            metadata.comment = pluginInfo.comment();
+            list << metadata;
+        }
+        valid = true;
+        sycocaTimeStamp = timeStamp;
+        return list;
+    }
+};
+
+/**
+ * Maps the plugin library @p fileName, so that creating the plugin factory
+ * later in the GUI thread does not have to. Runs in a worker thread.
+ */
+static bool preloadPluginLibrary(const QString &fileName)
+{
+    TraceSpan span("SourceRegistry preloadPluginLibrary", fileName);
+    // The library stays loaded when the loader is destroyed
+    QPluginLoader loader(fileName);
+    if (!loader.load()) {
+        kWarning() << "Failed to preload" << fileName << loader.errorString();
+        return false;
+    }
+    return true;
+}
+
 //- SourceInfo ------------------------------------------------
+/**
+ * Wraps a shared model in a proxy holding the state of one view
+ */
+typedef QAbstractItemModel *(*ViewProxyFactory)(QAbstractItemModel *model, QObject *parent);
+
+template<class Proxy, class Model>
+static QAbstractItemModel *createViewProxy(QAbstractItemModel *model, QObject *parent)
+{
+    return new Proxy(static_cast<Model *>(model), parent);
+}
+
 struct SourceInfo
 {
+    enum Sharing {
+        NotShared,
+        // Models created from config groups with the same entries are shared
+        SharedByEntries,
+        // Models are shared only with views of the same config group, for
+        // models which store their own state in the group
+        SharedByGroup
+    };
+
     QString id;
     QString visibleName;
     QString comment;
     AbstractSource *source;
     KService::Ptr service;
+    Sharing sharing;
+    // Null if shared models have no per-view state
+    ViewProxyFactory viewProxyFactory;
 
     SourceInfo()
     : source(0)
+    , sharing(NotShared)
+    , viewProxyFactory(0)
     {}
 };
 
@@ -140,6 +329,7 @@ struct SourceRegistryPrivate
 {
     SourceRegistry *q;
     QHash<QString, QAbstractItemModel*> m_favoriteModels;
+    FavoritesIndex *m_favoritesIndex;
 
     QList<SourceInfo *> m_sourceInfos;
     QHash<QString, SourceInfo *> m_sourceInfoById;
@@ -147,31 +337,70 @@ struct SourceRegistryPrivate
     AvailableSourcesModel *m_availableSourcesModel;
     KSharedConfig::Ptr m_config;
 
+    // Object handed out to a view => the shared model it stands for, one
+    // entry per reference this registry holds. The object is either the
+    // shared model itself or a view proxy of it.
+    QMultiHash<QObject *, QObject *> m_sharedModelForObject;
+
+    // Source id => library being loaded in a worker thread
+    QHash<QString, QFuture<bool> > m_pluginPreloads;
+
     void listSourcePlugins()
     {
-        KService::List offers = KServiceTypeTrader::self()->query(
-            "Homerun/Source",
-            QString("[X-KDE-Homerun-APIVersion] == %1").arg(HOMERUN_API_VERSION)
-            );
+        TraceSpan span("SourceRegistry::listSourcePlugins");
+        Q_FOREACH(const PluginMetadata &metadata, PluginMetadataCache::instance()->metadataList()) {
+            SourceInfo *sourceInfo = new SourceInfo;
+            sourceInfo->service = metadata.service;
+            sourceInfo->id = metadata.id;
+            sourceInfo->visibleName = metadata.visibleName;
+            sourceInfo->comment = metadata.comment;
+            registerSourceInfo(sourceInfo);
+        }
+    }
 
-        Q_FOREACH(KService::Ptr ptr, offers) {
-            KPluginInfo pluginInfo(ptr);
-            if (pluginInfo.pluginName().isEmpty()) {
-                kWarning() << "Missing X-KDE-PluginInfo-Name key in" << ptr->entryPath();
+    /**
+     * Starts loading, in worker threads, the libraries of the plugins used by
+     * the tabs defined in the config. Like TabModel and SourceModel, only
+     * looks at the tabs and sources which are listed: groups of removed tabs
+     * and sources can linger in the config.
+     */
+    void preloadConfiguredPlugins()
+    {
+        TraceSpan span("SourceRegistry::preloadConfiguredPlugins");
+        QSet<QString> sourceIds;
+        const QStringList tabNames = m_config->group(GENERAL_GROUP).readEntry(GENERAL_TABS_KEY, QStringList());
+        Q_FOREACH(const QString &tabName, tabNames) {
+            KConfigGroup tabGroup = m_config->group(tabName);
+            const QStringList sourceNames = tabGroup.readEntry(TAB_SOURCES_KEY, QStringList());
+            Q_FOREACH(const QString &sourceName, sourceNames) {
+                sourceIds << tabGroup.group(sourceName).readEntry(SOURCE_SOURCEID_KEY, QString());
+            }
+        }
+        Q_FOREACH(const QString &sourceId, sourceIds) {
+            SourceInfo *sourceInfo = m_sourceInfoById.value(sourceId);
+            if (!sourceInfo || sourceInfo->source || !sourceInfo->service || m_pluginPreloads.contains(sourceId)) {
                 continue;
             }
-            SourceInfo *sourceInfo = new SourceInfo;
-            sourceInfo->service = ptr;
-            sourceInfo->id = pluginInfo.pluginName();
-            sourceInfo->visibleName = pluginInfo.name();
-            sourceInfo->comment = pluginInfo.comment();
-            registerSourceInfo(sourceInfo);
+            // Resolving the library path uses KStandardDirs, do it here. The
+            // loader does not load anything until asked to.
+            const QString fileName = KPluginLoader(*sourceInfo->service).fileName();
+            if (fileName.isEmpty()) {
+                continue;
+            }
+            m_pluginPreloads.insert(sourceId, QtConcurrent::run(preloadPluginLibrary, fileName));
         }
     }
 
     void loadPluginForSourceInfo(SourceInfo *sourceInfo)
     {
         Q_ASSERT(sourceInfo->service);
+        TraceSpan span("SourceRegistry::loadPluginForSourceInfo", sourceInfo->id);
+        QFuture<bool> preload = m_pluginPreloads.take(sourceInfo->id);
+        if (preload.isRunning()) {
+            // Still cheaper than loading the library from scratch
+            TraceSpan waitSpan("SourceRegistry wait for plugin preload", sourceInfo->id);
+            preload.waitForFinished();
+        }
         // Create the plugin factory
         KPluginLoader loader(*sourceInfo->service);
         KPluginFactory *factory = loader.factory();
@@ -191,16 +420,59 @@ struct SourceRegistryPrivate
         sourceInfo->source = source;
     }
 
-    void registerSource(const QString &id, AbstractSource *source, const QString &visibleName, const QString &comment)
+    void registerSource(const QString &id, AbstractSource *source, const QString &visibleName, const QString &comment,
+        SourceInfo::Sharing sharing = SourceInfo::NotShared, ViewProxyFactory viewProxyFactory = 0)
     {
         SourceInfo *info = new SourceInfo;
         info->id = id;
         info->visibleName = visibleName;
         info->source = source;
         info->comment = comment;
+        info->sharing = sharing;
+        info->viewProxyFactory = viewProxyFactory;
         registerSourceInfo(info);
     }
 
+    /**
+     * Returns a key identifying the model @p sourceInfo would create from
+     * @p group: equivalent configurations get the same key
+     */
+    QString sharedModelKey(SourceInfo *sourceInfo, const KConfigGroup &group) const
+    {
+        QString key = sourceInfo->id + '\n' + group.config()->name();
+        if (sourceInfo->sharing == SourceInfo::SharedByGroup) {
+            // The top-level group is named "<default>" and is its own parent
+            for (KConfigGroup it = group; it.name() != "<default>"; it = it.parent()) {
+                key += '\n' + it.name();
+            }
+            return key;
+        }
+        const QMap<QString, QString> entries = group.entryMap();
+        for (auto it = entries.constBegin(), end = entries.constEnd(); it != end; ++it) {
+            // A missing and an empty entry read the same
+            if (it.key() == SOURCE_SOURCEID_KEY || it.value().isEmpty()) {
+                continue;
+            }
+            key += '\n' + it.key() + '=' + it.value();
+        }
+        return key;
+    }
+
+    /**
+     * Returns what the view @p parent gets for a reference to the shared
+     * @p model: a proxy of it if the views of @p sourceInfo have state
+     */
+    QObject *handOutSharedModel(SourceInfo *sourceInfo, QAbstractItemModel *model, QObject *parent)
+    {
+        QObject *object = model;
+        if (sourceInfo->viewProxyFactory) {
+            object = sourceInfo->viewProxyFactory(model, parent);
+            object->setObjectName(sourceInfo->id);
+        }
+        m_sharedModelForObject.insert(object, model);
+        return object;
+    }
+
     void registerSourceInfo(SourceInfo *info)
     {
         m_sourceInfos << info;
@@ -227,6 +499,7 @@ struct SourceRegistryPrivate
 
     void registerSingleRunnerSources()
     {
+        TraceSpan span("SourceRegistry::registerSingleRunnerSources");
         KPluginInfo::List list = Plasma::PluginLoader::pluginLoader()->listRunnerInfo();
 
         // FIXME: SC 4.13 replaced Nepomuk with Baloo for desktop search. Modifications
@@ -264,27 +537,43 @@ SourceRegistry::SourceRegistry(QObject *parent)
 : AbstractSourceRegistry(parent)
 , d(new SourceRegistryPrivate)
 {
+    TraceSpan span("SourceRegistry::SourceRegistry");
     d->q = this;
     d->m_availableSourcesModel = new AvailableSourcesModel(d->m_sourceInfos, this);
 
-    d->m_favoriteModels.insert("app", new FavoriteAppsModel(this));
-    d->m_favoriteModels.insert("place", new FavoritePlacesModel(this));
+    FavoriteAppsModel *favoriteAppsModel = new FavoriteAppsModel(this);
+    FavoritePlacesModel *favoritePlacesModel = new FavoritePlacesModel(this);
+    d->m_favoriteModels.insert("app", favoriteAppsModel);
+    d->m_favoriteModels.insert("place", favoritePlacesModel);
+    d->m_favoritesIndex = new FavoritesIndex(this);
+    Q_FOREACH(QAbstractItemModel *model, d->m_favoriteModels) {
+        d->m_favoritesIndex->addModel(model);
+    }
+    favoriteAppsModel->setFavoritesIndex(d->m_favoritesIndex);
+    favoritePlacesModel->setFavoritesIndex(d->m_favoritesIndex);
 
+    // Installed and recent apps models navigate by emitting
+    // openSourceRequested() and kicker sets their containment: views get
+    // their own proxy of the shared model
     d->registerSource("InstalledApps", new InstalledAppsSource(this),
         i18n("Installed Applications"),
-        i18n("Browse installed applications by categories")
+        i18n("Browse installed applications by categories"),
+        SourceInfo::SharedByEntries, createViewProxy<InstalledAppsModelProxy, InstalledAppsModel>
     );
     d->registerSource("GroupedInstalledApps", new GroupedInstalledAppsSource(this),
         i18n("All Installed Applications"),
-        i18n("List all installed applications in a flat list, grouped by categories")
+        i18n("List all installed applications in a flat list, grouped by categories"),
+        SourceInfo::SharedByEntries, createViewProxy<GroupedInstalledAppsModelProxy, GroupedInstalledAppsModel>
     );
     d->registerSource("FilterableInstalledApps", new FilterableInstalledAppsSource(this),
         i18n("All Installed Applications With Filters"),
         i18n("List all installed applications and filter via the sidebar")
     );
+    // Recent apps models store their list in their group
     d->registerSource("RecentApps", new RecentAppsSource(this),
         i18n("Recent Applications"),
-        i18n("List the most recently launched applications")
+        i18n("List the most recently launched applications"),
+        SourceInfo::SharedByGroup, createViewProxy<RecentAppsModelProxy, RecentAppsModel>
     );
     d->registerSource("Dir", new DirSource(this),
         i18n("Folder"),
@@ -300,15 +589,18 @@ SourceRegistry::SourceRegistry(QObject *parent)
     );
     d->registerSource("Power", new SimpleSource<PowerModel>(this),
         i18n("Power Management"),
-        i18n("Provide buttons to suspend, hibernate, reboot or halt your computer")
+        i18n("Provide buttons to suspend, hibernate, reboot or halt your computer"),
+        SourceInfo::SharedByEntries
     );
     d->registerSource("Session", new SimpleSource<SessionModel>(this),
         i18n("Session"),
-        i18n("Provide buttons to lock the screen, log out, or switch to another user")
+        i18n("Provide buttons to lock the screen, log out, or switch to another user"),
+        SourceInfo::SharedByEntries
     );
     d->registerSource("OpenedSessions", new SimpleSource<OpenedSessionsModel>(this),
         i18n("Opened Sessions"),
-        i18n("Provide buttons to switch to opened sessions")
+        i18n("Provide buttons to switch to opened sessions"),
+        SourceInfo::SharedByEntries
     );
     d->registerSource("CombinedPowerSession", new CombinedPowerSessionSource(this),
         i18n("Power / Session"),
@@ -326,12 +618,17 @@ SourceRegistry::SourceRegistry(QObject *parent)
 
 SourceRegistry::~SourceRegistry()
 {
+    // View proxies belong to their views
+    Q_FOREACH(QObject *model, d->m_sharedModelForObject) {
+        SharedModels::instance()->deref(model);
+    }
     qDeleteAll(d->m_sourceInfos);
     delete d;
 }
 
 QObject *SourceRegistry::createModelFromArguments(const QString &sourceId, const QVariantMap &sourceArguments, QObject *parent)
 {
+    TraceSpan span("SourceRegistry::createModelFromArguments", sourceId);
     // Get source
     AbstractSource *source = d->sourceById(sourceId);
     if (!source) {
@@ -358,6 +655,17 @@ QObject *SourceRegistry::createModelFromArguments(const QString &sourceId, const
 
 QObject *SourceRegistry::createModelFromConfigGroup(const QString &sourceId, const KConfigGroup &group, QObject *parent)
 {
+    TraceSpan span("SourceRegistry::createModelFromConfigGroup", sourceId);
+    SourceInfo *sourceInfo = d->m_sourceInfoById.value(sourceId);
+    QString sharedKey;
+    if (sourceInfo && sourceInfo->sharing != SourceInfo::NotShared) {
+        sharedKey = d->sharedModelKey(sourceInfo, group);
+        QObject *model = SharedModels::instance()->ref(sharedKey);
+        if (model) {
+            return d->handOutSharedModel(sourceInfo, static_cast<QAbstractItemModel *>(model), parent);
+        }
+    }
+
     // Get source
     AbstractSource *source = d->sourceById(sourceId);
     if (!source) {
@@ -373,6 +681,12 @@ QObject *SourceRegistry::createModelFromConfigGroup(const QString &sourceId, con
     }
     model->setObjectName(sourceId);
 
+    if (!sharedKey.isEmpty() && !model->parent()) {
+        // Shared models are owned by SharedModels, not by the first view
+        SharedModels::instance()->insert(sharedKey, model);
+        return d->handOutSharedModel(sourceInfo, model, parent);
+    }
+
     // If the model already has a parent, then don't change it.
     // This is used by singleton sources to keep their model alive.
     if (!model->parent()) {
@@ -382,6 +696,25 @@ QObject *SourceRegistry::createModelFromConfigGroup(const QString &sourceId, con
     return model;
 }
 
+void SourceRegistry::releaseModel(QObject *model)
+{
+    auto it = d->m_sharedModelForObject.find(model);
+    if (it == d->m_sharedModelForObject.end()) {
+        // Singleton models are owned by their source
+        if (model->parent() != this) {
+            delete model;
+        }
+        return;
+    }
+    QObject *sharedModel = it.value();
+    d->m_sharedModelForObject.erase(it);
+    if (sharedModel != model) {
+        // A view proxy
+        delete model;
+    }
+    SharedModels::instance()->deref(sharedModel);
+}
+
 QVariantMap SourceRegistry::favoriteModels() const
 {
     QVariantMap map;
@@ -397,6 +730,11 @@ QAbstractItemModel *SourceRegistry::favoriteModel(const QString &name) const
     return d->m_favoriteModels.value(name);
 }
 
+QObject *SourceRegistry::favoritesIndex() const
+{
+    return d->m_favoritesIndex;
+}
+
 KSharedConfig::Ptr SourceRegistry::config() const
 {
     return d->m_config;
@@ -419,6 +757,7 @@ void SourceRegistry::setConfigFileName(const QString &name)
             source->setConfig(d->m_config);
         }
     }
+    d->preloadConfiguredPlugins();
     configFileNameChanged(name);
 }
 
@@ -437,6 +776,22 @@ QString SourceRegistry::visibleNameForSource(const QString &sourceId) const
     return info->visibleName;
 }
 
+bool SourceRegistry::isSourceShareable(const QString &sourceId) const
+{
+    SourceInfo *sourceInfo = d->m_sourceInfoById.value(sourceId);
+    return sourceInfo && sourceInfo->sharing != SourceInfo::NotShared;
+}
+
+QStringList SourceRegistry::pendingPluginPreloads() const
+{
+    return d->m_pluginPreloads.keys();
+}
+
+int SourceRegistry::pluginMetadataQueryCount()
+{
+    return PluginMetadataCache::instance()->queryCount;
+}
+
 bool SourceRegistry::isSourceConfigurable(const QString &sourceId) const
 {
     AbstractSource *source = d->sourceById(sourceId);
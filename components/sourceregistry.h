@@ -30,6 +30,8 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 class QAbstractItemModel;
 
+class SourceRegistryTest;
+
 namespace Homerun {
 
 class AbstractSource;
@@ -43,6 +45,7 @@ class SourceRegistry : public AbstractSourceRegistry
 {
     Q_OBJECT
     Q_PROPERTY(QVariantMap favoriteModels READ favoriteModels CONSTANT)
+    Q_PROPERTY(QObject *favoritesIndex READ favoritesIndex CONSTANT)
     Q_PROPERTY(QString configFileName READ configFileName WRITE setConfigFileName NOTIFY configFileNameChanged)
 public:
     explicit SourceRegistry(QObject *parent = 0);
@@ -50,13 +53,26 @@ public:
 
     Q_INVOKABLE QObject *createModelFromArguments(const QString &sourceId, const QVariantMap &sourceArguments, QObject *parent);
 
+    /**
+     * Models of shareable sources are shared between all the views using an
+     * equivalent configuration, in all registries of the process. If views
+     * of the model have their own state, each view gets a proxy of the
+     * shared model, child of @p parent. Either way, the returned object must
+     * be given back with releaseModel().
+     */
     QObject *createModelFromConfigGroup(const QString &sourceId, const KConfigGroup &configGroup, QObject *parent); // reimp
+    void releaseModel(QObject *model); // reimp
     KSharedConfig::Ptr config() const;
 
     QVariantMap favoriteModels() const;
 
     QAbstractItemModel *favoriteModel(const QString &name) const;
 
+    /**
+     * Returns a FavoritesIndex covering all favorite models
+     */
+    QObject *favoritesIndex() const;
+
     QString configFileName() const;
     void setConfigFileName(const QString &name);
 
@@ -73,7 +89,19 @@ Q_SIGNALS:
     void configFileNameChanged(const QString &);
 
 private:
+    friend class ::SourceRegistryTest;
+
     SourceRegistryPrivate * const d;
+
+    // Used by tests
+    // True if models of @p sourceId are shared, see createModelFromConfigGroup()
+    bool isSourceShareable(const QString &sourceId) const;
+    // Ids of the plugin sources whose library has been scheduled for loading
+    // in a worker thread, and which have not been used yet
+    QStringList pendingPluginPreloads() const;
+    // How many times the plugin metadata has been queried from sycoca since
+    // the process started
+    static int pluginMetadataQueryCount();
 };
 
 } // namespace Homerun
@@ -48,6 +48,7 @@ DirConfigurationWidget::DirConfigurationWidget(const KConfigGroup &group)
     }
 
     m_ui->titleLineEdit->setText(group.readEntry("rootName", QString()));
+    m_ui->recursiveSearchCheckBox->setChecked(group.readEntry("recursiveSearch", false));
 }
 
 DirConfigurationWidget::~DirConfigurationWidget()
@@ -62,6 +63,7 @@ void DirConfigurationWidget::save()
 
     configGroup().writePathEntry("rootUrl", url.url());
     configGroup().writeEntry("rootName", title);
+    configGroup().writeEntry("recursiveSearch", m_ui->recursiveSearchCheckBox->isChecked());
 }
 
 #include <dirconfigurationwidget.moc>
@@ -0,0 +1,282 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <dirindex.h>
+
+// Local
+#include <textfilter.h>
+
+// KDE
+#include <KDebug>
+#include <KDirWatch>
+
+// Qt
+#include <QDir>
+#include <QQueue>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+namespace Homerun {
+
+// Keeps the index compact even if the root folder is a huge tree
+static const int MAX_ENTRIES = 200000;
+
+// KDirWatch falls back to polling when it runs out of inotify watches, stay
+// well below the default limit
+static const int MAX_WATCHED_DIRS = 4096;
+
+// Group bursts of changes, for example when a folder is being copied
+static const int RESCAN_DELAY = 500;
+
+static QVector<DirIndexEntry> scanDir(const QString &path, QStringList *subDirs)
+{
+    QVector<DirIndexEntry> entries;
+    const QFileInfoList infoList = QDir(path).entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot);
+    entries.reserve(infoList.count());
+    Q_FOREACH(const QFileInfo &info, infoList) {
+        DirIndexEntry entry;
+        entry.name = info.fileName();
+        entry.key = HomerunInternal::TextFilter::foldedKey(entry.name);
+        entry.isDir = info.isDir();
+        entry.isSymLink = info.isSymLink();
+        if (entry.isDir && !entry.isSymLink) {
+            *subDirs << info.absoluteFilePath();
+        }
+        entries << entry;
+    }
+    return entries;
+}
+
+// Runs in a worker thread
+static DirIndexData scanTree(const QString &rootPath, bool recursive, QSharedPointer<QAtomicInt> cancelled)
+{
+    DirIndexData data;
+    int entryCount = 0;
+    QQueue<QString> queue;
+    queue.enqueue(rootPath);
+    while (!queue.isEmpty() && entryCount < MAX_ENTRIES && *cancelled == 0) {
+        const QString path = queue.dequeue();
+        if (!QFileInfo(path).isDir()) {
+            continue;
+        }
+        QStringList subDirs;
+        const QVector<DirIndexEntry> entries = scanDir(path, &subDirs);
+        entryCount += entries.count();
+        data.insert(path, entries);
+        if (recursive) {
+            Q_FOREACH(const QString &subDir, subDirs) {
+                queue.enqueue(subDir);
+            }
+        }
+    }
+    return data;
+}
+
+static QSet<QString> subDirNames(const QVector<DirIndexEntry> &entries)
+{
+    QSet<QString> names;
+    Q_FOREACH(const DirIndexEntry &entry, entries) {
+        if (entry.isDir && !entry.isSymLink) {
+            names << entry.name;
+        }
+    }
+    return names;
+}
+
+typedef QHash<QString, QWeakPointer<DirIndex> > DirIndexHash;
+
+static DirIndexHash *sharedIndexes()
+{
+    static DirIndexHash indexes;
+    return &indexes;
+}
+
+QSharedPointer<DirIndex> DirIndex::indexForPath(const QString &rootPath_)
+{
+    const QString rootPath = QDir::cleanPath(rootPath_);
+    QSharedPointer<DirIndex> index = sharedIndexes()->value(rootPath).toStrongRef();
+    if (!index) {
+        index = QSharedPointer<DirIndex>(new DirIndex(rootPath));
+        sharedIndexes()->insert(rootPath, index.toWeakRef());
+    }
+    return index;
+}
+
+int DirIndex::sharedIndexCount()
+{
+    return sharedIndexes()->count();
+}
+
+DirIndex::DirIndex(const QString &rootPath)
+: m_rootPath(rootPath)
+, m_entryCount(0)
+, m_dirWatch(new KDirWatch(this))
+, m_watchedDirCount(0)
+, m_rescanTimer(new QTimer(this))
+, m_cancelled(new QAtomicInt(0))
+, m_ready(false)
+{
+    connect(m_dirWatch, SIGNAL(dirty(QString)), SLOT(scheduleRescan(QString)));
+    connect(m_dirWatch, SIGNAL(created(QString)), SLOT(scheduleRescan(QString)));
+    connect(m_dirWatch, SIGNAL(deleted(QString)), SLOT(removeDir(QString)));
+
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(RESCAN_DELAY);
+    connect(m_rescanTimer, SIGNAL(timeout()), SLOT(startPendingScans()));
+
+    startScan(m_rootPath, true);
+}
+
+DirIndex::~DirIndex()
+{
+    // Let running scans stop early, their results are ignored
+    m_cancelled->fetchAndStoreOrdered(1);
+
+    // Do not let the hash grow as the user searches different folders. A new
+    // index for the same folder may already have replaced this one.
+    DirIndexHash::Iterator it = sharedIndexes()->find(m_rootPath);
+    if (it != sharedIndexes()->end() && it.value().isNull()) {
+        sharedIndexes()->erase(it);
+    }
+}
+
+QString DirIndex::rootPath() const
+{
+    return m_rootPath;
+}
+
+bool DirIndex::isReady() const
+{
+    return m_ready;
+}
+
+DirIndexData DirIndex::data() const
+{
+    return m_data;
+}
+
+void DirIndex::scheduleRescan(const QString &path)
+{
+    if (path != m_rootPath && !path.startsWith(m_rootPath + '/')) {
+        return;
+    }
+    m_pendingDirs << path;
+    m_rescanTimer->start();
+}
+
+void DirIndex::removeDir(const QString &path)
+{
+    if (path == m_rootPath) {
+        removeSubtree(path);
+        updated();
+        return;
+    }
+    // Rescanning the parent takes care of removing the subtree
+    scheduleRescan(QFileInfo(path).absolutePath());
+}
+
+void DirIndex::startPendingScans()
+{
+    Q_FOREACH(const QString &path, m_pendingDirs) {
+        startScan(path, false);
+    }
+    m_pendingDirs.clear();
+}
+
+void DirIndex::startScan(const QString &path, bool recursive)
+{
+    if (recursive && m_entryCount >= MAX_ENTRIES) {
+        kWarning() << "Too many entries in" << m_rootPath << ", not indexing" << path;
+        return;
+    }
+    QFutureWatcher<DirIndexData> *watcher = new QFutureWatcher<DirIndexData>(this);
+    connect(watcher, SIGNAL(finished()), SLOT(slotScanFinished()));
+    m_scans.insert(watcher, qMakePair(path, recursive));
+    watcher->setFuture(QtConcurrent::run(scanTree, path, recursive, m_cancelled));
+}
+
+void DirIndex::slotScanFinished()
+{
+    QFutureWatcher<DirIndexData> *watcher = static_cast<QFutureWatcher<DirIndexData> *>(sender());
+    QPair<QString, bool> scan = m_scans.take(watcher);
+    watcher->deleteLater();
+
+    mergeScanResult(scan.first, scan.second, watcher->result());
+    if (m_scans.isEmpty()) {
+        m_ready = true;
+    }
+    updated();
+}
+
+void DirIndex::mergeScanResult(const QString &path, bool recursive, const DirIndexData &result)
+{
+    if (!result.contains(path)) {
+        // Directory is gone
+        removeSubtree(path);
+        return;
+    }
+    if (!recursive) {
+        // Only one directory has been scanned: index new subdirs and forget
+        // about removed ones
+        const QSet<QString> oldDirs = subDirNames(m_data.value(path));
+        const QSet<QString> newDirs = subDirNames(result.value(path));
+        Q_FOREACH(const QString &name, oldDirs - newDirs) {
+            removeSubtree(path + '/' + name);
+        }
+        Q_FOREACH(const QString &name, newDirs - oldDirs) {
+            startScan(path + '/' + name, true);
+        }
+    }
+    for (auto it = result.constBegin(), end = result.constEnd(); it != end; ++it) {
+        m_entryCount += it.value().count() - m_data.value(it.key()).count();
+        m_data.insert(it.key(), it.value());
+        watchDir(it.key());
+    }
+}
+
+void DirIndex::removeSubtree(const QString &path)
+{
+    const QString prefix = path + '/';
+    for (auto it = m_data.begin(); it != m_data.end();) {
+        if (it.key() == path || it.key().startsWith(prefix)) {
+            m_entryCount -= it.value().count();
+            if (m_dirWatch->contains(it.key())) {
+                m_dirWatch->removeDir(it.key());
+                --m_watchedDirCount;
+            }
+            it = m_data.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DirIndex::watchDir(const QString &path)
+{
+    if (m_watchedDirCount >= MAX_WATCHED_DIRS || m_dirWatch->contains(path)) {
+        return;
+    }
+    m_dirWatch->addDir(path);
+    ++m_watchedDirCount;
+}
+
+} // namespace Homerun
+
+#include <dirindex.moc>
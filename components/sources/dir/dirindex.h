@@ -0,0 +1,119 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIRINDEX_H
+#define DIRINDEX_H
+
+// Local
+
+// Qt
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+// KDE
+
+class KDirWatch;
+
+class QTimer;
+
+namespace Homerun {
+
+struct DirIndexEntry
+{
+    QString name;
+    /// Casefolded name, see HomerunInternal::TextFilter::foldedKey()
+    QString key;
+    bool isDir;
+    bool isSymLink;
+};
+
+/**
+ * Maps the absolute path of each indexed directory to its children.
+ * Implicitly shared, so a copy can be handed to a worker thread.
+ */
+typedef QHash<QString, QVector<DirIndexEntry> > DirIndexData;
+
+/**
+ * A filename index of a local directory subtree.
+ *
+ * The index is built on a background thread and kept current with KDirWatch:
+ * when a directory changes, only this directory is scanned again. Hidden
+ * files are skipped and symlinked directories are not followed.
+ *
+ * Indexes are shared: use DirIndex::indexForPath() to get one.
+ */
+class DirIndex : public QObject
+{
+    Q_OBJECT
+public:
+    ~DirIndex();
+
+    static QSharedPointer<DirIndex> indexForPath(const QString &rootPath);
+
+    /**
+     * Returns the number of indexes in use, for tests
+     */
+    static int sharedIndexCount();
+
+    QString rootPath() const;
+
+    /**
+     * Returns true once the initial scan is over
+     */
+    bool isReady() const;
+
+    DirIndexData data() const;
+
+Q_SIGNALS:
+    void updated();
+
+private Q_SLOTS:
+    void scheduleRescan(const QString &path);
+    void removeDir(const QString &path);
+    void startPendingScans();
+    void slotScanFinished();
+
+private:
+    explicit DirIndex(const QString &rootPath);
+
+    void startScan(const QString &path, bool recursive);
+    void mergeScanResult(const QString &path, bool recursive, const DirIndexData &result);
+    void removeSubtree(const QString &path);
+    void watchDir(const QString &path);
+
+    QString m_rootPath;
+    DirIndexData m_data;
+    int m_entryCount;
+    KDirWatch *m_dirWatch;
+    int m_watchedDirCount;
+    QTimer *m_rescanTimer;
+    QSet<QString> m_pendingDirs;
+    QSharedPointer<QAtomicInt> m_cancelled;
+    QHash<QFutureWatcher<DirIndexData> *, QPair<QString, bool> > m_scans;
+    bool m_ready;
+};
+
+} // namespace Homerun
+
+#endif /* DIRINDEX_H */
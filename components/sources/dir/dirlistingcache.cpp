@@ -0,0 +1,250 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <dirlistingcache.h>
+
+// Local
+#include <largedirmodel.h>
+
+// KDE
+#include <KDebug>
+#include <KDirLister>
+#include <KGlobal>
+
+// Qt
+#include <QTimer>
+#include <QtConcurrentRun>
+
+namespace Homerun
+{
+
+static const int MAX_LISTINGS = 16;
+
+static const int MAX_ITEMS = 20000;
+
+// How long the user must stay on a folder before it is prefetched
+static const int PREFETCH_DELAY = 150;
+
+static inline QString keyForUrl(const KUrl &url)
+{
+    return url.url(KUrl::RemoveTrailingSlash);
+}
+
+K_GLOBAL_STATIC(DirListingCache, s_dirListingCache)
+
+DirListingCache *DirListingCache::instance()
+{
+    return s_dirListingCache;
+}
+
+DirListingCache::DirListingCache()
+: m_prefetchTimer(new QTimer(this))
+, m_countWatcher(new QFutureWatcher<int>(this))
+, m_maxListings(MAX_LISTINGS)
+, m_maxItems(MAX_ITEMS)
+, m_revalidateLocalListings(false)
+{
+    m_prefetchTimer->setSingleShot(true);
+    m_prefetchTimer->setInterval(PREFETCH_DELAY);
+    connect(m_prefetchTimer, SIGNAL(timeout()), SLOT(startPendingPrefetch()));
+    connect(m_countWatcher, SIGNAL(finished()), SLOT(slotCountFinished()));
+}
+
+void DirListingCache::prefetch(const KUrl &url)
+{
+    const QString key = keyForUrl(url);
+    if (m_listings.contains(key)) {
+        touch(key);
+        return;
+    }
+    m_pendingUrl = url;
+    m_prefetchTimer->start();
+}
+
+bool DirListingCache::isCached(const KUrl &url) const
+{
+    QHash<QString, Listing>::ConstIterator it = m_listings.find(keyForUrl(url));
+    return it != m_listings.constEnd() && it->lister->isFinished();
+}
+
+bool DirListingCache::needsRevalidation(const KUrl &url) const
+{
+    return isCached(url) && (m_revalidateLocalListings || !url.isLocalFile());
+}
+
+KUrl::List DirListingCache::cachedUrls() const
+{
+    KUrl::List urls;
+    Q_FOREACH(const QString &key, m_lruKeys) {
+        urls << KUrl(key);
+    }
+    return urls;
+}
+
+void DirListingCache::clear()
+{
+    m_prefetchTimer->stop();
+    m_pendingUrl = KUrl();
+    m_queuedCountUrl = KUrl();
+    m_countedUrl = KUrl();
+    Q_FOREACH(const QString &key, m_lruKeys) {
+        removeListing(key);
+    }
+}
+
+void DirListingCache::setLimits(int maxListings, int maxItems)
+{
+    m_maxListings = maxListings;
+    m_maxItems = maxItems;
+    evict();
+}
+
+void DirListingCache::setRevalidateLocalListings(bool value)
+{
+    m_revalidateLocalListings = value;
+}
+
+void DirListingCache::startPendingPrefetch()
+{
+    const KUrl url = m_pendingUrl;
+    m_pendingUrl = KUrl();
+    const QString key = keyForUrl(url);
+    if (m_listings.contains(key)) {
+        touch(key);
+        return;
+    }
+    if (!url.isLocalFile()) {
+        startListing(url);
+        return;
+    }
+    if (LargeDirModel::isLargeDir(url.toLocalFile())) {
+        return;
+    }
+    if (m_countWatcher->isRunning()) {
+        // Count it once the running count is finished
+        m_queuedCountUrl = url;
+        return;
+    }
+    startCount(url);
+}
+
+void DirListingCache::startCount(const KUrl &url)
+{
+    m_countedUrl = url;
+    m_countWatcher->setFuture(QtConcurrent::run(LargeDirModel::countEntries, url.toLocalFile()));
+}
+
+void DirListingCache::slotCountFinished()
+{
+    const KUrl url = m_countedUrl;
+    m_countedUrl = KUrl();
+    if (!url.isValid()) {
+        // Dropped by clear()
+        return;
+    }
+    LargeDirModel::recordEntryCount(url.toLocalFile(), m_countWatcher->result());
+
+    if (m_queuedCountUrl.isValid()) {
+        // The user moved on to another folder, do not list this one
+        const KUrl queuedUrl = m_queuedCountUrl;
+        m_queuedCountUrl = KUrl();
+        startCount(queuedUrl);
+        return;
+    }
+
+    if (LargeDirModel::isLargeDir(url.toLocalFile())) {
+        // Too large to be held by the cache
+        return;
+    }
+    if (!m_listings.contains(keyForUrl(url))) {
+        startListing(url);
+    }
+}
+
+void DirListingCache::startListing(const KUrl &url)
+{
+    const QString key = keyForUrl(url);
+    KDirLister *lister = new KDirLister(this);
+    // Do not bother the user with errors about folders they did not open
+    lister->setAutoErrorHandlingEnabled(false, 0);
+    lister->setDelayedMimeTypes(true);
+    connect(lister, SIGNAL(completed()), SLOT(slotCompleted()));
+    connect(lister, SIGNAL(canceled()), SLOT(slotCanceled()));
+
+    Listing listing;
+    listing.lister = lister;
+    listing.itemCount = 0;
+    m_listings.insert(key, listing);
+    m_lruKeys.append(key);
+
+    lister->openUrl(url);
+    evict();
+}
+
+void DirListingCache::slotCompleted()
+{
+    KDirLister *lister = static_cast<KDirLister *>(sender());
+    const QString key = keyForUrl(lister->url());
+    QHash<QString, Listing>::Iterator it = m_listings.find(key);
+    if (it == m_listings.end()) {
+        return;
+    }
+    it->itemCount = lister->items().count();
+    evict();
+}
+
+void DirListingCache::slotCanceled()
+{
+    KDirLister *lister = static_cast<KDirLister *>(sender());
+    removeListing(keyForUrl(lister->url()));
+}
+
+void DirListingCache::touch(const QString &key)
+{
+    m_lruKeys.removeOne(key);
+    m_lruKeys.append(key);
+}
+
+void DirListingCache::removeListing(const QString &key)
+{
+    Listing listing = m_listings.take(key);
+    m_lruKeys.removeOne(key);
+    if (listing.lister) {
+        listing.lister->deleteLater();
+    }
+}
+
+void DirListingCache::evict()
+{
+    int itemCount = 0;
+    Q_FOREACH(const Listing &listing, m_listings) {
+        itemCount += listing.itemCount;
+    }
+    // Never evict the most recent listing, even if it is over budget on its own
+    while (m_lruKeys.count() > 1 && (m_lruKeys.count() > m_maxListings || itemCount > m_maxItems)) {
+        const QString key = m_lruKeys.first();
+        itemCount -= m_listings.value(key).itemCount;
+        removeListing(key);
+    }
+}
+
+} // namespace Homerun
+
+#include <dirlistingcache.moc>
@@ -0,0 +1,129 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIRLISTINGCACHE_H
+#define DIRLISTINGCACHE_H
+
+// Local
+
+// Qt
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+
+// KDE
+#include <KUrl>
+
+class KDirLister;
+
+class QTimer;
+
+class DirModelTest;
+
+namespace Homerun {
+
+/**
+ * Internal. Lists folders the user is likely to open next, so that DirModel
+ * can show them without waiting.
+ *
+ * Listings are held by KDirLister instances owned by the cache: as long as a
+ * listing is held, KDirLister serves it from its own cache to any other
+ * lister opening the same url. The number of held listings and their total
+ * number of items are capped, least recently used listings are dropped
+ * first.
+ *
+ * Local folders are counted in a worker thread before being listed. Large
+ * ones are not listed: they are recorded as such, so that they are opened
+ * with a LargeDirModel.
+ */
+class DirListingCache : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * Use instance() instead, there is one cache for the whole process
+     */
+    DirListingCache();
+
+    static DirListingCache *instance();
+
+    /**
+     * Schedules a listing of @p url. Only the last url passed within a short
+     * delay is listed, so that moving the mouse over many folders does not
+     * start a listing for each of them.
+     */
+    void prefetch(const KUrl &url);
+
+    /**
+     * Returns true if a complete listing of @p url is held by the cache
+     */
+    bool isCached(const KUrl &url) const;
+
+    /**
+     * Returns true if DirModel must list @p url again after showing its
+     * cached listing. Local folders are kept up to date by KDirWatch, remote
+     * ones are not.
+     */
+    bool needsRevalidation(const KUrl &url) const;
+
+private Q_SLOTS:
+    void startPendingPrefetch();
+    void slotCountFinished();
+    void slotCompleted();
+    void slotCanceled();
+
+private:
+    friend class ::DirModelTest;
+
+    struct Listing
+    {
+        KDirLister *lister;
+        int itemCount;
+    };
+
+    QTimer *m_prefetchTimer;
+    KUrl m_pendingUrl;
+    QFutureWatcher<int> *m_countWatcher;
+    KUrl m_countedUrl;
+    KUrl m_queuedCountUrl;
+    int m_maxListings;
+    int m_maxItems;
+    bool m_revalidateLocalListings;
+    QHash<QString, Listing> m_listings;
+    // Least recently used first
+    QStringList m_lruKeys;
+
+    void startCount(const KUrl &url);
+    void startListing(const KUrl &url);
+    void touch(const QString &key);
+    void removeListing(const QString &key);
+    void evict();
+
+    // Used by tests
+    KUrl::List cachedUrls() const;
+    void clear();
+    void setLimits(int maxListings, int maxItems);
+    // Makes needsRevalidation() return true for local folders too
+    void setRevalidateLocalListings(bool value);
+};
+
+} // namespace Homerun
+
+#endif /* DIRLISTINGCACHE_H */
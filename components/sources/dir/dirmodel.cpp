@@ -22,11 +22,16 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <dirconfigurationwidget.h>
+#include <dirlistingcache.h>
+#include <dirsearchmodel.h>
+#include <largedirmodel.h>
 #include <favoriteutils.h>
 
 // libhomerun
 #include <actionlist.h>
+#include <actionlistmodel.h>
 #include <pathmodel.h>
+#include <rowdata.h>
 
 // KDE
 #include <KConfigGroup>
@@ -47,13 +52,21 @@ static inline KFileItem itemForIndex(const QModelIndex &index)
     return index.data(KDirModel::FileItemRole).value<KFileItem>();
 }
 
+static inline QString filterTextForRow(const QAbstractItemModel *model, int row)
+{
+    return model->index(row, KDirModel::Name).data(Qt::DisplayRole).toString();
+}
+
 //- DirModel ------------------------------------------------------
-QVariantMap DirModel::sourceArguments(const KUrl &rootUrl, const QString &rootName, const KUrl &url)
+QVariantMap DirModel::sourceArguments(const KUrl &rootUrl, const QString &rootName, const KUrl &url, bool recursiveSearch)
 {
     QVariantMap args;
     args.insert("rootUrl", rootUrl.url());
     args.insert("rootName", rootName);
     args.insert("url", url.url());
+    if (recursiveSearch) {
+        args.insert("recursiveSearch", true);
+    }
     return args;
 }
 
@@ -61,8 +74,23 @@ QVariantMap DirModel::sourceArguments(const KUrl &rootUrl, const QString &rootNa
 DirModel::DirModel(QObject *parent)
 : KDirSortFilterProxyModel(parent)
 , m_pathModel(new PathModel(this))
+, m_recursiveSearch(false)
+, m_revalidating(false)
+, m_filter(HomerunInternal::TextFilter::FuzzyMode)
 {
-    setSourceModel(new KDirModel(this));
+    // Keep m_filter in sync with the source model. This must be done before
+    // calling setSourceModel() so that our slots are called before
+    // QSortFilterProxyModel ones, which call filterAcceptsRow().
+    KDirModel *dirModel = new KDirModel(this);
+    connect(dirModel, SIGNAL(rowsInserted(QModelIndex,int,int)),
+        SLOT(onSourceRowsInserted(QModelIndex,int,int)));
+    connect(dirModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+        SLOT(onSourceRowsRemoved(QModelIndex,int,int)));
+    connect(dirModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+        SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+    connect(dirModel, SIGNAL(modelReset()),
+        SLOT(onSourceModelReset()));
+    setSourceModel(dirModel);
     setSortFoldersFirst(true);
 
     QHash<int, QByteArray> roles;
@@ -75,30 +103,36 @@ DirModel::DirModel(QObject *parent)
 
     dirLister()->setDelayedMimeTypes(true);
     connect(dirLister(), SIGNAL(started(KUrl)), SLOT(emitRunningChanged()));
-    connect(dirLister(), SIGNAL(completed()), SLOT(emitRunningChanged()));
+    connect(dirLister(), SIGNAL(completed()), SLOT(slotCompleted()));
 }
 
-void DirModel::init(const KUrl &rootUrl, const QString &rootName, const KUrl &url)
+void DirModel::init(const KUrl &rootUrl, const QString &rootName, const KUrl &url, bool recursiveSearch)
 {
     m_rootUrl = rootUrl;
     m_rootName = rootName;
-    initPathModel(url);
+    m_recursiveSearch = recursiveSearch;
+    fillPathModel(m_pathModel, m_rootUrl, m_rootName, url, m_recursiveSearch);
+    if (DirListingCache::instance()->needsRevalidation(url)) {
+        // We are going to be served a cached listing which may be outdated,
+        // list it again once it is shown
+        m_revalidateUrl = url;
+    }
     dirLister()->openUrl(url);
 }
 
-void DirModel::initPathModel(const KUrl &openedUrl)
+void DirModel::fillPathModel(PathModel *pathModel, const KUrl &rootUrl_, const QString &rootName, const KUrl &openedUrl, bool recursiveSearch)
 {
-    QVariantMap args = sourceArguments(m_rootUrl, m_rootName, m_rootUrl);
-    m_pathModel->addPath(m_rootName, SOURCE_ID, args);
+    QVariantMap args = sourceArguments(rootUrl_, rootName, rootUrl_, recursiveSearch);
+    pathModel->addPath(rootName, SOURCE_ID, args);
 
-    KUrl rootUrl = m_rootUrl;
+    KUrl rootUrl = rootUrl_;
     // Needed for KUrl::relativeUrl
     rootUrl.adjustPath(KUrl::AddTrailingSlash);
     QString relativePath = KUrl::relativeUrl(rootUrl, openedUrl);
     if (relativePath == "./") {
         return;
     }
-    KUrl url = m_rootUrl;
+    KUrl url = rootUrl_;
     Q_FOREACH(const QString &token, relativePath.split('/')) {
         if (token.isEmpty()) {
             // Just in case relativePath ends with '/'
@@ -106,7 +140,7 @@ void DirModel::initPathModel(const KUrl &openedUrl)
         }
         url.addPath(token);
         args["url"] = url.url();
-        m_pathModel->addPath(token, SOURCE_ID, args);
+        pathModel->addPath(token, SOURCE_ID, args);
     }
 }
 
@@ -117,17 +151,32 @@ KDirLister *DirModel::dirLister() const
 
 QVariant DirModel::data(const QModelIndex &index, int role) const
 {
-    KFileItem item = qvariant_cast<KFileItem>(QSortFilterProxyModel::data(index, KDirModel::FileItemRole));
+    return sourceIndexData(mapToSource(index), role);
+}
+
+QVariantList DirModel::rowData(int first, int count, const QStringList &roleNames) const
+{
+    return RowData::fetch(this, first, count, roleNames, &DirModel::sourceIndexAt, &DirModel::sourceIndexData);
+}
+
+QModelIndex DirModel::sourceIndexAt(int row) const
+{
+    return mapToSource(index(row, 0));
+}
+
+QVariant DirModel::sourceIndexData(const QModelIndex &sourceIndex, int role) const
+{
+    if (!sourceIndex.isValid()) {
+        return QVariant();
+    }
+    KFileItem item = itemForIndex(sourceIndex);
 
     if (role == Qt::DecorationRole && !item.isFinalIconKnown()) {
         item.determineMimeType();
     }
 
     if (role != FavoriteIdRole && role != HasActionListRole && role != ActionListRole) {
-        return QSortFilterProxyModel::data(index, role);
-    }
-    if (index.row() < 0 || index.row() >= rowCount()) {
-        return QVariant();
+        return sourceIndex.data(role);
     }
     if (role == HasActionListRole) {
         return true;
@@ -139,7 +188,7 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
             return QString();
         }
     } else if (role == ActionListRole) {
-        return ActionList::createListForFileItem(item);
+        return QVariant::fromValue<QObject *>(ActionList::sharedModelForFileItem(item));
     }
     // Never reached
     return QVariant();
@@ -157,7 +206,8 @@ QString DirModel::name() const
 
 bool DirModel::running() const
 {
-    return !dirLister()->isFinished();
+    // Do not show the user we are checking a cached listing is up to date
+    return !m_revalidating && !dirLister()->isFinished();
 }
 
 PathModel *DirModel::pathModel() const
@@ -167,23 +217,113 @@ PathModel *DirModel::pathModel() const
 
 QString DirModel::query() const
 {
-    return filterRegExp().pattern();
+    return m_filter.query();
 }
 
 void DirModel::setQuery(const QString &value)
 {
-    if (value == query()) {
+    if (!m_filter.setQuery(value)) {
         return;
     }
-    setFilterRegExp(QRegExp(value, Qt::CaseInsensitive));
+    // Not invalidateFilter(): rows must be sorted again by relevance
+    invalidate();
     queryChanged(value);
 }
 
+bool DirModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (sourceParent.isValid()) {
+        // We only list one level
+        return true;
+    }
+    return m_filter.isAccepted(sourceRow);
+}
+
+bool DirModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (!m_filter.query().isEmpty() && !left.parent().isValid() && !right.parent().isValid()) {
+        // Keep folders first, then sort by relevance
+        const bool leftIsDir = itemForIndex(left).isDir();
+        const bool rightIsDir = itemForIndex(right).isDir();
+        if (leftIsDir == rightIsDir) {
+            const int leftScore = m_filter.score(left.row());
+            const int rightScore = m_filter.score(right.row());
+            if (leftScore != rightScore) {
+                return (leftScore > rightScore) == (sortOrder() == Qt::AscendingOrder);
+            }
+        }
+    }
+    return KDirSortFilterProxyModel::lessThan(left, right);
+}
+
+void DirModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    QStringList texts;
+    for (int row = first; row <= last; ++row) {
+        texts << filterTextForRow(sourceModel(), row);
+    }
+    m_filter.insertTexts(first, texts);
+}
+
+void DirModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+    m_filter.removeRows(first, last);
+}
+
+void DirModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (topLeft.parent().isValid()) {
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        m_filter.updateText(row, filterTextForRow(sourceModel(), row));
+    }
+}
+
+void DirModel::onSourceModelReset()
+{
+    QStringList texts;
+    for (int row = 0, count = sourceModel()->rowCount(); row < count; ++row) {
+        texts << filterTextForRow(sourceModel(), row);
+    }
+    m_filter.setTexts(texts);
+}
+
 void DirModel::emitRunningChanged()
 {
     runningChanged(running());
 }
 
+void DirModel::slotCompleted()
+{
+    const KUrl url = dirLister()->url();
+    if (url.isLocalFile()) {
+        LargeDirModel::recordEntryCount(url.toLocalFile(), dirLister()->items().count());
+    }
+    if (m_revalidateUrl.isValid()) {
+        m_revalidating = true;
+        dirLister()->updateDirectory(m_revalidateUrl);
+        m_revalidateUrl = KUrl();
+    } else {
+        m_revalidating = false;
+    }
+    emitRunningChanged();
+}
+
+void DirModel::prefetch(int row)
+{
+    KFileItem item = itemForIndex(index(row, 0));
+    if (item.isDir()) {
+        DirListingCache::instance()->prefetch(item.url());
+    }
+}
+
 bool DirModel::trigger(int row, const QString &actionId, const QVariant &actionArg)
 {
     QModelIndex idx = index(row, 0);
@@ -191,7 +331,7 @@ bool DirModel::trigger(int row, const QString &actionId, const QVariant &actionA
 
     if (actionId.isEmpty()) {
         if (item.isDir()) {
-            openSourceRequested(SOURCE_ID, sourceArguments(m_rootUrl, m_rootName, item.url()));
+            openSourceRequested(SOURCE_ID, sourceArguments(m_rootUrl, m_rootName, item.url(), m_recursiveSearch));
         } else {
             item.run();
         }
@@ -213,17 +353,19 @@ QAbstractItemModel *DirSource::createModelFromArguments(const QVariantMap &args)
     KUrl rootUrl = args.value("rootUrl").toString();
     QString rootName = args.value("rootName").toString();
     KUrl url = args.value("url").toString();
-    return createModel(rootUrl, rootName, url);
+    bool recursiveSearch = args.value("recursiveSearch").toBool();
+    return createModel(rootUrl, rootName, url, recursiveSearch);
 }
 
 QAbstractItemModel *DirSource::createModelFromConfigGroup(const KConfigGroup &group)
 {
     KUrl rootUrl = group.readPathEntry("rootUrl", QDir::homePath());
     QString rootName = group.readEntry("rootName", QString());
-    return createModel(rootUrl, rootName, KUrl());
+    bool recursiveSearch = group.readEntry("recursiveSearch", false);
+    return createModel(rootUrl, rootName, KUrl(), recursiveSearch);
 }
 
-QAbstractItemModel *DirSource::createModel(const KUrl &rootUrl_, const QString &rootName_, const KUrl &url_)
+QAbstractItemModel *DirSource::createModel(const KUrl &rootUrl_, const QString &rootName_, const KUrl &url_, bool recursiveSearch_)
 {
     KUrl rootUrl = rootUrl_;
     QString rootName = rootName_;
@@ -241,10 +383,26 @@ QAbstractItemModel *DirSource::createModel(const KUrl &rootUrl_, const QString &
     if (!url.isValid()) {
         url = rootUrl;
     }
+    // The index can only be built for local folders
+    bool recursiveSearch = recursiveSearch_ && rootUrl.isLocalFile();
+
+    // RecursiveDirModel needs a DirModel for the current folder. Do not count
+    // entries here, this would block the UI on slow file systems: folders are
+    // known to be large once they have been listed or prefetched.
+    if (!recursiveSearch && url.isLocalFile() && LargeDirModel::isLargeDir(url.toLocalFile())) {
+        LargeDirModel *model = new LargeDirModel;
+        model->init(rootUrl, rootName, url);
+        return model;
+    }
 
     DirModel *model = new DirModel;
-    model->init(rootUrl, rootName, url);
-    return model;
+    model->init(rootUrl, rootName, url, recursiveSearch);
+    if (!recursiveSearch) {
+        return model;
+    }
+    QSharedPointer<DirIndex> index = DirIndex::indexForPath(rootUrl.toLocalFile());
+    DirSearchModel *searchModel = new DirSearchModel(index, rootUrl, rootName, url);
+    return new RecursiveDirModel(model, searchModel);
 }
 
 bool DirSource::isConfigurable() const
@@ -22,6 +22,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <abstractsource.h>
+#include <textfilter.h>
 
 // Qt
 
@@ -50,7 +51,7 @@ class DirModel : public KDirSortFilterProxyModel
 public:
     explicit DirModel(QObject *parent = 0);
 
-    void init(const KUrl &rootUrl, const QString &rootName, const KUrl &url);
+    void init(const KUrl &rootUrl, const QString &rootName, const KUrl &url, bool recursiveSearch = false);
 
     enum {
         FavoriteIdRole = Qt::UserRole + 1,
@@ -60,10 +61,18 @@ public:
 
     Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
 
+    /**
+     * Called by the view when the user hovers or focuses a row. If the row is
+     * a folder, lists it in the background so that opening it is immediate.
+     */
+    Q_INVOKABLE void prefetch(int row);
+
     KDirLister *dirLister() const;
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
 
+    Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
     PathModel *pathModel() const;
 
     int count() const;
@@ -76,7 +85,12 @@ public:
 
     void setQuery(const QString &query);
 
-    static QVariantMap sourceArguments(const KUrl &rootUrl, const QString &rootName, const KUrl &url);
+    static QVariantMap sourceArguments(const KUrl &rootUrl, const QString &rootName, const KUrl &url, bool recursiveSearch = false);
+
+    /**
+     * Adds to @p pathModel one path per folder, from @p rootUrl to @p url
+     */
+    static void fillPathModel(PathModel *pathModel, const KUrl &rootUrl, const QString &rootName, const KUrl &url, bool recursiveSearch = false);
 
 Q_SIGNALS:
     void countChanged();
@@ -84,15 +98,29 @@ Q_SIGNALS:
     void openSourceRequested(const QString &sourceId, const QVariantMap &sourceArguments);
     void queryChanged(const QString &);
 
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const; // reimp
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const; // reimp
+
 private Q_SLOTS:
     void emitRunningChanged();
+    void slotCompleted();
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onSourceModelReset();
 
 private:
     PathModel *m_pathModel;
     KUrl m_rootUrl;
     QString m_rootName;
+    bool m_recursiveSearch;
+    KUrl m_revalidateUrl;
+    bool m_revalidating;
+    HomerunInternal::TextFilter m_filter;
 
-    void initPathModel(const KUrl &url);
+    QModelIndex sourceIndexAt(int row) const;
+    QVariant sourceIndexData(const QModelIndex &sourceIndex, int role) const;
 };
 
 class DirSource : public AbstractSource
@@ -105,7 +133,7 @@ public:
     SourceConfigurationWidget *createConfigurationWidget(const KConfigGroup &group);
 
 private:
-    QAbstractItemModel *createModel(const KUrl &rootUrl, const QString &rootName, const KUrl &url);
+    QAbstractItemModel *createModel(const KUrl &rootUrl, const QString &rootName, const KUrl &url, bool recursiveSearch);
 };
 
 } // namespace Homerun
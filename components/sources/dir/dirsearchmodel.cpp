@@ -0,0 +1,519 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <dirsearchmodel.h>
+
+// Local
+#include <dirlistingcache.h>
+#include <dirmodel.h>
+#include <favoriteutils.h>
+#include <textfilter.h>
+
+// libhomerun
+#include <actionlist.h>
+#include <actionlistmodel.h>
+
+// KDE
+#include <KDebug>
+#include <KFileItem>
+#include <KLocale>
+#include <KMimeType>
+
+// Qt
+#include <QDir>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+namespace Homerun
+{
+
+static const char *SOURCE_ID = "Dir";
+
+static const int MAX_RESULTS = 200;
+
+// Number of index entries to look at before making results available
+static const int BATCH_SIZE = 5000;
+
+// Avoid restarting the search for each change while the index is being built
+static const int SEARCH_DELAY = 200;
+
+static bool resultLessThan(const DirSearchResult &r1, const DirSearchResult &r2)
+{
+    // Best results first
+    return r1.score > r2.score;
+}
+
+static bool sameResults(const DirSearchResultList &list1, const DirSearchResultList &list2)
+{
+    if (list1.count() != list2.count()) {
+        return false;
+    }
+    for (int idx = 0; idx < list1.count(); ++idx) {
+        if (list1.at(idx).path != list2.at(idx).path || list1.at(idx).score != list2.at(idx).score) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool shallowerThan(const QString &path1, const QString &path2)
+{
+    return path1.count('/') < path2.count('/');
+}
+
+//- DirSearchJob ----------------------------------------------------
+DirSearchJob::DirSearchJob(const DirIndexData &data, const QString &basePath, const QString &query, int maxResults)
+: m_data(data)
+, m_basePath(basePath)
+, m_query(HomerunInternal::TextFilter::foldedKey(query))
+, m_maxResults(maxResults)
+, m_cancelled(0)
+{
+}
+
+void DirSearchJob::start(const QSharedPointer<DirSearchJob> &job)
+{
+    QtConcurrent::run(&DirSearchJob::run, job);
+}
+
+void DirSearchJob::cancel()
+{
+    m_cancelled.fetchAndStoreOrdered(1);
+}
+
+DirSearchResultList DirSearchJob::takeResults()
+{
+    QMutexLocker locker(&m_mutex);
+    DirSearchResultList results = m_pendingResults;
+    m_pendingResults.clear();
+    return results;
+}
+
+// Runs in a worker thread
+void DirSearchJob::run(QSharedPointer<DirSearchJob> job)
+{
+    const QString prefix = job->m_basePath + '/';
+
+    // Look at shallow folders first, they are more likely to contain what the
+    // user is looking for
+    QStringList dirs;
+    for (auto it = job->m_data.constBegin(), end = job->m_data.constEnd(); it != end; ++it) {
+        // Direct children of the base folder are listed by DirModel
+        if (it.key().startsWith(prefix)) {
+            dirs << it.key();
+        }
+    }
+    qSort(dirs.begin(), dirs.end(), shallowerThan);
+
+    // Scores of the best results so far, to skip results which would not make
+    // it in the model anyway
+    QList<int> bestScores;
+    DirSearchResultList batch;
+    int scanned = 0;
+    Q_FOREACH(const QString &dir, dirs) {
+        if (job->m_cancelled != 0) {
+            break;
+        }
+        const QVector<DirIndexEntry> entries = job->m_data.value(dir);
+        Q_FOREACH(const DirIndexEntry &entry, entries) {
+            int score = HomerunInternal::TextFilter::match(HomerunInternal::TextFilter::FuzzyMode, entry.key, job->m_query);
+            if (score == -1) {
+                continue;
+            }
+            if (bestScores.count() >= job->m_maxResults) {
+                if (score <= bestScores.last()) {
+                    continue;
+                }
+                bestScores.removeLast();
+            }
+            bestScores.insert(qUpperBound(bestScores.begin(), bestScores.end(), score, qGreater<int>()) - bestScores.begin(), score);
+
+            DirSearchResult result;
+            result.path = dir + '/' + entry.name;
+            result.name = entry.name;
+            result.isDir = entry.isDir;
+            result.score = score;
+            batch << result;
+        }
+        scanned += entries.count();
+        if (scanned >= BATCH_SIZE) {
+            job->flush(&batch);
+            scanned = 0;
+        }
+    }
+    job->flush(&batch);
+    job->finished();
+}
+
+void DirSearchJob::flush(DirSearchResultList *batch)
+{
+    if (batch->isEmpty()) {
+        return;
+    }
+    qStableSort(batch->begin(), batch->end(), resultLessThan);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pendingResults << *batch;
+    }
+    batch->clear();
+    resultsAvailable();
+}
+
+//- DirSearchModel --------------------------------------------------
+DirSearchModel::DirSearchModel(const QSharedPointer<DirIndex> &index, const KUrl &rootUrl, const QString &rootName, const KUrl &url, QObject *parent)
+: QAbstractListModel(parent)
+, m_index(index)
+, m_rootUrl(rootUrl)
+, m_rootName(rootName)
+, m_basePath(QDir::cleanPath(url.toLocalFile()))
+, m_searchTimer(new QTimer(this))
+, m_refreshing(false)
+, m_running(false)
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(Qt::DisplayRole, "display");
+    roles.insert(Qt::DecorationRole, "decoration");
+    roles.insert(DirModel::FavoriteIdRole, "favoriteId");
+    roles.insert(DirModel::HasActionListRole, "hasActionList");
+    roles.insert(DirModel::ActionListRole, "actionList");
+    setRoleNames(roles);
+
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(SEARCH_DELAY);
+    connect(m_searchTimer, SIGNAL(timeout()), SLOT(refreshSearch()));
+
+    connect(m_index.data(), SIGNAL(updated()), SLOT(slotIndexUpdated()));
+}
+
+DirSearchModel::~DirSearchModel()
+{
+    cancelSearch();
+}
+
+int DirSearchModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_results.count();
+}
+
+QVariant DirSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (index.parent().isValid() || index.row() < 0 || index.row() >= m_results.count()) {
+        return QVariant();
+    }
+    const DirSearchResult &result = m_results.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return result.name;
+    case Qt::DecorationRole:
+        return result.isDir ? QString("folder") : KMimeType::iconNameForUrl(KUrl::fromPath(result.path));
+    case DirModel::FavoriteIdRole:
+        return result.isDir ? FavoriteUtils::favoriteIdFromUrl(KUrl::fromPath(result.path)) : QString();
+    case DirModel::HasActionListRole:
+        return true;
+    case DirModel::ActionListRole:
+        return QVariant::fromValue<QObject *>(ActionList::sharedModelForFileItem(KFileItem(KFileItem::Unknown, KFileItem::Unknown, KUrl::fromPath(result.path))));
+    }
+    return QVariant();
+}
+
+bool DirSearchModel::trigger(int row, const QString &actionId, const QVariant &actionArg)
+{
+    if (row < 0 || row >= m_results.count()) {
+        kWarning() << "Invalid row" << row;
+        return false;
+    }
+    const DirSearchResult &result = m_results.at(row);
+    KUrl url = KUrl::fromPath(result.path);
+    KFileItem item(KFileItem::Unknown, KFileItem::Unknown, url);
+
+    if (actionId.isEmpty()) {
+        if (result.isDir) {
+            openSourceRequested(SOURCE_ID, DirModel::sourceArguments(m_rootUrl, m_rootName, url, true));
+        } else {
+            item.run();
+        }
+    }
+
+    bool close;
+    ActionList::handleFileItemAction(item, actionId, actionArg, &close);
+
+    return false;
+}
+
+void DirSearchModel::prefetch(int row)
+{
+    if (row < 0 || row >= m_results.count()) {
+        return;
+    }
+    const DirSearchResult &result = m_results.at(row);
+    if (result.isDir) {
+        DirListingCache::instance()->prefetch(KUrl::fromPath(result.path));
+    }
+}
+
+int DirSearchModel::count() const
+{
+    return m_results.count();
+}
+
+QString DirSearchModel::name() const
+{
+    return i18nc("@title Title of the list of search results found in subfolders", "In Subfolders");
+}
+
+bool DirSearchModel::running() const
+{
+    return m_running;
+}
+
+QString DirSearchModel::query() const
+{
+    return m_query;
+}
+
+void DirSearchModel::setQuery(const QString &query)
+{
+    if (m_query == query) {
+        return;
+    }
+    m_query = query;
+    startSearch();
+}
+
+void DirSearchModel::startSearch()
+{
+    m_searchTimer->stop();
+    cancelSearch();
+    m_refreshing = false;
+
+    beginResetModel();
+    m_results.clear();
+    endResetModel();
+    countChanged();
+
+    startJob();
+}
+
+void DirSearchModel::refreshSearch()
+{
+    // The index changed: keep showing the current results until the new
+    // search is finished, so that they do not flicker
+    cancelSearch();
+    m_refreshing = true;
+    startJob();
+}
+
+void DirSearchModel::startJob()
+{
+    m_nextResults.clear();
+    if (!m_query.isEmpty()) {
+        m_job = QSharedPointer<DirSearchJob>(new DirSearchJob(m_index->data(), m_basePath, m_query, MAX_RESULTS), &QObject::deleteLater);
+        connect(m_job.data(), SIGNAL(resultsAvailable()), SLOT(fetchResults()));
+        connect(m_job.data(), SIGNAL(finished()), SLOT(slotJobFinished()));
+        DirSearchJob::start(m_job);
+    }
+    updateRunning();
+}
+
+void DirSearchModel::slotIndexUpdated()
+{
+    if (m_query.isEmpty()) {
+        return;
+    }
+    m_searchTimer->start();
+    updateRunning();
+}
+
+void DirSearchModel::cancelSearch()
+{
+    if (!m_job) {
+        return;
+    }
+    m_job->cancel();
+    disconnect(m_job.data(), 0, this, 0);
+    m_job.clear();
+}
+
+void DirSearchModel::fetchResults()
+{
+    if (sender() != m_job.data()) {
+        // Results of a cancelled search
+        return;
+    }
+    const DirSearchResultList results = m_job->takeResults();
+    if (results.isEmpty()) {
+        return;
+    }
+    if (m_refreshing) {
+        Q_FOREACH(const DirSearchResult &result, results) {
+            auto it = qUpperBound(m_nextResults.begin(), m_nextResults.end(), result, resultLessThan);
+            if (it - m_nextResults.begin() < MAX_RESULTS) {
+                m_nextResults.insert(it, result);
+            }
+        }
+        while (m_nextResults.count() > MAX_RESULTS) {
+            m_nextResults.removeLast();
+        }
+        return;
+    }
+    Q_FOREACH(const DirSearchResult &result, results) {
+        auto it = qUpperBound(m_results.begin(), m_results.end(), result, resultLessThan);
+        int row = it - m_results.begin();
+        if (row >= MAX_RESULTS) {
+            continue;
+        }
+        beginInsertRows(QModelIndex(), row, row);
+        m_results.insert(row, result);
+        endInsertRows();
+
+        if (m_results.count() > MAX_RESULTS) {
+            int last = m_results.count() - 1;
+            beginRemoveRows(QModelIndex(), last, last);
+            m_results.removeLast();
+            endRemoveRows();
+        }
+    }
+    countChanged();
+}
+
+void DirSearchModel::slotJobFinished()
+{
+    if (sender() != m_job.data()) {
+        return;
+    }
+    // Results may have been made available after the last fetchResults() call
+    fetchResults();
+    m_job.clear();
+    if (m_refreshing) {
+        m_refreshing = false;
+        if (!sameResults(m_results, m_nextResults)) {
+            beginResetModel();
+            m_results = m_nextResults;
+            endResetModel();
+            countChanged();
+        }
+        m_nextResults.clear();
+    }
+    updateRunning();
+}
+
+void DirSearchModel::updateRunning()
+{
+    // The search is restarted when the index is updated
+    bool running = !m_job.isNull()
+        || m_searchTimer->isActive()
+        || (!m_query.isEmpty() && !m_index->isReady());
+    if (m_running != running) {
+        m_running = running;
+        runningChanged(m_running);
+    }
+}
+
+//- RecursiveDirModel -----------------------------------------------
+RecursiveDirModel::RecursiveDirModel(DirModel *dirModel, DirSearchModel *searchModel, QObject *parent)
+: QAbstractListModel(parent)
+, m_dirModel(dirModel)
+, m_searchModel(searchModel)
+{
+    m_dirModel->setParent(this);
+    m_searchModel->setParent(this);
+
+    QHash<int, QByteArray> roles;
+    roles.insert(Qt::DisplayRole, "display");
+    setRoleNames(roles);
+
+    connect(m_dirModel, SIGNAL(runningChanged(bool)), SLOT(emitRunningChanged()));
+    connect(m_searchModel, SIGNAL(runningChanged(bool)), SLOT(emitRunningChanged()));
+    connect(m_dirModel, SIGNAL(openSourceRequested(QString,QVariantMap)), SIGNAL(openSourceRequested(QString,QVariantMap)));
+    connect(m_searchModel, SIGNAL(openSourceRequested(QString,QVariantMap)), SIGNAL(openSourceRequested(QString,QVariantMap)));
+}
+
+QObject *RecursiveDirModel::modelForRow(int row) const
+{
+    switch (row) {
+    case 0:
+        return m_dirModel;
+    case 1:
+        return m_searchModel;
+    }
+    kWarning() << "No model for row" << row << "!";
+    return 0;
+}
+
+int RecursiveDirModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant RecursiveDirModel::data(const QModelIndex &index, int role) const
+{
+    if (index.parent().isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (index.row()) {
+    case 0:
+        return m_dirModel->name();
+    case 1:
+        return m_searchModel->name();
+    }
+    return QVariant();
+}
+
+QString RecursiveDirModel::name() const
+{
+    return m_dirModel->name();
+}
+
+bool RecursiveDirModel::running() const
+{
+    return m_dirModel->running() || m_searchModel->running();
+}
+
+QObject *RecursiveDirModel::pathModel() const
+{
+    return m_dirModel->pathModel();
+}
+
+QString RecursiveDirModel::query() const
+{
+    return m_dirModel->query();
+}
+
+void RecursiveDirModel::setQuery(const QString &query)
+{
+    if (query == m_dirModel->query()) {
+        return;
+    }
+    m_dirModel->setQuery(query);
+    m_searchModel->setQuery(query);
+    queryChanged(query);
+}
+
+void RecursiveDirModel::emitRunningChanged()
+{
+    runningChanged(running());
+}
+
+} // namespace Homerun
+
+#include <dirsearchmodel.moc>
@@ -0,0 +1,205 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DIRSEARCHMODEL_H
+#define DIRSEARCHMODEL_H
+
+// Local
+#include <dirindex.h>
+
+// Qt
+#include <QAbstractListModel>
+#include <QMutex>
+
+// KDE
+#include <KUrl>
+
+class QTimer;
+
+namespace Homerun {
+
+class DirModel;
+
+struct DirSearchResult
+{
+    QString path;
+    QString name;
+    bool isDir;
+    int score;
+};
+
+typedef QList<DirSearchResult> DirSearchResultList;
+
+/**
+ * Internal. Searches a DirIndexData snapshot in a worker thread.
+ *
+ * Results are made available in batches, so that the best ones can be shown
+ * before the whole index has been searched.
+ */
+class DirSearchJob : public QObject
+{
+    Q_OBJECT
+public:
+    DirSearchJob(const DirIndexData &data, const QString &basePath, const QString &query, int maxResults);
+
+    /**
+     * Starts a search in a worker thread. The worker keeps a reference to the
+     * job, so it is safe to drop yours before the job is finished.
+     */
+    static void start(const QSharedPointer<DirSearchJob> &job);
+
+    void cancel();
+
+    /**
+     * Returns the results found since the last call, best ones first
+     */
+    DirSearchResultList takeResults();
+
+Q_SIGNALS:
+    void resultsAvailable();
+    void finished();
+
+private:
+    DirIndexData m_data;
+    QString m_basePath;
+    QString m_query;
+    int m_maxResults;
+    QAtomicInt m_cancelled;
+
+    QMutex m_mutex;
+    DirSearchResultList m_pendingResults;
+
+    static void run(QSharedPointer<DirSearchJob> job);
+    void flush(DirSearchResultList *batch);
+};
+
+/**
+ * Internal. Lists the entries of subfolders of a folder which match the query,
+ * using a DirIndex.
+ */
+class DirSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+public:
+    DirSearchModel(const QSharedPointer<DirIndex> &index, const KUrl &rootUrl, const QString &rootName, const KUrl &url, QObject *parent = 0);
+    ~DirSearchModel();
+
+    Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
+
+    /**
+     * @see DirModel::prefetch()
+     */
+    Q_INVOKABLE void prefetch(int row);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+    int count() const;
+
+    QString name() const;
+
+    bool running() const;
+
+    QString query() const;
+
+    void setQuery(const QString &query);
+
+Q_SIGNALS:
+    void countChanged();
+    void runningChanged(bool);
+    void openSourceRequested(const QString &sourceId, const QVariantMap &sourceArguments);
+
+private Q_SLOTS:
+    void startSearch();
+    void refreshSearch();
+    void slotIndexUpdated();
+    void fetchResults();
+    void slotJobFinished();
+
+private:
+    QSharedPointer<DirIndex> m_index;
+    KUrl m_rootUrl;
+    QString m_rootName;
+    QString m_basePath;
+    QString m_query;
+    QTimer *m_searchTimer;
+    QSharedPointer<DirSearchJob> m_job;
+    DirSearchResultList m_results;
+    /// Results of a refresh search, shown when it is finished
+    DirSearchResultList m_nextResults;
+    bool m_refreshing;
+    bool m_running;
+
+    void startJob();
+    void cancelSearch();
+    void updateRunning();
+};
+
+/**
+ * Internal. The model created by the Dir source when searching subfolders is
+ * enabled. It shows the current folder and the matching entries of its
+ * subfolders as two views.
+ */
+class RecursiveDirModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(QObject *pathModel READ pathModel CONSTANT)
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+public:
+    /**
+     * Takes ownership of both models
+     */
+    RecursiveDirModel(DirModel *dirModel, DirSearchModel *searchModel, QObject *parent = 0);
+
+    Q_INVOKABLE QObject *modelForRow(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+    QString name() const;
+
+    bool running() const;
+
+    QObject *pathModel() const;
+
+    QString query() const;
+
+    void setQuery(const QString &query);
+
+Q_SIGNALS:
+    void runningChanged(bool);
+    void openSourceRequested(const QString &sourceId, const QVariantMap &sourceArguments);
+    void queryChanged(const QString &);
+
+private Q_SLOTS:
+    void emitRunningChanged();
+
+private:
+    DirModel *m_dirModel;
+    DirSearchModel *m_searchModel;
+};
+
+} // namespace Homerun
+
+#endif /* DIRSEARCHMODEL_H */
@@ -0,0 +1,444 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <largedirmodel.h>
+
+// Local
+#include <dirlistingcache.h>
+#include <dirmodel.h>
+#include <favoriteutils.h>
+
+// libhomerun
+#include <actionlist.h>
+#include <actionlistmodel.h>
+#include <pathmodel.h>
+
+// KDE
+#include <KDebug>
+#include <KDirWatch>
+
+// Qt
+#include <QDir>
+#include <QDirIterator>
+#include <QSet>
+#include <QTimer>
+#include <QtConcurrentRun>
+
+// System
+#include <string.h>
+
+namespace Homerun
+{
+
+static const char *SOURCE_ID = "Dir";
+
+// Folders with at least this number of entries are shown with a LargeDirModel
+static int s_largeDirThreshold = 10000;
+
+// Local folders known to be large
+static QSet<QString> *largeDirs()
+{
+    static QSet<QString> dirs;
+    return &dirs;
+}
+
+static const int MAX_CACHED_ITEMS = 256;
+
+// Group bursts of changes, for example when files are being copied
+static const int RELIST_DELAY = 1000;
+
+static const QDir::Filters LIST_FILTERS = QDir::AllEntries | QDir::NoDotAndDotDot | QDir::System;
+
+/**
+ * Turns a file name into a key which can be compared bytewise: case is folded,
+ * digit runs are prefixed with their length so that "img2" comes before
+ * "img10". The length is itself prefixed with its number of digits, so that
+ * runs of 100 digits or more still sort after shorter ones. The result goes
+ * through strxfrm() so that the order follows the collation rules of the
+ * locale, like QString::localeAwareCompare().
+ */
+static QByteArray collationKey(const QString &name)
+{
+    const QString folded = name.toCaseFolded();
+    QString normalized;
+    normalized.reserve(folded.length() + 8);
+    const int length = folded.length();
+    for (int pos = 0; pos < length;) {
+        if (!folded.at(pos).isDigit()) {
+            normalized += folded.at(pos);
+            ++pos;
+            continue;
+        }
+        int start = pos;
+        while (pos < length && folded.at(pos).isDigit()) {
+            ++pos;
+        }
+        while (start < pos - 1 && folded.at(start) == '0') {
+            ++start;
+        }
+        const QString runLength = QString::number(pos - start);
+        normalized += QString::number(runLength.length());
+        normalized += runLength;
+        normalized.append(folded.midRef(start, pos - start));
+    }
+
+    const QByteArray local = normalized.toLocal8Bit();
+    const size_t size = strxfrm(0, local.constData(), 0);
+    QByteArray key(size + 1, '\0');
+    strxfrm(key.data(), local.constData(), size + 1);
+    key.resize(size);
+    return key;
+}
+
+struct SortItem
+{
+    // The first bytes of the key, so that most comparisons are done on
+    // integers
+    quint64 prefix;
+    QByteArray key;
+    int index;
+    bool isDir;
+};
+
+static bool sortItemLessThan(const SortItem &item1, const SortItem &item2)
+{
+    // Folders first
+    if (item1.isDir != item2.isDir) {
+        return item1.isDir;
+    }
+    if (item1.prefix != item2.prefix) {
+        return item1.prefix < item2.prefix;
+    }
+    return item1.key < item2.key;
+}
+
+// Runs in a worker thread
+static QVector<LargeDirEntry> listDir(const QString &path)
+{
+    QVector<LargeDirEntry> entries;
+    QDirIterator it(path, LIST_FILTERS);
+    while (it.hasNext()) {
+        it.next();
+        LargeDirEntry entry;
+        entry.name = it.fileName();
+        entry.isDir = it.fileInfo().isDir();
+        entries << entry;
+    }
+
+    QVector<SortItem> items(entries.count());
+    for (int idx = 0; idx < entries.count(); ++idx) {
+        SortItem &item = items[idx];
+        item.key = collationKey(entries.at(idx).name);
+        item.prefix = 0;
+        const int prefixLength = qMin(item.key.size(), int(sizeof(quint64)));
+        for (int pos = 0; pos < int(sizeof(quint64)); ++pos) {
+            item.prefix <<= 8;
+            if (pos < prefixLength) {
+                item.prefix |= uchar(item.key.at(pos));
+            }
+        }
+        item.index = idx;
+        item.isDir = entries.at(idx).isDir;
+    }
+    qSort(items.begin(), items.end(), sortItemLessThan);
+
+    QVector<LargeDirEntry> sortedEntries;
+    sortedEntries.reserve(entries.count());
+    Q_FOREACH(const SortItem &item, items) {
+        sortedEntries << entries.at(item.index);
+    }
+    return sortedEntries;
+}
+
+struct RowRelevanceLessThan
+{
+    RowRelevanceLessThan(const QVector<LargeDirEntry> &entries, const HomerunInternal::TextFilter &filter)
+    : m_entries(entries)
+    , m_filter(filter)
+    {}
+
+    bool operator()(int idx1, int idx2) const
+    {
+        const bool isDir1 = m_entries.at(idx1).isDir;
+        if (isDir1 != m_entries.at(idx2).isDir) {
+            return isDir1;
+        }
+        return m_filter.score(idx1) > m_filter.score(idx2);
+    }
+
+    const QVector<LargeDirEntry> &m_entries;
+    const HomerunInternal::TextFilter &m_filter;
+};
+
+LargeDirModel::LargeDirModel(QObject *parent)
+: QAbstractListModel(parent)
+, m_pathModel(new PathModel(this))
+, m_relistTimer(new QTimer(this))
+, m_listingWatcher(new QFutureWatcher<QVector<LargeDirEntry> >(this))
+, m_filter(HomerunInternal::TextFilter::FuzzyMode)
+, m_itemCache(MAX_CACHED_ITEMS)
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(Qt::DisplayRole, "display");
+    roles.insert(Qt::DecorationRole, "decoration");
+    roles.insert(DirModel::FavoriteIdRole, "favoriteId");
+    roles.insert(DirModel::HasActionListRole, "hasActionList");
+    roles.insert(DirModel::ActionListRole, "actionList");
+    setRoleNames(roles);
+
+    m_relistTimer->setSingleShot(true);
+    m_relistTimer->setInterval(RELIST_DELAY);
+    connect(m_relistTimer, SIGNAL(timeout()), SLOT(startListing()));
+
+    connect(m_listingWatcher, SIGNAL(finished()), SLOT(slotListingFinished()));
+}
+
+LargeDirModel::~LargeDirModel()
+{
+    if (!m_path.isEmpty()) {
+        KDirWatch::self()->removeDir(m_path);
+    }
+}
+
+bool LargeDirModel::isLargeDir(const QString &path)
+{
+    return largeDirs()->contains(QDir::cleanPath(path));
+}
+
+void LargeDirModel::recordEntryCount(const QString &path, int count)
+{
+    if (count >= s_largeDirThreshold) {
+        largeDirs()->insert(QDir::cleanPath(path));
+    } else {
+        largeDirs()->remove(QDir::cleanPath(path));
+    }
+}
+
+// Runs in a worker thread
+int LargeDirModel::countEntries(const QString &path)
+{
+    const int threshold = s_largeDirThreshold;
+    QDirIterator it(path, LIST_FILTERS);
+    int count = 0;
+    for (; count < threshold && it.hasNext(); ++count) {
+        it.next();
+    }
+    return count;
+}
+
+void LargeDirModel::setLargeDirThreshold(int threshold)
+{
+    s_largeDirThreshold = threshold;
+}
+
+void LargeDirModel::init(const KUrl &rootUrl, const QString &rootName, const KUrl &url)
+{
+    m_rootUrl = rootUrl;
+    m_rootName = rootName;
+    m_url = url;
+    m_path = url.toLocalFile();
+    DirModel::fillPathModel(m_pathModel, rootUrl, rootName, url);
+
+    KDirWatch::self()->addDir(m_path);
+    connect(KDirWatch::self(), SIGNAL(dirty(QString)), SLOT(slotDirty(QString)));
+    startListing();
+}
+
+void LargeDirModel::startListing()
+{
+    if (m_listingWatcher->isRunning()) {
+        // Try again later
+        m_relistTimer->start();
+        return;
+    }
+    m_listingWatcher->setFuture(QtConcurrent::run(listDir, m_path));
+    runningChanged(true);
+}
+
+void LargeDirModel::slotDirty(const QString &path)
+{
+    if (path == m_path) {
+        m_relistTimer->start();
+    }
+}
+
+void LargeDirModel::slotListingFinished()
+{
+    beginResetModel();
+    m_entries = m_listingWatcher->result();
+    // The folder may have shrunk, in which case it will be shown with a
+    // DirModel next time
+    recordEntryCount(m_path, m_entries.count());
+    m_itemCache.clear();
+    QStringList names;
+    Q_FOREACH(const LargeDirEntry &entry, m_entries) {
+        names << entry.name;
+    }
+    m_filter.setTexts(names);
+    updateRows();
+    endResetModel();
+    countChanged();
+    runningChanged(false);
+}
+
+void LargeDirModel::updateRows()
+{
+    m_rows.clear();
+    for (int idx = 0; idx < m_entries.count(); ++idx) {
+        if (m_filter.isAccepted(idx)) {
+            m_rows << idx;
+        }
+    }
+    if (!m_filter.query().isEmpty()) {
+        // Keep folders first, then sort by relevance
+        qStableSort(m_rows.begin(), m_rows.end(), RowRelevanceLessThan(m_entries, m_filter));
+    }
+}
+
+const LargeDirEntry *LargeDirModel::entryForRow(int row) const
+{
+    if (row < 0 || row >= m_rows.count()) {
+        return 0;
+    }
+    return &m_entries.at(m_rows.at(row));
+}
+
+KFileItem LargeDirModel::itemForRow(int row) const
+{
+    const LargeDirEntry *entry = entryForRow(row);
+    if (!entry) {
+        return KFileItem();
+    }
+    const int idx = m_rows.at(row);
+    KFileItem *item = m_itemCache.object(idx);
+    if (!item) {
+        KUrl url = m_url;
+        url.addPath(entry->name);
+        item = new KFileItem(KFileItem::Unknown, KFileItem::Unknown, url, true /* delayedMimeTypes */);
+        m_itemCache.insert(idx, item);
+    }
+    return *item;
+}
+
+int LargeDirModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_rows.count();
+}
+
+QVariant LargeDirModel::data(const QModelIndex &index, int role) const
+{
+    const LargeDirEntry *entry = entryForRow(index.row());
+    if (!entry || index.parent().isValid()) {
+        return QVariant();
+    }
+    switch (role) {
+    case Qt::DisplayRole:
+        return entry->name;
+    case Qt::DecorationRole:
+        return entry->isDir ? QString("folder") : itemForRow(index.row()).iconName();
+    case DirModel::FavoriteIdRole:
+        if (entry->isDir) {
+            KUrl url = m_url;
+            url.addPath(entry->name);
+            return FavoriteUtils::favoriteIdFromUrl(url);
+        } else {
+            return QString();
+        }
+    case DirModel::HasActionListRole:
+        return true;
+    case DirModel::ActionListRole:
+        return QVariant::fromValue<QObject *>(ActionList::sharedModelForFileItem(itemForRow(index.row())));
+    }
+    return QVariant();
+}
+
+bool LargeDirModel::trigger(int row, const QString &actionId, const QVariant &actionArg)
+{
+    KFileItem item = itemForRow(row);
+    if (item.isNull()) {
+        kWarning() << "Invalid row" << row;
+        return false;
+    }
+
+    if (actionId.isEmpty()) {
+        if (entryForRow(row)->isDir) {
+            openSourceRequested(SOURCE_ID, DirModel::sourceArguments(m_rootUrl, m_rootName, item.url()));
+        } else {
+            item.run();
+        }
+    }
+
+    bool close;
+    ActionList::handleFileItemAction(item, actionId, actionArg, &close);
+
+    return false;
+}
+
+void LargeDirModel::prefetch(int row)
+{
+    const LargeDirEntry *entry = entryForRow(row);
+    if (entry && entry->isDir) {
+        DirListingCache::instance()->prefetch(itemForRow(row).url());
+    }
+}
+
+PathModel *LargeDirModel::pathModel() const
+{
+    return m_pathModel;
+}
+
+int LargeDirModel::count() const
+{
+    return m_rows.count();
+}
+
+QString LargeDirModel::name() const
+{
+    return m_rootName;
+}
+
+bool LargeDirModel::running() const
+{
+    return m_listingWatcher->isRunning();
+}
+
+QString LargeDirModel::query() const
+{
+    return m_filter.query();
+}
+
+void LargeDirModel::setQuery(const QString &query)
+{
+    if (!m_filter.setQuery(query)) {
+        return;
+    }
+    beginResetModel();
+    updateRows();
+    endResetModel();
+    countChanged();
+    queryChanged(query);
+}
+
+} // namespace Homerun
+
+#include <largedirmodel.moc>
@@ -0,0 +1,156 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LARGEDIRMODEL_H
+#define LARGEDIRMODEL_H
+
+// Local
+#include <textfilter.h>
+
+// Qt
+#include <QAbstractListModel>
+#include <QCache>
+#include <QFutureWatcher>
+#include <QVector>
+
+// KDE
+#include <KFileItem>
+#include <KUrl>
+
+class QTimer;
+
+namespace Homerun {
+
+class PathModel;
+
+struct LargeDirEntry
+{
+    QString name;
+    bool isDir;
+};
+
+/**
+ * Internal. A model for local folders containing too many entries for
+ * DirModel.
+ *
+ * Instead of keeping a KFileItem per entry, it keeps a compact record per
+ * entry, listed and sorted in a worker thread using precomputed collation
+ * keys. KFileItems are only created for the rows the view asks data for,
+ * which are the ones near the viewport, and are kept in a bounded cache.
+ *
+ * It provides the same roles and properties as DirModel.
+ */
+class LargeDirModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QString name READ name CONSTANT)
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    Q_PROPERTY(QObject *pathModel READ pathModel CONSTANT)
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+public:
+    explicit LargeDirModel(QObject *parent = 0);
+    ~LargeDirModel();
+
+    void init(const KUrl &rootUrl, const QString &rootName, const KUrl &url);
+
+    /**
+     * Returns true if the local folder @p path is known to contain enough
+     * entries to be shown with a LargeDirModel instead of a DirModel.
+     *
+     * This does not read the folder: the answer comes from the entry counts
+     * recorded with recordEntryCount() by DirModel, DirListingCache and
+     * LargeDirModel when they list folders.
+     */
+    static bool isLargeDir(const QString &path);
+
+    /**
+     * Records the number of entries of the local folder @p path, as found
+     * when listing it
+     */
+    static void recordEntryCount(const QString &path, int count);
+
+    /**
+     * Counts the entries of the local folder @p path, stopping at the large
+     * folder threshold. Reads the folder: call it from a worker thread.
+     */
+    static int countEntries(const QString &path);
+
+    /**
+     * Overrides the number of entries from which a folder is large. Used by
+     * tests.
+     */
+    static void setLargeDirThreshold(int threshold);
+
+    Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
+
+    Q_INVOKABLE void prefetch(int row);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+    PathModel *pathModel() const;
+
+    int count() const;
+
+    QString name() const;
+
+    bool running() const;
+
+    QString query() const;
+
+    void setQuery(const QString &query);
+
+Q_SIGNALS:
+    void countChanged();
+    void runningChanged(bool);
+    void openSourceRequested(const QString &sourceId, const QVariantMap &sourceArguments);
+    void queryChanged(const QString &);
+
+private Q_SLOTS:
+    void startListing();
+    void slotDirty(const QString &path);
+    void slotListingFinished();
+
+private:
+    PathModel *m_pathModel;
+    KUrl m_rootUrl;
+    QString m_rootName;
+    KUrl m_url;
+    QString m_path;
+    QTimer *m_relistTimer;
+    QFutureWatcher<QVector<LargeDirEntry> > *m_listingWatcher;
+
+    // All entries, sorted
+    QVector<LargeDirEntry> m_entries;
+    // Indexes in m_entries of the rows matching the query
+    QVector<int> m_rows;
+    HomerunInternal::TextFilter m_filter;
+
+    mutable QCache<int, KFileItem> m_itemCache;
+
+    const LargeDirEntry *entryForRow(int row) const;
+    KFileItem itemForRow(int row) const;
+    void updateRows();
+};
+
+} // namespace Homerun
+
+#endif /* LARGEDIRMODEL_H */
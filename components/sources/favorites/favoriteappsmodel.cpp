@@ -22,6 +22,9 @@
 // Own
 #include "favoriteappsmodel.h"
 
+// Local
+#include "favoritesindex.h"
+
 // Qt
 #include <QDomDocument>
 #include <QFile>
@@ -58,6 +61,7 @@ static QString serviceIdFromFavoriteId(const QString &favoriteId)
 
 FavoriteAppsModel::FavoriteAppsModel(QObject *parent)
 : QAbstractListModel(parent)
+, m_favoritesIndex(0)
 {
     QHash<int, QByteArray> roles;
     roles.insert(Qt::DisplayRole, "display");
@@ -208,8 +212,16 @@ bool FavoriteAppsModel::isFavorite(const QString &favoriteId) const
     return rowForFavoriteId(favoriteId) != -1;
 }
 
+void FavoriteAppsModel::setFavoritesIndex(FavoritesIndex *index)
+{
+    m_favoritesIndex = index;
+}
+
 int FavoriteAppsModel::rowForFavoriteId(const QString& favoriteId) const
 {
+    if (m_favoritesIndex) {
+        return m_favoritesIndex->rowForFavoriteId(favoriteId);
+    }
     QString serviceId = serviceIdFromFavoriteId(favoriteId);
     if (serviceId.isEmpty()) {
         return -1;
@@ -31,6 +31,8 @@ class QDomDocument;
 
 namespace Homerun {
 
+class FavoritesIndex;
+
 struct FavoriteInfo
 {
     KService::Ptr service;
@@ -65,6 +67,12 @@ public:
     Q_INVOKABLE void addFavorite(const QString &favoriteId);
     Q_INVOKABLE void removeFavorite(const QString &favoriteId);
 
+    /**
+     * Makes favorite lookups go through @p index, which must index this
+     * model, instead of scanning the rows
+     */
+    void setFavoritesIndex(FavoritesIndex *index);
+
     Q_INVOKABLE bool trigger(int row);
 
     Q_INVOKABLE void moveRow(int from, int to);
@@ -76,6 +84,7 @@ Q_SIGNALS:
 private:
     KSharedConfig::Ptr m_config;
     QList<FavoriteInfo> m_favoriteList;
+    FavoritesIndex *m_favoritesIndex;
 
     int rowForFavoriteId(const QString &favoriteId) const;
 
@@ -21,10 +21,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <dirmodel.h>
+#include <favoritesindex.h>
 #include <favoriteutils.h>
 
 // libhomerun
 #include <actionlist.h>
+#include <actionlistmodel.h>
 
 // KDE
 #include <KDebug>
@@ -38,6 +40,7 @@ namespace Homerun {
 //- FavoritePlacesModel ------------------------------------------------
 FavoritePlacesModel::FavoritePlacesModel(QObject *parent)
 : Fixes::KFilePlacesModel(parent)
+, m_favoritesIndex(0)
 {
     QHash<int, QByteArray> roles;
     roles.insert(Qt::DisplayRole, "display");
@@ -77,8 +80,17 @@ void FavoritePlacesModel::removeFavorite(const QString &favoriteId)
     removePlace(index);
 }
 
+void FavoritePlacesModel::setFavoritesIndex(FavoritesIndex *index)
+{
+    m_favoritesIndex = index;
+}
+
 QModelIndex FavoritePlacesModel::indexForFavoriteId(const QString &favoriteId) const
 {
+    if (m_favoritesIndex) {
+        const int row = m_favoritesIndex->rowForFavoriteId(favoriteId);
+        return row == -1 ? QModelIndex() : index(row, 0);
+    }
     KUrl favoriteUrl = FavoriteUtils::urlFromFavoriteId(favoriteId);
     if (favoriteUrl.isEmpty()) {
         return QModelIndex();
@@ -109,7 +121,7 @@ QVariant FavoritePlacesModel::data(const QModelIndex &index, int role) const
     }
     if (role == ActionListRole) {
         KFileItem item(KFileItem::Unknown, KFileItem::Unknown, url(index));
-        return ActionList::createListForFileItem(item);
+        return QVariant::fromValue<QObject *>(ActionList::sharedModelForFileItem(item));
     }
     return QVariant();
 }
@@ -29,6 +29,8 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace Homerun {
 
+class FavoritesIndex;
+
 /**
  * Adapts KFilePlacesModel to make it usable as a Homerun favorite model
  */
@@ -52,6 +54,13 @@ public:
     Q_INVOKABLE bool isFavorite(const QString &favoriteId) const;
     Q_INVOKABLE void addFavorite(const QString &favoriteId);
     Q_INVOKABLE void removeFavorite(const QString &favoriteId);
+
+    /**
+     * Makes favorite lookups go through @p index, which must index this
+     * model, instead of scanning the rows
+     */
+    void setFavoritesIndex(FavoritesIndex *index);
+
     Q_INVOKABLE bool trigger(int row, const QString &actionId, const QVariant &actionArg);
     Q_INVOKABLE void moveRow(int from, int to);
 
@@ -70,6 +79,8 @@ Q_SIGNALS:
     void countChanged();
 
 private:
+    FavoritesIndex *m_favoritesIndex;
+
     QModelIndex indexForFavoriteId(const QString &favoriteId) const;
 };
 
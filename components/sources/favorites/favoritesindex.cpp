@@ -0,0 +1,152 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <favoritesindex.h>
+
+// Local
+#include <favoriteutils.h>
+
+// KDE
+#include <KDebug>
+#include <KUrl>
+
+// Qt
+#include <QAbstractItemModel>
+
+namespace Homerun {
+
+FavoritesIndex::FavoritesIndex(QObject *parent)
+: QObject(parent)
+{
+}
+
+void FavoritesIndex::addModel(QAbstractItemModel *model)
+{
+    const QString prefix = model->property("favoritePrefix").toString();
+    if (prefix.isEmpty()) {
+        kWarning() << "Model has no favoritePrefix property" << model;
+        return;
+    }
+    const int role = model->roleNames().key("favoriteId", -1);
+    if (role == -1) {
+        kWarning() << "Model has no favoriteId role" << model;
+        return;
+    }
+    if (m_infoForPrefix.contains(prefix)) {
+        kWarning() << "There is already a favorite model for prefix" << prefix;
+        return;
+    }
+    ModelInfo info;
+    info.model = model;
+    info.role = role;
+    m_infoForPrefix.insert(prefix, info);
+
+    // Favorite models are short: rebuilding the index of the model which
+    // changed is cheap
+    connect(model, SIGNAL(rowsInserted(QModelIndex, int, int)), SLOT(reindexSender()));
+    connect(model, SIGNAL(rowsRemoved(QModelIndex, int, int)), SLOT(reindexSender()));
+    connect(model, SIGNAL(rowsMoved(QModelIndex, int, int, QModelIndex, int)), SLOT(reindexSender()));
+    connect(model, SIGNAL(dataChanged(QModelIndex, QModelIndex)), SLOT(reindexSender()));
+    connect(model, SIGNAL(layoutChanged()), SLOT(reindexSender()));
+    connect(model, SIGNAL(modelReset()), SLOT(reindexSender()));
+    connect(model, SIGNAL(destroyed(QObject *)), SLOT(slotModelDestroyed(QObject *)));
+
+    reindex(prefix);
+}
+
+bool FavoritesIndex::isFavorite(const QString &favoriteId) const
+{
+    return rowForFavoriteId(favoriteId) != -1;
+}
+
+int FavoritesIndex::rowForFavoriteId(const QString &favoriteId) const
+{
+    const ModelInfo *info = infoForFavoriteId(favoriteId);
+    if (!info) {
+        return -1;
+    }
+    return info->rowForId.value(normalizedFavoriteId(favoriteId), -1);
+}
+
+QObject *FavoritesIndex::modelForFavoriteId(const QString &favoriteId) const
+{
+    const ModelInfo *info = infoForFavoriteId(favoriteId);
+    return info ? info->model : 0;
+}
+
+QString FavoritesIndex::normalizedFavoriteId(const QString &favoriteId)
+{
+    if (!favoriteId.startsWith("place:")) {
+        return favoriteId;
+    }
+    KUrl url = FavoriteUtils::urlFromFavoriteId(favoriteId);
+    return "place:" + url.url(KUrl::RemoveTrailingSlash);
+}
+
+const FavoritesIndex::ModelInfo *FavoritesIndex::infoForFavoriteId(const QString &favoriteId) const
+{
+    const int colon = favoriteId.indexOf(':');
+    if (colon == -1) {
+        return 0;
+    }
+    auto it = m_infoForPrefix.constFind(favoriteId.left(colon));
+    return it == m_infoForPrefix.constEnd() ? 0 : &it.value();
+}
+
+void FavoritesIndex::reindexSender()
+{
+    reindex(sender()->property("favoritePrefix").toString());
+}
+
+void FavoritesIndex::slotModelDestroyed(QObject *model)
+{
+    auto it = m_infoForPrefix.begin();
+    while (it != m_infoForPrefix.end()) {
+        if (it->model == model) {
+            it = m_infoForPrefix.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FavoritesIndex::reindex(const QString &prefix)
+{
+    auto it = m_infoForPrefix.find(prefix);
+    if (it == m_infoForPrefix.end()) {
+        return;
+    }
+    QAbstractItemModel *model = it->model;
+
+    QHash<QString, int> rowForId;
+    // Go backward so that the first row wins if a favorite is listed twice
+    for (int row = model->rowCount() - 1; row >= 0; --row) {
+        const QString id = model->index(row, 0).data(it->role).toString();
+        if (!id.isEmpty()) {
+            rowForId.insert(normalizedFavoriteId(id), row);
+        }
+    }
+
+    it->rowForId = rowForId;
+}
+
+} // namespace Homerun
+
+#include "favoritesindex.moc"
@@ -0,0 +1,91 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef FAVORITESINDEX_H
+#define FAVORITESINDEX_H
+
+// Local
+
+// Qt
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+// KDE
+
+class QAbstractItemModel;
+
+namespace Homerun {
+
+/**
+ * Maps favorite ids to rows of the favorite models, so that checking whether
+ * an item is a favorite does not require scanning the models.
+ *
+ * The index follows changes of the models it watches. Favorite models given
+ * the index with setFavoritesIndex() use it for their own lookups too.
+ */
+class FavoritesIndex : public QObject
+{
+    Q_OBJECT
+public:
+    FavoritesIndex(QObject *parent = 0);
+
+    /**
+     * Starts indexing @p model. The model must have a "favoritePrefix"
+     * property and a "favoriteId" role.
+     */
+    void addModel(QAbstractItemModel *model);
+
+    Q_INVOKABLE bool isFavorite(const QString &favoriteId) const;
+
+    /**
+     * Returns the row of @p favoriteId in its favorite model, -1 if it is not
+     * a favorite
+     */
+    Q_INVOKABLE int rowForFavoriteId(const QString &favoriteId) const;
+
+    Q_INVOKABLE QObject *modelForFavoriteId(const QString &favoriteId) const;
+
+    /**
+     * Returns the form of @p favoriteId used as a key in the index: place ids
+     * pointing to the same url with and without a trailing slash are the same
+     * favorite
+     */
+    static QString normalizedFavoriteId(const QString &favoriteId);
+
+private Q_SLOTS:
+    void reindexSender();
+    void slotModelDestroyed(QObject *model);
+
+private:
+    struct ModelInfo {
+        QAbstractItemModel *model;
+        int role;
+        // Normalized favorite id => row
+        QHash<QString, int> rowForId;
+    };
+    QHash<QString, ModelInfo> m_infoForPrefix;
+
+    const ModelInfo *infoForFavoriteId(const QString &favoriteId) const;
+    void reindex(const QString &prefix);
+};
+
+} // namespace Homerun
+
+#endif /* FAVORITESINDEX_H */
@@ -27,9 +27,12 @@
 #include <QtCore/QDir>
 #endif
 
+#include <QtCore/QHash>
 #include <QtCore/QMimeData>
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
 #include <QtCore/QFile>
+#include <QtCore/QVector>
 #include <QtGui/QColor>
 #include <QtGui/QAction>
 
@@ -84,7 +87,7 @@ public:
     KFilePlacesSharedBookmarks * sharedBookmarks;
 
     void reloadAndSignal();
-    QList<KFilePlacesItem *> loadBookmarkList();
+    QList<KFilePlacesItem *> loadBookmarkList(QSet<KFilePlacesItem *> *changedItems);
 
     void _k_initDeviceList();
     void _k_deviceAdded(const QString &udi);
@@ -362,82 +365,154 @@ void KFilePlacesModel::Private::_k_itemChanged(const QString &id)
     }
 }
 
-void KFilePlacesModel::Private::_k_reloadBookmarks()
+// Returns the indexes of a longest increasing subsequence of 'values'
+static QList<int> longestIncreasingSubsequence(const QList<int> &values)
 {
-    QList<KFilePlacesItem*> currentItems = loadBookmarkList();
-
-    QList<KFilePlacesItem*>::Iterator it_i = items.begin();
-    QList<KFilePlacesItem*>::Iterator it_c = currentItems.begin();
-
-    QList<KFilePlacesItem*>::Iterator end_i = items.end();
-    QList<KFilePlacesItem*>::Iterator end_c = currentItems.end();
-
-    while (it_i!=end_i || it_c!=end_c) {
-        if (it_i==end_i && it_c!=end_c) {
-            int row = items.count();
+    // tails[k] is the index in 'values' of the smallest tail of all
+    // increasing subsequences of length k + 1
+    QVector<int> tails;
+    QVector<int> previous(values.count(), -1);
+    for (int idx = 0; idx < values.count(); ++idx) {
+        int lo = 0, hi = tails.count();
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (values.at(tails.at(mid)) < values.at(idx)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo > 0) {
+            previous[idx] = tails.at(lo - 1);
+        }
+        if (lo == tails.count()) {
+            tails.append(idx);
+        } else {
+            tails[lo] = idx;
+        }
+    }
+    QList<int> result;
+    for (int idx = tails.isEmpty() ? -1 : tails.last(); idx != -1; idx = previous.at(idx)) {
+        result.prepend(idx);
+    }
+    return result;
+}
 
-            q->beginInsertRows(QModelIndex(), row, row);
-            it_i = items.insert(it_i, *it_c);
-            ++it_i;
-            it_c = currentItems.erase(it_c);
+// Returns true if the two bookmarks would be presented the same way
+static bool sameBookmarkContent(const KBookmark &b1, const KBookmark &b2)
+{
+    return b1.text() == b2.text()
+        && b1.url() == b2.url()
+        && b1.icon() == b2.icon()
+        && b1.metaDataItem("IsHidden") == b2.metaDataItem("IsHidden")
+        && b1.metaDataItem("OnlyInApp") == b2.metaDataItem("OnlyInApp");
+}
 
-            end_i = items.end();
-            end_c = currentItems.end();
-            q->endInsertRows();
+void KFilePlacesModel::Private::_k_reloadBookmarks()
+{
+    // Items are matched by id: existing items are kept (and only get their
+    // bookmark updated), unknown ids get new items.
+    QSet<KFilePlacesItem*> changedItems;
+    QList<KFilePlacesItem*> currentItems = loadBookmarkList(&changedItems);
 
-        } else if (it_i!=end_i && it_c==end_c) {
-            int row = items.indexOf(*it_i);
+    QSet<KFilePlacesItem*> keptItems;
+    foreach (KFilePlacesItem *item, currentItems) {
+        keptItems << item;
+    }
 
-            q->beginRemoveRows(QModelIndex(), row, row);
-            delete *it_i;
-            it_i = items.erase(it_i);
+    // Remove items which are gone, grouping adjacent rows
+    for (int last = items.count() - 1; last >= 0; --last) {
+        if (keptItems.contains(items.at(last))) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !keptItems.contains(items.at(first - 1))) {
+            --first;
+        }
+        q->beginRemoveRows(QModelIndex(), first, last);
+        for (int row = last; row >= first; --row) {
+            delete items.takeAt(row);
+        }
+        q->endRemoveRows();
+        last = first;
+    }
 
-            end_i = items.end();
-            end_c = currentItems.end();
-            q->endRemoveRows();
+    // Move kept items to their new position. Items which are part of a
+    // longest subsequence whose order did not change stay where they are,
+    // the others are moved right after their new predecessor. This emits as
+    // few rowsMoved() as possible.
+    QHash<KFilePlacesItem*, int> oldRows;
+    for (int row = 0; row < items.count(); ++row) {
+        oldRows.insert(items.at(row), row);
+    }
+    QList<KFilePlacesItem*> keptOrder;
+    QList<int> oldRowsInNewOrder;
+    foreach (KFilePlacesItem *item, currentItems) {
+        QHash<KFilePlacesItem*, int>::ConstIterator it = oldRows.constFind(item);
+        if (it != oldRows.constEnd()) {
+            keptOrder << item;
+            oldRowsInNewOrder << it.value();
+        }
+    }
+    QSet<KFilePlacesItem*> stableItems;
+    foreach (int idx, longestIncreasingSubsequence(oldRowsInNewOrder)) {
+        stableItems << keptOrder.at(idx);
+    }
+    for (int idx = 0; idx < keptOrder.count(); ++idx) {
+        KFilePlacesItem *item = keptOrder.at(idx);
+        if (stableItems.contains(item)) {
+            continue;
+        }
+        int from = items.indexOf(item);
+        int destRow = idx == 0 ? 0 : items.indexOf(keptOrder.at(idx - 1)) + 1;
+        if (destRow == from || destRow == from + 1) {
+            continue;
+        }
+        q->beginMoveRows(QModelIndex(), from, from, QModelIndex(), destRow);
+        items.move(from, from < destRow ? (destRow - 1) : destRow);
+        q->endMoveRows();
+    }
 
-        } else if ((*it_i)->id()==(*it_c)->id()) {
-            bool shouldEmit = !((*it_i)->bookmark()==(*it_c)->bookmark());
-            (*it_i)->setBookmark((*it_c)->bookmark());
-            if (shouldEmit) {
-                int row = items.indexOf(*it_i);
-                QModelIndex idx = q->index(row, 0);
-                emit q->dataChanged(idx, idx);
-            }
-            ++it_i;
-            ++it_c;
-        } else if ((*it_i)->id()!=(*it_c)->id()) {
-            int row = items.indexOf(*it_i);
-
-            if (it_i+1!=end_i && (*(it_i+1))->id()==(*it_c)->id()) { // if the next one matches, it's a remove
-                q->beginRemoveRows(QModelIndex(), row, row);
-                delete *it_i;
-                it_i = items.erase(it_i);
-
-                end_i = items.end();
-                end_c = currentItems.end();
-                q->endRemoveRows();
-            } else {
-                q->beginInsertRows(QModelIndex(), row, row);
-                it_i = items.insert(it_i, *it_c);
-                ++it_i;
-                it_c = currentItems.erase(it_c);
-
-                end_i = items.end();
-                end_c = currentItems.end();
-                q->endInsertRows();
-            }
+    // Insert new items, grouping adjacent rows
+    for (int first = 0; first < currentItems.count(); ++first) {
+        if (first < items.count() && items.at(first) == currentItems.at(first)) {
+            continue;
+        }
+        int last = first;
+        while (last + 1 < currentItems.count() && !oldRows.contains(currentItems.at(last + 1))) {
+            ++last;
         }
+        q->beginInsertRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row) {
+            items.insert(row, currentItems.at(row));
+        }
+        q->endInsertRows();
+        first = last;
     }
+    Q_ASSERT(items == currentItems);
 
-    qDeleteAll(currentItems);
-    currentItems.clear();
+    foreach (KFilePlacesItem *item, changedItems) {
+        QModelIndex idx = q->index(items.indexOf(item), 0);
+        emit q->dataChanged(idx, idx);
+    }
+}
+
+static QString bookmarkId(const KBookmark &bookmark, const QString &udi)
+{
+    return udi.isEmpty() ? bookmark.metaDataItem("ID") : udi;
 }
 
-QList<KFilePlacesItem *> KFilePlacesModel::Private::loadBookmarkList()
+QList<KFilePlacesItem *> KFilePlacesModel::Private::loadBookmarkList(QSet<KFilePlacesItem *> *changedItems)
 {
     QList<KFilePlacesItem*> items;
 
+    // Items we already have are reused: creating an item is expensive, since
+    // it may look up the device or start listing the place
+    QHash<QString, KFilePlacesItem*> existingItems;
+    foreach (KFilePlacesItem *item, this->items) {
+        existingItems.insert(item->id(), item);
+    }
+
     KBookmarkGroup root = bookmarkManager->root();
     KBookmark bookmark = root.first();
     QSet<QString> devices = availableDevices;
@@ -450,15 +525,28 @@ QList<KFilePlacesItem *> KFilePlacesModel::Private::loadBookmarkList()
         bool allowedHere = appName.isEmpty() || (appName==KGlobal::mainComponent().componentName());
 
         if ((udi.isEmpty() && allowedHere) || deviceAvailable) {
-            KFilePlacesItem *item;
-            if (deviceAvailable) {
-                item = new KFilePlacesItem(bookmarkManager, bookmark.address(), udi);
-                // TODO: Update bookmark internal element
+            KFilePlacesItem *item = 0;
+            const QString id = bookmarkId(bookmark, deviceAvailable ? udi : QString());
+            if (!id.isEmpty()) {
+                item = existingItems.take(id);
+            }
+            if (item) {
+                if (!(item->bookmark() == bookmark)) {
+                    if (!sameBookmarkContent(item->bookmark(), bookmark)) {
+                        *changedItems << item;
+                    }
+                    item->setBookmark(bookmark);
+                }
             } else {
-                item = new KFilePlacesItem(bookmarkManager, bookmark.address());
+                if (deviceAvailable) {
+                    item = new KFilePlacesItem(bookmarkManager, bookmark.address(), udi);
+                    // TODO: Update bookmark internal element
+                } else {
+                    item = new KFilePlacesItem(bookmarkManager, bookmark.address());
+                }
+                connect(item, SIGNAL(itemChanged(QString)),
+                        q, SLOT(_k_itemChanged(QString)));
             }
-            connect(item, SIGNAL(itemChanged(QString)),
-                    q, SLOT(_k_itemChanged(QString)));
             items << item;
         }
 
@@ -20,6 +20,8 @@
 #include "kfileplacessharedbookmarks_p.h"
 
 #include <QtCore/QObject>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QStringList>
 #include <QtCore/QTextStream>
 #include <QtCore/QFile>
 #include <kstandarddirs.h>
@@ -34,49 +36,64 @@ static bool compareBookmarks(const KBookmark & bookmark1, const KBookmark & book
     return (bookmark1.url() == bookmark2.url() || bookmark1.text() == bookmark2.text());
 }
 
-static bool deepCompareDomNodes(const QDomNode & node1, const QDomNode & node2)
+static void addNodeToHash(QCryptographicHash *hash, const QDomNode & node)
 {
-    
-    // compare name and value
-    if (node1.nodeName() != node2.nodeName() || node1.nodeValue() != node2.nodeValue())
-        return false;
-    
-    // recursively compare children
-    const QDomNodeList node1Children  = node1.childNodes();
-    const QDomNodeList node2Children  = node2.childNodes();
-    
-    if (node1Children.count () != node2Children.count ())
-        return false;
-    
-    for (int i=0; i<node1Children.count ();i++) {
-        if (!deepCompareDomNodes(node1Children.at(i), node2Children.at(i) ))
-            return false;
+    hash->addData(node.nodeName().toUtf8());
+    hash->addData("\0", 1);
+    hash->addData(node.nodeValue().toUtf8());
+    hash->addData("\0", 1);
+
+    // attributes are unordered, sort them to get a canonical form
+    const QDomNamedNodeMap attributes = node.attributes();
+    QStringList attributeList;
+    for (int i=0; i<attributes.count(); i++) {
+        const QDomNode attribute = attributes.item(i);
+        attributeList << attribute.nodeName() + '=' + attribute.nodeValue();
     }
-    return true;
+    attributeList.sort();
+    foreach (const QString &attribute, attributeList) {
+        hash->addData(attribute.toUtf8());
+        hash->addData("\0", 1);
+    }
+
+    // children are delimited so that moving a node up or down the tree
+    // changes the hash
+    const QDomNodeList children = node.childNodes();
+    hash->addData("(", 1);
+    for (int i=0; i<children.count(); i++) {
+        addNodeToHash(hash, children.at(i));
+    }
+    hash->addData(")", 1);
 }
 
-/*
-static QString nodeAsString(const QDomNode & node1)
+static QByteArray bookmarkHash(const KBookmark & bookmark)
 {
-    QString str;
-    QTextStream ts( &str, QIODevice::WriteOnly );
-    ts << node1; 
-    return str;    
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    addNodeToHash(&hash, bookmark.internalElement());
+    return hash.result();
 }
-*/
 
-static bool exactCompareBookmarks(const KBookmark & bookmark1, const KBookmark & bookmark2)
+// Returns the hashes of the bookmarks of root, skipping system items if
+// skipSystemItems is true
+static QVector<QByteArray> bookmarkGroupHashes(const KBookmarkGroup & root, bool skipSystemItems)
 {
-    //kDebug() << "excat comparing:\n" << nodeAsString(bookmark1.internalElement()) << "\nwith:\n" << nodeAsString(bookmark2.internalElement()); 
-    return deepCompareDomNodes(bookmark1.internalElement(), bookmark2.internalElement());
+    QVector<QByteArray> hashes;
+    for (KBookmark bookmark = root.first(); !bookmark.isNull(); bookmark = root.next(bookmark)) {
+        if (skipSystemItems && bookmark.metaDataItem("isSystemItem") == "true") {
+            continue;
+        }
+        hashes << bookmarkHash(bookmark);
+    }
+    return hashes;
 }
 
-static void cloneBookmarkContents(const KBookmark & target, const KBookmark & source)
+static KBookmark cloneBookmarkContents(const KBookmark & target, const KBookmark & source)
 {
     const QDomElement targetEl = target.internalElement();
     QDomNode parent = targetEl.parentNode ();
     QDomNode clonedNode = source.internalElement().cloneNode(true);
     parent.replaceChild (clonedNode , targetEl );
+    return KBookmark(clonedNode.toElement());
 }
 
 static KBookmark cloneBookmark(const KBookmark & toClone)
@@ -86,25 +103,17 @@ static KBookmark cloneBookmark(const KBookmark & toClone)
 }
 
 
-static void emptyBookmarkGroup(KBookmarkGroup & root)
-{
-    KBookmark bookmark = root.first();
-    while (!bookmark.isNull()) {
-        KBookmark bookmarkToRemove = bookmark; 
-        bookmark = root.next(bookmark);
-        root.deleteBookmark(bookmarkToRemove);
-    }
-}
+//////////////// class KFilePlacesSharedBookmarks::HashCache
 
-static int bookmarkGroupSize(KBookmarkGroup & root)
+const QVector<QByteArray> &KFilePlacesSharedBookmarks::HashCache::hashesFor(KBookmarkManager *manager, bool skipSystemItems)
 {
-    int count=0;
-    KBookmark bookmark = root.first();
-    while (!bookmark.isNull()) {
-        count++;
-        bookmark = root.next(bookmark);
+    const QDomDocument currentDocument = manager->internalDocument();
+    if (!valid || document != currentDocument) {
+        hashes = bookmarkGroupHashes(manager->root(), skipSystemItems);
+        document = currentDocument;
+        valid = true;
     }
-    return count;
+    return hashes;
 }
 
 //////////////// class KFilePlacesSharedBookmarks
@@ -133,13 +142,22 @@ KFilePlacesSharedBookmarks::KFilePlacesSharedBookmarks(KBookmarkManager * mgr)
 
 bool KFilePlacesSharedBookmarks::integrateSharedBookmarks()
 {
+    // Copies: the places bookmarks are about to change
+    const QVector<QByteArray> placesHashes = m_placesHashes.hashesFor(m_placesBookmarkManager, true);
+    const QVector<QByteArray> sharedHashes = m_sharedHashes.hashesFor(m_sharedBookmarkManager, false);
+    if (placesHashes == sharedHashes) {
+        return false;
+    }
+    m_placesHashes.valid = false;
+
     KBookmarkGroup root = m_placesBookmarkManager->root();
     KBookmark bookmark = root.first();
     
     KBookmarkGroup sharedRoot = m_sharedBookmarkManager->root();
     KBookmark sharedBookmark = sharedRoot.first();
   
-    bool dirty = false;
+    int index = 0;
+    int sharedIndex = 0;
     
     while (!bookmark.isNull()) {
         //kDebug() << "importing" << bookmark.text();
@@ -150,28 +168,28 @@ bool KFilePlacesSharedBookmarks::integrateSharedBookmarks()
             continue;
         }
 
+        // identical bookmarks, nothing to look at
+        if (!sharedBookmark.isNull() && index < placesHashes.count()
+            && placesHashes.at(index) == sharedHashes.at(sharedIndex)) {
+            sharedBookmark = sharedRoot.next(sharedBookmark);
+            ++sharedIndex;
+            bookmark = root.next(bookmark);
+            ++index;
+            continue;
+        }
+
         // do the bookmarks match?
         if (!sharedBookmark.isNull() && compareBookmarks(bookmark, sharedBookmark)) {
-            //kDebug() << "excat comparing: targetbk:\n" << nodeAsString(bookmark.internalElement()) << "\nsourcbk:\n" << nodeAsString(sharedBookmark.internalElement());
+            KBookmark cloneTarget=bookmark;
+            KBookmark cloneSource = sharedBookmark;
           
-            if (!exactCompareBookmarks(bookmark, sharedBookmark)) {
-                KBookmark cloneTarget=bookmark;
-                KBookmark cloneSource = sharedBookmark;
-              
-                sharedBookmark = sharedRoot.next(sharedBookmark);
-                bookmark = root.next(bookmark);
-
-                //kDebug() << "cloning" << cloneSource.text();
-                //kDebug() << "cloning: target=\n" << nodeAsString(cloneTarget.internalElement()) << "\n source:\n" << nodeAsString(cloneSource.internalElement());
-
-                cloneBookmarkContents(cloneTarget, cloneSource);
-                dirty = true;
-                continue;
-            } else {
-                //kDebug() << "keeping" << bookmark.text();
-            }
             sharedBookmark = sharedRoot.next(sharedBookmark);
+            ++sharedIndex;
             bookmark = root.next(bookmark);
+            ++index;
+
+            //kDebug() << "cloning" << cloneSource.text();
+            cloneBookmarkContents(cloneTarget, cloneSource);
             continue;
         }
         
@@ -179,94 +197,96 @@ bool KFilePlacesSharedBookmarks::integrateSharedBookmarks()
         //kDebug() << "removing" << bookmark.text();
         KBookmark bookmarkToRemove = bookmark; 
         bookmark = root.next(bookmark);
+        ++index;
         root.deleteBookmark(bookmarkToRemove);
-        
-        dirty = true;
     }
 
     // append the remaining shared bookmarks
     while(!sharedBookmark.isNull()) {
         root.addBookmark(cloneBookmark(sharedBookmark));
         sharedBookmark = sharedRoot.next(sharedBookmark);
-        dirty = true;
     }
-  
-    return dirty;
+
+    return true;
 }
 
 bool KFilePlacesSharedBookmarks::exportSharedBookmarks()
 {
+    // Copies: the shared bookmarks are about to change
+    const QVector<QByteArray> placesHashes = m_placesHashes.hashesFor(m_placesBookmarkManager, true);
+    const QVector<QByteArray> sharedHashes = m_sharedHashes.hashesFor(m_sharedBookmarkManager, false);
+    if (placesHashes == sharedHashes) {
+        return false;
+    }
+    m_sharedHashes.valid = false;
+
     KBookmarkGroup root = m_placesBookmarkManager->root();
-    KBookmark bookmark = root.first();
-    
     KBookmarkGroup sharedRoot = m_sharedBookmarkManager->root();
-    KBookmark sharedBookmark = sharedRoot.first();
-  
-    bool dirty = false;
-    
-    // first check if they are the same
-    int count=0;
-    while (!bookmark.isNull()) {
+
+    // sharedHashes.at(idx) is the hash of sharedBookmarks.at(idx)
+    QList<KBookmark> sharedBookmarks;
+    for (KBookmark sharedBookmark = sharedRoot.first(); !sharedBookmark.isNull(); sharedBookmark = sharedRoot.next(sharedBookmark)) {
+        sharedBookmarks << sharedBookmark;
+    }
+
+    // Match our bookmarks with the shared ones by hash, so that inserting or
+    // removing one bookmark does not rewrite all the ones after it
+    int index = 0;
+    int sharedIndex = 0;
+    KBookmark previous;
+    for (KBookmark bookmark = root.first(); !bookmark.isNull(); bookmark = root.next(bookmark)) {
         //kDebug() << "exporting..." << bookmark.text();
       
         // skip over system items
         if (bookmark.metaDataItem("isSystemItem") == "true") {
-          bookmark = root.next(bookmark);
-          continue;
+            continue;
         }
-        count++;
-        
-        // end of sharedBookmarks?
-        if (sharedBookmark.isNull()) {
-            dirty=true;
-            break;
+        const QByteArray &hash = placesHashes.at(index);
+        ++index;
+
+        // identical bookmarks, nothing to do
+        if (sharedIndex < sharedBookmarks.count() && sharedHashes.at(sharedIndex) == hash) {
+            previous = sharedBookmarks.at(sharedIndex);
+            ++sharedIndex;
+            continue;
         }
-        
-        // do the bookmarks match?
-        if (compareBookmarks(bookmark, sharedBookmark)) {
-            if (!exactCompareBookmarks(bookmark, sharedBookmark)) {
-                dirty = true;
-                break;
+
+        // found further: the shared bookmarks in between have been removed
+        const int matchIndex = sharedHashes.indexOf(hash, sharedIndex + 1);
+        if (matchIndex != -1) {
+            for (; sharedIndex < matchIndex; ++sharedIndex) {
+                sharedRoot.deleteBookmark(sharedBookmarks.at(sharedIndex));
             }
-        } else {
-            dirty=true;
-            break;
+            previous = sharedBookmarks.at(matchIndex);
+            sharedIndex = matchIndex + 1;
+            continue;
         }
-        sharedBookmark = sharedRoot.next(sharedBookmark);
-        bookmark = root.next(bookmark);
-    }
-  
-    //kDebug() << "dirty=" << dirty << " oldsize=" << bookmarkGroupSize(sharedRoot) << " count=" << count;
-    
-    if (bookmarkGroupSize(sharedRoot) != count)
-        dirty=true;
-    
-    if (dirty) {
-        emptyBookmarkGroup(sharedRoot);
 
-        // append all bookmarks
-        KBookmark bookmark = root.first();
-      
-        while(!bookmark.isNull()) {
-          
-            if (bookmark.metaDataItem("isSystemItem") == "true") {
-              bookmark = root.next(bookmark);
-              continue;
-            }
-          
-            sharedRoot.addBookmark(cloneBookmark(bookmark));
-            bookmark = root.next(bookmark);
-            dirty = true;
+        // changed bookmark: replace its content
+        if (sharedIndex < sharedBookmarks.count() && compareBookmarks(bookmark, sharedBookmarks.at(sharedIndex))) {
+            previous = cloneBookmarkContents(sharedBookmarks.at(sharedIndex), bookmark);
+            ++sharedIndex;
+            continue;
         }
+
+        // new bookmark
+        KBookmark added = sharedRoot.addBookmark(cloneBookmark(bookmark));
+        sharedRoot.moveBookmark(added, previous);
+        previous = added;
     }
-    
-    return dirty;    
-  
+
+    // remove the shared bookmarks we do not have anymore
+    for (; sharedIndex < sharedBookmarks.count(); ++sharedIndex) {
+        sharedRoot.deleteBookmark(sharedBookmarks.at(sharedIndex));
+    }
+
+    return true;
 }
 
 void KFilePlacesSharedBookmarks::slotSharedBookmarksChanged()
 {
     //kDebug() << "shared bookmarks changed";
+    m_sharedHashes.valid = false;
     bool dirty = integrateSharedBookmarks();
     if (dirty) m_placesBookmarkManager->emitChanged();
 }
@@ -274,6 +294,7 @@ void KFilePlacesSharedBookmarks::slotSharedBookmarksChanged()
 void KFilePlacesSharedBookmarks::slotBookmarksChanged()
 {
     //kDebug() << "places bookmarks changed";
+    m_placesHashes.valid = false;
     bool dirty = exportSharedBookmarks();
     if (dirty) m_sharedBookmarkManager->emitChanged();
 }
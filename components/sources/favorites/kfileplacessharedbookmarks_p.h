@@ -21,6 +21,8 @@
 #define KFILEPLACESSHAREDBOOKMARKS_P_H
 
 #include <QtCore/QObject>
+#include <QtCore/QVector>
+#include <QtXml/QDomDocument>
 #include <kbookmarkmanager.h>
 
 /**
@@ -37,11 +39,32 @@ public:
       
 private:
   
+    /**
+     * Hashes of the bookmarks of one side, kept until that side changes
+     */
+    struct HashCache
+    {
+        // The document the hashes were computed from: managers replace it
+        // when they reload their file
+        QDomDocument document;
+        QVector<QByteArray> hashes;
+        bool valid;
+
+        HashCache() : valid(false) {}
+
+        // Returns the hashes of the bookmarks of manager, recomputing them
+        // only if they are not valid or manager reloaded its document
+        const QVector<QByteArray> &hashesFor(KBookmarkManager *manager, bool skipSystemItems);
+    };
+
     bool integrateSharedBookmarks();
     bool exportSharedBookmarks();
+
   
     KBookmarkManager *m_placesBookmarkManager;
     KBookmarkManager *m_sharedBookmarkManager;
+    HashCache m_placesHashes;
+    HashCache m_sharedHashes;
     
 private Q_SLOTS:    
 
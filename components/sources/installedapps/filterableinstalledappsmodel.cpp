@@ -88,6 +88,13 @@ int InstalledAppsFilterModel::count() const
     return rowCount();
 }
 
+SearchTask *InstalledAppsFilterModel::createSearchTask()
+{
+    // Rows of the task are our rows: this only makes sense while the model
+    // is not filtered through its query
+    return new TextSearchTask(this, InstalledAppsModel::CombinedNameRole);
+}
+
 void InstalledAppsFilterModel::refresh(bool reload)
 {
     m_installedAppsModel->refresh(reload);
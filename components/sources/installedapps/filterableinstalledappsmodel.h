@@ -23,6 +23,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <abstractsource.h>
+#include <searchable.h>
 
 // Qt
 #include <QSortFilterProxyModel>
@@ -39,9 +40,10 @@ namespace Homerun {
 class InstalledAppsModel;
 class FilterableInstalledAppsModel;
 
-class InstalledAppsFilterModel : public QSortFilterProxyModel
+class InstalledAppsFilterModel : public QSortFilterProxyModel, public Searchable
 {
     Q_OBJECT
+    Q_INTERFACES(Homerun::Searchable)
     Q_PROPERTY(bool hidden READ hidden WRITE setHidden NOTIFY hiddenChanged)
     Q_PROPERTY(int count READ count NOTIFY countChanged)
     Q_PROPERTY(QString name READ name CONSTANT)
@@ -63,6 +65,8 @@ public:
     bool hidden() const;
     void setHidden(bool hidden);
 
+    SearchTask *createSearchTask(); // reimp
+
 Q_SIGNALS:
     void countChanged();
     void hiddenChanged();
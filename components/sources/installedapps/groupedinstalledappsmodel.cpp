@@ -141,6 +141,41 @@ InstalledAppsModel *GroupedInstalledAppsModel::createInstalledAppsModel(KService
     return model;
 }
 
+//- GroupedInstalledAppsModelProxy ----------------------------------
+GroupedInstalledAppsModelProxy::GroupedInstalledAppsModelProxy(GroupedInstalledAppsModel *model, QObject *parent)
+: QIdentityProxyModel(parent)
+, m_model(model)
+{
+    setSourceModel(model);
+    setRoleNames(model->roleNames());
+}
+
+QObject *GroupedInstalledAppsModelProxy::modelForRow(int row) const
+{
+    InstalledAppsModel *model = m_model ? qobject_cast<InstalledAppsModel *>(m_model->modelForRow(row)) : 0;
+    if (!model) {
+        return 0;
+    }
+    InstalledAppsModelProxy *proxy = m_proxyForModel.value(model);
+    if (!proxy) {
+        GroupedInstalledAppsModelProxy *that = const_cast<GroupedInstalledAppsModelProxy *>(this);
+        proxy = new InstalledAppsModelProxy(model, that);
+        connect(proxy, SIGNAL(applicationLaunched(QString)), SIGNAL(applicationLaunched(QString)));
+        connect(model, SIGNAL(destroyed(QObject *)), SLOT(slotSubModelDestroyed(QObject *)));
+        m_proxyForModel.insert(model, proxy);
+    }
+    return proxy;
+}
+
+void GroupedInstalledAppsModelProxy::slotSubModelDestroyed(QObject *model)
+{
+    InstalledAppsModelProxy *proxy = m_proxyForModel.take(model);
+    if (proxy) {
+        // Views may still be using the proxy until the end of this event
+        proxy->deleteLater();
+    }
+}
+
 //- GroupedInstalledAppsSource --------------------------------------
 GroupedInstalledAppsSource::GroupedInstalledAppsSource(QObject *parent)
 : AbstractSource(parent)
@@ -26,6 +26,8 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Qt
 #include <QAbstractListModel>
+#include <QIdentityProxyModel>
+#include <QPointer>
 
 // KDE
 #include <KServiceGroup>
@@ -33,6 +35,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 namespace Homerun {
 
 class InstalledAppsModel;
+class InstalledAppsModelProxy;
 
 /**
  * A model which returns all services in grouped sub-models
@@ -68,6 +71,30 @@ private:
     InstalledAppsModel *createInstalledAppsModel(KServiceGroup::Ptr group);
 };
 
+/**
+ * The view of one GroupedInstalledAppsModel shared between several views.
+ * modelForRow() returns InstalledAppsModelProxy instances owned by this
+ * proxy, so that each view has its own containment and launch signals.
+ */
+class GroupedInstalledAppsModelProxy : public QIdentityProxyModel
+{
+    Q_OBJECT
+public:
+    explicit GroupedInstalledAppsModelProxy(GroupedInstalledAppsModel *model, QObject *parent = 0);
+
+    Q_INVOKABLE QObject *modelForRow(int row) const;
+
+Q_SIGNALS:
+    void applicationLaunched(const QString &);
+
+private Q_SLOTS:
+    void slotSubModelDestroyed(QObject *model);
+
+private:
+    QPointer<GroupedInstalledAppsModel> m_model;
+    mutable QHash<QObject *, InstalledAppsModelProxy *> m_proxyForModel;
+};
+
 class GroupedInstalledAppsSource : public AbstractSource
 {
 public:
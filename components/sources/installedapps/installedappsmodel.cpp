@@ -21,15 +21,17 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 // Local
 #include <changenotifier.h>
 #include <pathmodel.h>
-#include <actionlist.h>
+#include <actionlistmodel.h>
 #include <installedappsmodel.h>
 #include <installedappsconfigurationwidget.h>
+#include <rowdata.h>
 #include <sourceregistry.h>
 
 // Qt
 #include <QApplication>
 #include <QIcon>
 #include <QAction>
+#include <QPointer>
 #include <QTimer>
 
 // KDE
@@ -48,6 +50,58 @@ namespace Homerun {
 
 static const char *SOURCE_ID = "InstalledApps";
 
+//- AppActionListCache ---------------------------------------------------------
+enum AppAction {
+    AddToDesktopAction = 1,
+    AddToPanelAction = 2,
+    AddLauncherAction = 4
+};
+
+/**
+ * The action list of an application only depends on which actions are
+ * available: all models share one ActionListModel per combination
+ */
+class AppActionListCache : public QObject
+{
+public:
+    AppActionListCache()
+    : QObject(qApp)
+    {}
+
+    ActionListModel *modelForActions(int actions)
+    {
+        ActionListModel *model = m_modelForActions.value(actions);
+        if (model) {
+            return model;
+        }
+        model = new ActionListModel(this);
+        if (actions & AddToDesktopAction) {
+            model->addAction(i18n("Add to Desktop"), "addToDesktop");
+        }
+        if (actions & AddToPanelAction) {
+            model->addAction(i18n("Add to Panel"), "addToPanel");
+        }
+        if (actions & AddLauncherAction) {
+            model->addAction(i18n("Add as Launcher"), "addLauncher");
+        }
+        m_modelForActions.insert(actions, model);
+        return model;
+    }
+
+private:
+    QHash<int, ActionListModel *> m_modelForActions;
+};
+
+static QPointer<AppActionListCache> s_appActionListCache;
+
+static ActionListModel *sharedAppActionList(int actions)
+{
+    if (!s_appActionListCache) {
+        s_appActionListCache = new AppActionListCache;
+    }
+    return s_appActionListCache->modelForActions(actions);
+}
+
 //- AbstractNode ---------------------------------------------------------------
 AbstractNode::~AbstractNode()
 {
@@ -70,10 +124,11 @@ GroupNode::GroupNode(KServiceGroup::Ptr group, InstalledAppsModel *model)
     m_sortKey = m_name.toLower();
 }
 
-bool GroupNode::trigger(const QString &actionId, const QVariant &actionArgument)
+bool GroupNode::trigger(const QString &actionId, const QVariant &actionArgument, QObject *containment)
 {
     Q_UNUSED(actionId)
     Q_UNUSED(actionArgument)
+    Q_UNUSED(containment)
 
     QVariantMap args;
     args.insert("entryPath", m_entryPath);
@@ -93,7 +148,7 @@ AppNode::AppNode(KService::Ptr service, InstalledAppsModel *model)
     m_sortKey = m_name.toLower();
 }
 
-bool AppNode::trigger(const QString &actionId, const QVariant &actionArgument)
+bool AppNode::trigger(const QString &actionId, const QVariant &actionArgument, QObject *containmentObject)
 {
     Q_UNUSED(actionArgument)
 
@@ -105,8 +160,8 @@ bool AppNode::trigger(const QString &actionId, const QVariant &actionArgument)
                 : qApp->property("appletContainmentId").toUInt();
             return QMetaObject::invokeMethod(adaptor.value<QObject *>(), actionId.toLocal8Bit(),
                 Qt::DirectConnection, Q_ARG(uint, containmentId), Q_ARG(QString, m_service->storageId()));
-        } else if (m_model->containment()) {
-            Plasma::Containment *containment = static_cast<Plasma::Containment *>(m_model->containment());
+        } else if (containmentObject) {
+            Plasma::Containment *containment = static_cast<Plasma::Containment *>(containmentObject);
 
             if (actionId == "addToDesktop") {
                 Plasma::Containment *desktop = containment->corona()->containmentForScreen(containment->screen());
@@ -170,10 +225,11 @@ InstallerNode::InstallerNode(KServiceGroup::Ptr group, KService::Ptr installerSe
     m_name = m_service->name();
 }
 
-bool InstallerNode::trigger(const QString &actionId, const QVariant &actionArgument)
+bool InstallerNode::trigger(const QString &actionId, const QVariant &actionArgument, QObject *containment)
 {
     Q_UNUSED(actionId)
     Q_UNUSED(actionArgument)
+    Q_UNUSED(containment)
 
     QHash<QString, QString> map;
     QString category = m_group->entryPath();
@@ -237,8 +293,21 @@ QVariant InstalledAppsModel::data(const QModelIndex &index, int role) const
     if (!index.isValid() || index.row() >= m_nodeList.count()) {
         return QVariant();
     }
+    return nodeData(m_nodeList.at(index.row()), role);
+}
+
+QVariantList InstalledAppsModel::rowData(int first, int count, const QStringList &roleNames) const
+{
+    return RowData::fetch(this, first, count, roleNames, &InstalledAppsModel::nodeAt, &InstalledAppsModel::nodeData);
+}
+
+AbstractNode *InstalledAppsModel::nodeAt(int row) const
+{
+    return m_nodeList.at(row);
+}
 
-    AbstractNode *node = m_nodeList.at(index.row());
+QVariant InstalledAppsModel::nodeData(AbstractNode *node, int role) const
+{
     if (role == Qt::DisplayRole) {
         return node->name();
     } else if (role == Qt::DecorationRole) {
@@ -249,66 +318,84 @@ QVariant InstalledAppsModel::data(const QModelIndex &index, int role) const
     } else if (role == HasActionListRole) {
         return node->type() == AbstractNode::AppNodeType;
     } else if (role == ActionListRole && node->type() == AbstractNode::AppNodeType) {
-        QVariantList actionList;
+        return nodeActionList(node, m_containment);
+    } else if (role == GenericNameRole && node->type() == AbstractNode::AppNodeType) {
+        return static_cast<AppNode *>(node)->genericName();
+    } else if (role == CombinedNameRole && node->type() == AbstractNode::AppNodeType) {
+        AppNode *appNode = static_cast<AppNode *>(node);
+        return QString(appNode->name() + ' ' + appNode->genericName());
+    }
 
-        if (qApp->property("HomerunViewerAdaptor").isValid())
-        {
-            if (qApp->property("desktopContainmentId").toUInt() > 0
-                && qApp->property("desktopContainmentMutable").toBool()) {
-                actionList << ActionList::createActionItem(i18n("Add to Desktop"), "addToDesktop");
-            }
-            if (qApp->property("appletContainmentId").toUInt() > 0
-                && qApp->property("appletContainmentMutable").toBool()) {
-                actionList << ActionList::createActionItem(i18n("Add to Panel"), "addToPanel");
-            }
-        } else if (m_containment) {
-            Plasma::Containment *containment = static_cast<Plasma::Containment *>(m_containment);
-            Plasma::Containment *desktop = containment->corona()->containmentForScreen(containment->screen());
+    return QVariant();
+}
 
-            if (desktop && desktop->immutability() == Plasma::Mutable) {
-                actionList << ActionList::createActionItem(i18n("Add to Desktop"), "addToDesktop");
-            }
+QVariant InstalledAppsModel::actionList(int row, QObject *containment) const
+{
+    if (row < 0 || row >= m_nodeList.count() || m_nodeList.at(row)->type() != AbstractNode::AppNodeType) {
+        return QVariant();
+    }
+    return nodeActionList(m_nodeList.at(row), containment);
+}
 
-            if (containment->immutability() == Plasma::Mutable) {
-                actionList << ActionList::createActionItem(i18n("Add to Panel"), "addToPanel");
-            }
+QVariant InstalledAppsModel::nodeActionList(AbstractNode *node, QObject *containmentObject) const
+{
+    int actions = 0;
+
+    if (qApp->property("HomerunViewerAdaptor").isValid())
+    {
+        if (qApp->property("desktopContainmentId").toUInt() > 0
+            && qApp->property("desktopContainmentMutable").toBool()) {
+            actions |= AddToDesktopAction;
+        }
+        if (qApp->property("appletContainmentId").toUInt() > 0
+            && qApp->property("appletContainmentMutable").toBool()) {
+            actions |= AddToPanelAction;
+        }
+    } else if (containmentObject) {
+        Plasma::Containment *containment = static_cast<Plasma::Containment *>(containmentObject);
+        Plasma::Containment *desktop = containment->corona()->containmentForScreen(containment->screen());
 
-            QObject* taskManager = 0;
+        if (desktop && desktop->immutability() == Plasma::Mutable) {
+            actions |= AddToDesktopAction;
+        }
 
-            foreach(QObject* applet, containment->applets()) {
-                if (applet->metaObject()->indexOfSlot("hasLauncher(QString)") != -1) {
-                    taskManager = applet;
-                }
+        if (containment->immutability() == Plasma::Mutable) {
+            actions |= AddToPanelAction;
+        }
+
+        QObject* taskManager = 0;
+
+        foreach(QObject* applet, containment->applets()) {
+            if (applet->metaObject()->indexOfSlot("hasLauncher(QString)") != -1) {
+                taskManager = applet;
             }
+        }
 
-            if (taskManager) {
-                AppNode* appNode = static_cast<AppNode *>(node);
+        if (taskManager) {
+            AppNode* appNode = static_cast<AppNode *>(node);
 
-                bool hasLauncher = false;
+            bool hasLauncher = false;
 
-                QMetaObject::invokeMethod(taskManager, "hasLauncher", Qt::DirectConnection,
-                    Q_RETURN_ARG(bool, hasLauncher), Q_ARG(QString, appNode->service()->storageId()));
+            QMetaObject::invokeMethod(taskManager, "hasLauncher", Qt::DirectConnection,
+                Q_RETURN_ARG(bool, hasLauncher), Q_ARG(QString, appNode->service()->storageId()));
 
-                if (!hasLauncher) {
-                    actionList << ActionList::createActionItem(i18n("Add as Launcher"), "addLauncher");
-                }
+            if (!hasLauncher) {
+                actions |= AddLauncherAction;
             }
         }
-
-        return actionList;
-    } else if (role == GenericNameRole && node->type() == AbstractNode::AppNodeType) {
-        return static_cast<AppNode *>(node)->genericName();
-    } else if (role == CombinedNameRole && node->type() == AbstractNode::AppNodeType) {
-        AppNode *appNode = static_cast<AppNode *>(node);
-        return QString(appNode->name() + ' ' + appNode->genericName());
     }
 
-    return QVariant();
+    return QVariant::fromValue<QObject *>(sharedAppActionList(actions));
 }
 
 bool InstalledAppsModel::trigger(int row, const QString &actionId, const QVariant &actionArgument)
 {
-    return m_nodeList.at(row)->trigger(actionId, actionArgument);
+    return trigger(row, actionId, actionArgument, m_containment);
+}
+
+bool InstalledAppsModel::trigger(int row, const QString &actionId, const QVariant &actionArgument, QObject *containment)
+{
+    return m_nodeList.at(row)->trigger(actionId, actionArgument, containment);
 }
 
 void InstalledAppsModel::refresh(bool reload)
@@ -441,6 +528,97 @@ QString InstalledAppsModel::name() const
     }
 }
 
+SearchTask *InstalledAppsModel::createSearchTask()
+{
+    // Group nodes have no combined name, so they never match
+    return new TextSearchTask(this, CombinedNameRole);
+}
+
+//- InstalledAppsModelProxy -----------------------------------------
+InstalledAppsModelProxy::InstalledAppsModelProxy(InstalledAppsModel *model, QObject *parent)
+: QIdentityProxyModel(parent)
+, m_model(model)
+, m_containment(0)
+, m_triggering(false)
+{
+    setSourceModel(model);
+    setRoleNames(model->roleNames());
+    connect(model, SIGNAL(countChanged()), SIGNAL(countChanged()));
+    connect(model, SIGNAL(openSourceRequested(QString, QVariantMap)),
+        SLOT(slotOpenSourceRequested(QString, QVariantMap)));
+    connect(model, SIGNAL(applicationLaunched(QString)), SLOT(slotApplicationLaunched(QString)));
+}
+
+QVariant InstalledAppsModelProxy::data(const QModelIndex &index, int role) const
+{
+    if (role == InstalledAppsModel::ActionListRole && m_model && index.isValid()) {
+        return m_model->actionList(index.row(), m_containment);
+    }
+    return QIdentityProxyModel::data(index, role);
+}
+
+int InstalledAppsModelProxy::count() const
+{
+    return rowCount();
+}
+
+QVariantList InstalledAppsModelProxy::rowData(int first, int count, const QStringList &roleNames) const
+{
+    return RowData::fetch(this, first, count, roleNames);
+}
+
+PathModel *InstalledAppsModelProxy::pathModel() const
+{
+    return m_model ? m_model->pathModel() : 0;
+}
+
+bool InstalledAppsModelProxy::trigger(int row, const QString &actionId, const QVariant &actionArgument)
+{
+    if (!m_model || row < 0 || row >= m_model->count()) {
+        return false;
+    }
+    // Other views of the model ignore the signals emitted meanwhile
+    m_triggering = true;
+    bool ok = m_model->trigger(row, actionId, actionArgument, m_containment);
+    m_triggering = false;
+    return ok;
+}
+
+QObject *InstalledAppsModelProxy::containment() const
+{
+    return m_containment;
+}
+
+void InstalledAppsModelProxy::setContainment(QObject *containment)
+{
+    m_containment = containment;
+}
+
+QString InstalledAppsModelProxy::name() const
+{
+    return m_model ? m_model->name() : QString();
+}
+
+SearchTask *InstalledAppsModelProxy::createSearchTask()
+{
+    // Rows of the proxy are the rows of the model
+    return m_model ? m_model->createSearchTask() : new TextSearchTask(QStringList());
+}
+
+void InstalledAppsModelProxy::slotOpenSourceRequested(const QString &sourceId, const QVariantMap &args)
+{
+    if (m_triggering) {
+        openSourceRequested(sourceId, args);
+    }
+}
+
+void InstalledAppsModelProxy::slotApplicationLaunched(const QString &storageId)
+{
+    if (m_triggering) {
+        applicationLaunched(storageId);
+    }
+}
+
 //- InstalledAppsSource ---------------------------------------------
 InstalledAppsSource::InstalledAppsSource(QObject *parent)
 : AbstractSource(parent)
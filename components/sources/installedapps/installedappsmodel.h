@@ -23,9 +23,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <abstractsource.h>
+#include <searchable.h>
 
 // Qt
 #include <QAbstractListModel>
+#include <QIdentityProxyModel>
+#include <QPointer>
 #include <QSortFilterProxyModel>
 #include <QStringList>
 
@@ -51,7 +54,10 @@ public:
 
     virtual NodeType type() const = 0;
 
-    virtual bool trigger(const QString &actionId = QString(), const QVariant &actionArgument = QVariant()) = 0;
+    /**
+     * @param containment the containment of the view triggering the node
+     */
+    virtual bool trigger(const QString &actionId, const QVariant &actionArgument, QObject *containment) = 0;
     virtual QString favoriteId() const { return QString(); }
 
     QString icon() const { return m_icon; }
@@ -74,7 +80,7 @@ public:
 
     NodeType type() const { return GroupNodeType; }
 
-    bool trigger(const QString &actionId = QString(), const QVariant &actionArgument = QVariant()); // reimp
+    bool trigger(const QString &actionId, const QVariant &actionArgument, QObject *containment); // reimp
 
 private:
     InstalledAppsModel *m_model;
@@ -88,7 +94,7 @@ public:
 
     NodeType type() const { return AppNodeType; }
 
-    bool trigger(const QString &actionId = QString(), const QVariant &actionArgument = QVariant()); // reimp;
+    bool trigger(const QString &actionId, const QVariant &actionArgument, QObject *containment); // reimp
     QString favoriteId() const; // reimp
 
     KService::Ptr service() const;
@@ -105,17 +111,17 @@ public:
 
     NodeType type() const { return InstallerNodeType; }
 
-    bool trigger(const QString &actionId = QString(), const QVariant &actionArgument = QVariant()); // reimp;
+    bool trigger(const QString &actionId, const QVariant &actionArgument, QObject *containment); // reimp
 
 private:
-    InstalledAppsModel *m_model;
     KServiceGroup::Ptr m_group;
     KService::Ptr m_service;
 };
 
-class InstalledAppsModel : public QAbstractListModel
+class InstalledAppsModel : public QAbstractListModel, public Searchable
 {
     Q_OBJECT
+    Q_INTERFACES(Homerun::Searchable)
     Q_PROPERTY(int count READ count NOTIFY countChanged)
     Q_PROPERTY(QObject* pathModel READ pathModel CONSTANT)
     Q_PROPERTY(QString name READ name CONSTANT)
@@ -137,15 +143,31 @@ public:
     int count() const;
     QVariant data(const QModelIndex &, int) const;
 
+    Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
     PathModel *pathModel() const;
 
     Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
 
+    /**
+     * Triggers @p row on behalf of a view whose containment is @p containment,
+     * see InstalledAppsModelProxy
+     */
+    bool trigger(int row, const QString &actionId, const QVariant &actionArgument, QObject *containment);
+
+    /**
+     * Returns the ActionListRole data of @p row for a view whose containment
+     * is @p containment
+     */
+    QVariant actionList(int row, QObject *containment) const;
+
     QObject *containment() const;
     void setContainment(QObject *containment);
 
     QString name() const;
 
+    SearchTask *createSearchTask(); // reimp
+
 Q_SIGNALS:
     void countChanged();
     void openSourceRequested(const QString &sourceId, const QVariantMap &args);
@@ -155,6 +177,10 @@ public Q_SLOTS:
     void refresh(bool reload = true);
 
 private:
+    AbstractNode *nodeAt(int row) const;
+    QVariant nodeData(AbstractNode *node, int role) const;
+    QVariant nodeActionList(AbstractNode *node, QObject *containment) const;
+
     void loadRootEntries();
     void loadServiceGroup(KServiceGroup::Ptr group);
     void doLoadServiceGroup(KServiceGroup::Ptr group);
@@ -171,6 +197,54 @@ private:
     friend class AppNode;
 };
 
+/**
+ * The view of one InstalledAppsModel shared between several views. It holds
+ * the state of its view: its containment, and only emits the navigation and
+ * launch signals caused by triggering its own rows.
+ */
+class InstalledAppsModelProxy : public QIdentityProxyModel, public Searchable
+{
+    Q_OBJECT
+    Q_INTERFACES(Homerun::Searchable)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QObject* pathModel READ pathModel CONSTANT)
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(QObject* containment READ containment WRITE setContainment)
+
+public:
+    explicit InstalledAppsModelProxy(InstalledAppsModel *model, QObject *parent = 0);
+
+    QVariant data(const QModelIndex &index, int role) const; // reimp
+    int count() const;
+
+    Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
+    PathModel *pathModel() const;
+
+    Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
+
+    QObject *containment() const;
+    void setContainment(QObject *containment);
+
+    QString name() const;
+
+    SearchTask *createSearchTask(); // reimp
+
+Q_SIGNALS:
+    void countChanged();
+    void openSourceRequested(const QString &sourceId, const QVariantMap &args);
+    void applicationLaunched(const QString& storageId);
+
+private Q_SLOTS:
+    void slotOpenSourceRequested(const QString &sourceId, const QVariantMap &args);
+    void slotApplicationLaunched(const QString &storageId);
+
+private:
+    QPointer<InstalledAppsModel> m_model;
+    QObject *m_containment;
+    bool m_triggering;
+};
+
 class InstalledAppsSource : public AbstractSource
 {
 public:
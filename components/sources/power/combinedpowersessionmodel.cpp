@@ -17,7 +17,7 @@
  */
 
 #include "combinedpowersessionmodel.h"
-#include "actionlist.h"
+#include "actionlistmodel.h"
 #include "powermodel.h"
 #include "sessionmodel.h"
 
@@ -190,6 +190,11 @@ CombinedPowerSessionModel::CombinedPowerSessionModel(const KConfigGroup &group,
 
     m_favoritesModel = new PowerSessionFavoritesModel(group, this);
 
+    m_addToFavoritesActions = new ActionListModel(this);
+    m_addToFavoritesActions->addAction(i18n("Add to Sidebar"), "addToFavorites", QVariant(), KIcon("bookmark-new"));
+    m_removeFromFavoritesActions = new ActionListModel(this);
+    m_removeFromFavoritesActions->addAction(i18n("Remove from Sidebar"), "removeFromFavorites", QVariant(), KIcon("list-remove"));
+
     connect(m_sessionModel, SIGNAL(rowsInserted(QModelIndex,int,int)), SIGNAL(countChanged()));
     connect(m_sessionModel, SIGNAL(rowsRemoved(QModelIndex,int,int)), SIGNAL(countChanged()));
     connect(m_sessionModel, SIGNAL(modelReset()), SIGNAL(countChanged()));
@@ -234,20 +239,10 @@ QVariant CombinedPowerSessionModel::data(const QModelIndex &index, int role) con
     } else if (role == HasActionListRole) {
         return m_showFavoritesActions;
     } else if (role == ActionListRole) {
-        QVariantList actionList;
-        QVariantMap action;
-
-        if (m_favoritesModel->isFavorite(index)) {
-            action = ActionList::createActionItem(i18n("Remove from Sidebar"), "removeFromFavorites");
-            action["icon"] = KIcon("list-remove");
-            actionList << action;
-        } else {
-            action = ActionList::createActionItem(i18n("Add to Sidebar"), "addToFavorites");
-            action["icon"] = KIcon("bookmark-new");
-            actionList << action;
-        }
-
-        return actionList;
+        ActionListModel *actions = m_favoritesModel->isFavorite(index)
+            ? m_removeFromFavoritesActions
+            : m_addToFavoritesActions;
+        return QVariant::fromValue<QObject *>(actions);
     }
 
     if (index.row() >= m_sessionModel->count()) {
@@ -27,6 +27,7 @@
 
 namespace Homerun {
 
+class ActionListModel;
 class PowerModel;
 class SessionModel;
 class CombinedPowerSessionModel;
@@ -114,6 +115,8 @@ class CombinedPowerSessionModel : public QAbstractListModel
         QHash<QString, QString> m_favoriteIdMapping;
         PowerSessionFavoritesModel* m_favoritesModel;
         bool m_showFavoritesActions;
+        ActionListModel *m_addToFavoritesActions;
+        ActionListModel *m_removeFromFavoritesActions;
 };
 
 class CombinedPowerSessionSource : public AbstractSource
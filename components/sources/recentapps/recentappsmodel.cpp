@@ -18,12 +18,14 @@ You should have received a copy of the GNU Lesser General Public
 License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 */
 // Local
-#include <actionlist.h>
+#include <actionlistmodel.h>
 #include <recentappsmodel.h>
+#include <rowdata.h>
 #include <sourceregistry.h>
 
 // Qt
 #include <QApplication>
+#include <QPointer>
 
 // KDE
 #include <KRun>
@@ -34,6 +36,60 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace Homerun {
 
+//- RecentAppActionListCache ---------------------------------------------------
+enum RecentAppAction {
+    AddToDesktopAction = 1,
+    AddToPanelAction = 2,
+    AddLauncherAction = 4
+};
+
+/**
+ * The action list of a recent application only depends on which actions are
+ * available: all models share one ActionListModel per combination
+ */
+class RecentAppActionListCache : public QObject
+{
+public:
+    RecentAppActionListCache()
+    : QObject(qApp)
+    {}
+
+    ActionListModel *modelForActions(int actions)
+    {
+        ActionListModel *model = m_modelForActions.value(actions);
+        if (model) {
+            return model;
+        }
+        model = new ActionListModel(this);
+        model->addAction(i18n("Forget Application"), "forget");
+        model->addSeparator();
+        if (actions & AddToDesktopAction) {
+            model->addAction(i18n("Add to Desktop"), "addToDesktop");
+        }
+        if (actions & AddToPanelAction) {
+            model->addAction(i18n("Add to Panel"), "addToPanel");
+        }
+        if (actions & AddLauncherAction) {
+            model->addAction(i18n("Add as Launcher"), "addLauncher");
+        }
+        m_modelForActions.insert(actions, model);
+        return model;
+    }
+
+private:
+    QHash<int, ActionListModel *> m_modelForActions;
+};
+
+static QPointer<RecentAppActionListCache> s_actionListCache;
+
+static ActionListModel *sharedRecentAppActionList(int actions)
+{
+    if (!s_actionListCache) {
+        s_actionListCache = new RecentAppActionListCache;
+    }
+    return s_actionListCache->modelForActions(actions);
+}
+
 //- RecentAppsModel ------------------------------------------------------------
 RecentAppsModel::RecentAppsModel(const KConfigGroup &group, QObject *parent)
 : QAbstractListModel(parent)
@@ -90,9 +146,21 @@ QVariant RecentAppsModel::data(const QModelIndex &index, int role) const
         return QVariant();
     }
 
-    const QString storageId = m_storageIdList.at(index.row());
-    KService::Ptr service = KService::serviceByStorageId(storageId);
+    return serviceData(serviceAt(index.row()), role);
+}
+
+QVariantList RecentAppsModel::rowData(int first, int count, const QStringList &roleNames) const
+{
+    return RowData::fetch(this, first, count, roleNames, &RecentAppsModel::serviceAt, &RecentAppsModel::serviceData);
+}
+
+KService::Ptr RecentAppsModel::serviceAt(int row) const
+{
+    return KService::serviceByStorageId(m_storageIdList.at(row));
+}
 
+QVariant RecentAppsModel::serviceData(const KService::Ptr &service, int role) const
+{
     if (!service) {
         return QVariant();
     }
@@ -103,63 +171,72 @@ QVariant RecentAppsModel::data(const QModelIndex &index, int role) const
         // at least show the oxygen question-mark, otherwise it looks weird blank.
         return service->icon().isEmpty() ? QLatin1String("unknown") : service->icon();
     } else if (role == FavoriteIdRole) {
-        return QVariant(QString("app:") + storageId);
+        return QVariant(QString("app:") + service->storageId());
     } else if (role == HasActionListRole) {
         return true;
     } else if (role == ActionListRole) {
-        QVariantList actionList;
+        return serviceActionList(service, m_containment);
+    }
 
-        QVariantMap forgetAction = Homerun::ActionList::createActionItem(i18n("Forget Application"), "forget");
-        actionList.append(forgetAction);
+    return QVariant();
+}
 
-        actionList.append(Homerun::ActionList::createSeparatorActionItem());
+QVariant RecentAppsModel::actionList(int row, QObject *containment) const
+{
+    if (row < 0 || row >= m_storageIdList.count()) {
+        return QVariant();
+    }
+    KService::Ptr service = serviceAt(row);
+    return service ? serviceActionList(service, containment) : QVariant();
+}
 
-        if (qApp->property("HomerunViewerAdaptor").isValid())
-        {
-            if (qApp->property("desktopContainmentId").toUInt() > 0
-                && qApp->property("desktopContainmentMutable").toBool()) {
-                actionList << ActionList::createActionItem(i18n("Add to Desktop"), "addToDesktop");
-            }
-            if (qApp->property("appletContainmentId").toUInt() > 0
-                && qApp->property("appletContainmentMutable").toBool()) {
-                actionList << ActionList::createActionItem(i18n("Add to Panel"), "addToPanel");
-            }
-        } else if (m_containment) {
-            Plasma::Containment *containment = static_cast<Plasma::Containment *>(m_containment);
-            Plasma::Containment *desktop = containment->corona()->containmentForScreen(containment->screen());
+QVariant RecentAppsModel::serviceActionList(const KService::Ptr &service, QObject *containmentObject) const
+{
+    int actions = 0;
 
-            if (desktop && desktop->immutability() == Plasma::Mutable) {
-                actionList << ActionList::createActionItem(i18n("Add to Desktop"), "addToDesktop");
-            }
+    if (qApp->property("HomerunViewerAdaptor").isValid())
+    {
+        if (qApp->property("desktopContainmentId").toUInt() > 0
+            && qApp->property("desktopContainmentMutable").toBool()) {
+            actions |= AddToDesktopAction;
+        }
+        if (qApp->property("appletContainmentId").toUInt() > 0
+            && qApp->property("appletContainmentMutable").toBool()) {
+            actions |= AddToPanelAction;
+        }
+    } else if (containmentObject) {
+        Plasma::Containment *containment = static_cast<Plasma::Containment *>(containmentObject);
+        Plasma::Containment *desktop = containment->corona()->containmentForScreen(containment->screen());
 
-            if (containment->immutability() == Plasma::Mutable) {
-                actionList << ActionList::createActionItem(i18n("Add to Panel"), "addToPanel");
-            }
+        if (desktop && desktop->immutability() == Plasma::Mutable) {
+            actions |= AddToDesktopAction;
+        }
 
-            QObject* taskManager = 0;
+        if (containment->immutability() == Plasma::Mutable) {
+            actions |= AddToPanelAction;
+        }
 
-            foreach(QObject* applet, containment->applets()) {
-                if (applet->metaObject()->indexOfSlot("hasLauncher(QString)") != -1) {
-                    taskManager = applet;
-                }
+        QObject* taskManager = 0;
+
+        foreach(QObject* applet, containment->applets()) {
+            if (applet->metaObject()->indexOfSlot("hasLauncher(QString)") != -1) {
+                taskManager = applet;
             }
+        }
 
-            if (taskManager) {
-                bool hasLauncher = false;
+        if (taskManager) {
+            bool hasLauncher = false;
 
-                QMetaObject::invokeMethod(taskManager, "hasLauncher", Qt::DirectConnection,
-                    Q_RETURN_ARG(bool, hasLauncher), Q_ARG(QString, storageId));
+            QMetaObject::invokeMethod(taskManager, "hasLauncher", Qt::DirectConnection,
+                Q_RETURN_ARG(bool, hasLauncher), Q_ARG(QString, service->storageId()));
 
-                if (!hasLauncher) {
-                    actionList << ActionList::createActionItem(i18n("Add as Launcher"), "addLauncher");
-                }
+            if (!hasLauncher) {
+                actions |= AddLauncherAction;
             }
         }
-
-        return actionList;
     }
 
-    return QVariant();
+    return QVariant::fromValue<QObject *>(sharedRecentAppActionList(actions));
 }
 
 void RecentAppsModel::addApp(const QString& storageId, bool sync)
@@ -211,6 +288,11 @@ bool RecentAppsModel::forgetApp(int row, bool sync)
 }
 
 bool RecentAppsModel::trigger(int row, const QString &actionId, const QVariant &actionArgument)
+{
+    return trigger(row, actionId, actionArgument, m_containment);
+}
+
+bool RecentAppsModel::trigger(int row, const QString &actionId, const QVariant &actionArgument, QObject *containmentObject)
 {
     Q_UNUSED(actionArgument)
 
@@ -231,8 +313,8 @@ bool RecentAppsModel::trigger(int row, const QString &actionId, const QVariant &
                     : qApp->property("appletContainmentId").toUInt();
                 return QMetaObject::invokeMethod(adaptor.value<QObject *>(), actionId.toLocal8Bit(),
                     Qt::DirectConnection, Q_ARG(uint, containmentId), Q_ARG(QString, storageId));
-            } else if (m_containment) {
-                Plasma::Containment *containment = static_cast<Plasma::Containment *>(m_containment);
+            } else if (containmentObject) {
+                Plasma::Containment *containment = static_cast<Plasma::Containment *>(containmentObject);
                 KService::Ptr service = KService::serviceByStorageId(storageId);
 
                 if (actionId == "addToDesktop" && service) {
@@ -290,6 +372,67 @@ QString RecentAppsModel::name() const
     return i18n("Recent Applications");
 }
 
+//- RecentAppsModelProxy -----------------------------------------
+RecentAppsModelProxy::RecentAppsModelProxy(RecentAppsModel *model, QObject *parent)
+: QIdentityProxyModel(parent)
+, m_model(model)
+, m_containment(0)
+{
+    setSourceModel(model);
+    setRoleNames(model->roleNames());
+    connect(model, SIGNAL(countChanged()), SIGNAL(countChanged()));
+}
+
+QVariant RecentAppsModelProxy::data(const QModelIndex &index, int role) const
+{
+    if (role == RecentAppsModel::ActionListRole && m_model && index.isValid()) {
+        return m_model->actionList(index.row(), m_containment);
+    }
+    return QIdentityProxyModel::data(index, role);
+}
+
+int RecentAppsModelProxy::count() const
+{
+    return rowCount();
+}
+
+QVariantList RecentAppsModelProxy::rowData(int first, int count, const QStringList &roleNames) const
+{
+    return RowData::fetch(this, first, count, roleNames);
+}
+
+void RecentAppsModelProxy::addApp(const QString &storageId, bool sync)
+{
+    if (m_model) {
+        m_model->addApp(storageId, sync);
+    }
+}
+
+bool RecentAppsModelProxy::forgetApp(int row, bool sync)
+{
+    return m_model ? m_model->forgetApp(row, sync) : false;
+}
+
+bool RecentAppsModelProxy::trigger(int row, const QString &actionId, const QVariant &actionArgument)
+{
+    return m_model ? m_model->trigger(row, actionId, actionArgument, m_containment) : false;
+}
+
+QObject *RecentAppsModelProxy::containment() const
+{
+    return m_containment;
+}
+
+void RecentAppsModelProxy::setContainment(QObject *containment)
+{
+    m_containment = containment;
+}
+
+QString RecentAppsModelProxy::name() const
+{
+    return m_model ? m_model->name() : QString();
+}
+
 //- RecentAppsSource ---------------------------------------------
 RecentAppsSource::RecentAppsSource(QObject *parent)
 : AbstractSource(parent)
@@ -25,9 +25,12 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 
 // Qt
 #include <QAbstractListModel>
+#include <QIdentityProxyModel>
+#include <QPointer>
 
 // KDE
 #include <KConfigGroup>
+#include <KService>
 
 namespace Homerun {
 
@@ -52,11 +55,25 @@ class RecentAppsModel : public QAbstractListModel
         int count() const;
         QVariant data(const QModelIndex &, int) const;
 
+        Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
         Q_INVOKABLE void addApp(const QString &storageId, bool sync = true);
         Q_INVOKABLE bool forgetApp(int row, bool sync = true);
 
         Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
 
+        /**
+         * Triggers @p row on behalf of a view whose containment is
+         * @p containment, see RecentAppsModelProxy
+         */
+        bool trigger(int row, const QString &actionId, const QVariant &actionArgument, QObject *containment);
+
+        /**
+         * Returns the ActionListRole data of @p row for a view whose
+         * containment is @p containment
+         */
+        QVariant actionList(int row, QObject *containment) const;
+
         QObject *containment() const;
         void setContainment(QObject *containment);
 
@@ -66,12 +83,53 @@ class RecentAppsModel : public QAbstractListModel
         void countChanged();
 
     private:
+        KService::Ptr serviceAt(int row) const;
+        QVariant serviceData(const KService::Ptr &service, int role) const;
+        QVariant serviceActionList(const KService::Ptr &service, QObject *containment) const;
+
         QList<QString> m_storageIdList;
         KConfigGroup m_configGroup;
 
         QObject *m_containment;
 };
 
+/**
+ * The view of one RecentAppsModel shared between several views. It holds the
+ * state of its view: its containment.
+ */
+class RecentAppsModelProxy : public QIdentityProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(QObject* containment READ containment WRITE setContainment)
+
+    public:
+        explicit RecentAppsModelProxy(RecentAppsModel *model, QObject *parent = 0);
+
+        QVariant data(const QModelIndex &index, int role) const; // reimp
+        int count() const;
+
+        Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
+        Q_INVOKABLE void addApp(const QString &storageId, bool sync = true);
+        Q_INVOKABLE bool forgetApp(int row, bool sync = true);
+
+        Q_INVOKABLE bool trigger(int row, const QString &actionId = QString(), const QVariant &actionArgument = QVariant());
+
+        QObject *containment() const;
+        void setContainment(QObject *containment);
+
+        QString name() const;
+
+    Q_SIGNALS:
+        void countChanged();
+
+    private:
+        QPointer<RecentAppsModel> m_model;
+        QObject *m_containment;
+};
+
 class RecentAppsSource : public AbstractSource
 {
 public:
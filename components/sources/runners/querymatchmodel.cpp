@@ -21,11 +21,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <querymatchmodel.h>
 
 // Local
-#include <actionlist.h>
+#include <actionlistmodel.h>
+#include <rowdata.h>
 
 // KDE
 #include <KDebug>
-#include <KIcon>
 #include <KLocale>
 #include <KUrl>
 #include <Plasma/AbstractRunner>
@@ -93,25 +93,26 @@ static bool matchHasActionList(const Plasma::QueryMatch &match)
     return !runner->actions().isEmpty();
 }
 
-static QVariantList actionListFromMatch(Plasma::RunnerManager *manager, const Plasma::QueryMatch &match)
-{
-    Q_ASSERT(manager);
-    QVariantList actionList;
-    Q_FOREACH(QAction *action, manager->actionsForMatch(match)) {
-        QVariantMap item = ActionList::createActionItem(action->text(), "runnerAction",
-            QVariant::fromValue<QObject *>(action));
-        item["icon"] = KIcon(action->icon());
-        actionList << item;
-    }
-    return actionList;
-}
-
 QVariant QueryMatchModel::data(const QModelIndex& index, int role) const
 {
     if (index.row() < 0 || index.row() >= m_matches.count()) {
         return QVariant();
     }
-    Plasma::QueryMatch match = m_matches.at(index.row());
+    return matchData(m_matches.at(index.row()), role);
+}
+
+QVariantList QueryMatchModel::rowData(int first, int count, const QStringList &roleNames) const
+{
+    return RowData::fetch(this, first, count, roleNames, &QueryMatchModel::matchAt, &QueryMatchModel::matchData);
+}
+
+Plasma::QueryMatch QueryMatchModel::matchAt(int row) const
+{
+    return m_matches.at(row);
+}
+
+QVariant QueryMatchModel::matchData(const Plasma::QueryMatch &match, int role) const
+{
     if (role == Qt::DisplayRole) {
         return match.text();
     } else if (role == Qt::DecorationRole) {
@@ -121,11 +122,49 @@ QVariant QueryMatchModel::data(const QModelIndex& index, int role) const
     } else if (role == HasActionListRole) {
         return matchHasActionList(match);
     } else if (role == ActionListRole) {
-        return actionListFromMatch(m_manager, match);
+        return QVariant::fromValue<QObject *>(actionListModelForMatch(match));
     }
     return QVariant();
 }
 
+ActionListModel *QueryMatchModel::actionListModelForMatch(const Plasma::QueryMatch &match) const
+{
+    Q_ASSERT(m_manager);
+    const QList<QAction *> actions = m_manager->actionsForMatch(match);
+    QString key;
+    Q_FOREACH(QAction *action, actions) {
+        key += QString::number(quintptr(action), 16) + ':' + action->text() + '\n';
+    }
+    ActionListModel *model = m_actionListModels.value(key);
+    if (model) {
+        return model;
+    }
+
+    QueryMatchModel *that = const_cast<QueryMatchModel *>(this);
+    model = new ActionListModel(that);
+    Q_FOREACH(QAction *action, actions) {
+        model->addAction(action->text(), "runnerAction", QVariant::fromValue<QObject *>(action), action->icon());
+        if (!m_actionListKeysForAction.contains(action)) {
+            connect(action, SIGNAL(destroyed(QObject *)), that, SLOT(slotActionDestroyed(QObject *)));
+        }
+        m_actionListKeysForAction.insert(action, key);
+    }
+    m_actionListModels.insert(key, model);
+    return model;
+}
+
+void QueryMatchModel::slotActionDestroyed(QObject *action)
+{
+    // Menus may still hold the models: empty them rather than deleting them
+    Q_FOREACH(const QString &key, m_actionListKeysForAction.values(action)) {
+        ActionListModel *model = m_actionListModels.take(key);
+        if (model) {
+            model->clear();
+        }
+    }
+    m_actionListKeysForAction.remove(action);
+}
+
 bool QueryMatchModel::trigger(int row, const QString &actionId, const QVariant &actionArgument)
 {
     Q_ASSERT(m_manager);
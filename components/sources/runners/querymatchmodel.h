@@ -27,6 +27,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // Qt
 #include <QAbstractListModel>
+#include <QHash>
 
 namespace Plasma
 {
@@ -36,6 +37,8 @@ namespace Plasma
 namespace Homerun
 {
 
+class ActionListModel;
+
 /**
  * This model exposes results from a list of Plasma::QueryMatch
  */
@@ -58,6 +61,8 @@ public:
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+    Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
     Q_INVOKABLE bool trigger(int row, const QString &actionId, const QVariant &actionArgument);
 
     /**
@@ -72,11 +77,23 @@ public Q_SLOTS:
 Q_SIGNALS:
     void countChanged();
 
+private Q_SLOTS:
+    void slotActionDestroyed(QObject *action);
+
 protected:
     QList<Plasma::QueryMatch> m_matches;
 
 private:
     Plasma::RunnerManager *m_manager = 0;
+
+    // Matches from the same runner usually get the same actions: they share
+    // one ActionListModel, keyed by the actions and their texts
+    mutable QHash<QString, ActionListModel *> m_actionListModels;
+    mutable QMultiHash<QObject *, QString> m_actionListKeysForAction;
+
+    Plasma::QueryMatch matchAt(int row) const;
+    QVariant matchData(const Plasma::QueryMatch &match, int role) const;
+    ActionListModel *actionListModelForMatch(const Plasma::QueryMatch &match) const;
 };
 
 } // namespace
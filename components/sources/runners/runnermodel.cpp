@@ -26,6 +26,9 @@ Boston, MA 02110-1301, USA.
 // Local
 #include <runnerconfigurationwidget.h>
 
+// libhomerun
+#include <trace.h>
+
 // KDE
 #include <KDebug>
 #include <KPluginInfo>
@@ -56,6 +59,7 @@ RunnerModel::RunnerModel(const KConfigGroup &configGroup, QObject *parent)
 , m_startQueryTimer(new QTimer(this))
 , m_runningChangedTimeout(new QTimer(this))
 , m_running(false)
+, m_queryStartTime(-1)
 {
     m_startQueryTimer->setSingleShot(true);
     m_startQueryTimer->setInterval(10);
@@ -155,6 +159,7 @@ void RunnerModel::startQuery()
         kWarning() << "-" << runner->name();
     }
     */
+    m_queryStartTime = Trace::now();
     m_manager->launchQuery(m_pendingQuery);
     emit queryChanged();
     m_running = true;
@@ -164,6 +169,7 @@ void RunnerModel::startQuery()
 void RunnerModel::createManager()
 {
     if (!m_manager) {
+        TraceSpan span("RunnerModel::createManager");
         // RunnerManager must have its own config group to store instance-specific config
         // (we don't want the manager from this RunnerModel to overwrite the config from another RunnerModel manager)
         m_manager = new Plasma::RunnerManager(m_configGroup, this);
@@ -229,6 +235,10 @@ void RunnerModel::matchesChanged(const QList<Plasma::QueryMatch> &matches)
 
 void RunnerModel::queryHasFinished()
 {
+    if (m_queryStartTime >= 0) {
+        Trace::addSpan("RunnerModel query", m_queryStartTime, currentQuery());
+        m_queryStartTime = -1;
+    }
     m_running = false;
     emit runningChanged(false);
 }
@@ -247,6 +257,7 @@ void RunnerModel::clear()
 void RunnerModel::loadRunners()
 {
     Q_ASSERT(m_manager);
+    TraceSpan span("RunnerModel::loadRunners");
 
     // FIXME: SC 4.13 replaced Nepomuk with Baloo for desktop search. Homerun's
     // default configs reference Nepomuk's "nepomuksearch" runner. The following
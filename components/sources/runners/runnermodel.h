@@ -117,6 +117,8 @@ private:
     QStringList m_pendingRunnersList;
     bool m_running;
     QString m_pendingQuery;
+    // Used to trace queries, -1 when not tracing or no query is running
+    qint64 m_queryStartTime;
 };
 
 class RunnerSource : public AbstractSource
@@ -27,63 +27,149 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KLocale>
 
 // Qt
-#include <QTimer>
+#include <QSet>
 
 namespace Homerun
 {
 
-class SwitchSessionItem : public StandardItem
+OpenedSessionsModel::OpenedSessionsModel(QObject *parent)
+: QAbstractListModel(parent)
+, m_watcher(new SessionsWatcher(this))
 {
-public:
-    SwitchSessionItem(KDisplayManager *manager, const SessEnt &session)
-    : m_displayManager(manager)
-    , m_vt(session.vt)
-    {
-        QString user, location;
-        KDisplayManager::sess2Str2(session, user, location);
-        setText(user + QString(" (Ctrl+Alt+F%1)").arg(session.vt));
-        if (session.user.isEmpty() && session.session.isEmpty()) {
-            setIconName("preferences-system-login");
-        } else {
-            setIconName("user-identity");
-        }
-    }
+    init();
+}
 
-    bool trigger(const QString &/*actionId*/, const QVariant &/*actionArgument*/) override
-    {
-        m_displayManager->lockSwitchVT(m_vt);
-        return true;
-    }
+OpenedSessionsModel::OpenedSessionsModel(SessionsWatcher *watcher, QObject *parent)
+: QAbstractListModel(parent)
+, m_watcher(watcher)
+{
+    m_watcher->setParent(this);
+    init();
+}
 
-private:
-    KDisplayManager *m_displayManager;
-    int m_vt;
-};
+OpenedSessionsModel::~OpenedSessionsModel()
+{
+}
 
-OpenedSessionsModel::OpenedSessionsModel(QObject *parent)
-: StandardItemModel(parent)
-, m_watcher(new SessionsWatcher(this))
+void OpenedSessionsModel::init()
 {
-    setName(i18n("Opened Sessions"));
+    QHash<int, QByteArray> roles;
+    roles.insert(Qt::DisplayRole, "display");
+    roles.insert(Qt::DecorationRole, "decoration");
+    setRoleNames(roles);
+
     connect(m_watcher, SIGNAL(sessionsChanged()), SLOT(refresh()));
+    connect(this, SIGNAL(rowsInserted(QModelIndex,int,int)), SIGNAL(countChanged()));
+    connect(this, SIGNAL(rowsRemoved(QModelIndex,int,int)), SIGNAL(countChanged()));
 }
 
-OpenedSessionsModel::~OpenedSessionsModel()
+QString OpenedSessionsModel::name() const
 {
+    return i18n("Opened Sessions");
 }
 
-void OpenedSessionsModel::refresh()
+int OpenedSessionsModel::count() const
 {
-    clear();
+    return m_items.count();
+}
 
-    SessList sessions = m_watcher->sessions();
+int OpenedSessionsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_items.count();
+}
 
-    Q_FOREACH(const SessEnt &session, sessions) {
+QVariant OpenedSessionsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_items.count()) {
+        return QVariant();
+    }
+    const SessionItem &item = m_items.at(index.row());
+    if (role == Qt::DisplayRole) {
+        if (item.text.isNull()) {
+            QString user, location;
+            KDisplayManager::sess2Str2(item.session, user, location);
+            item.text = user + QString(" (Ctrl+Alt+F%1)").arg(item.session.vt);
+        }
+        return item.text;
+    } else if (role == Qt::DecorationRole) {
+        if (item.session.user.isEmpty() && item.session.session.isEmpty()) {
+            return QString("preferences-system-login");
+        } else {
+            return QString("user-identity");
+        }
+    }
+    return QVariant();
+}
+
+bool OpenedSessionsModel::trigger(int row, const QString &/*actionId*/, const QVariant &/*actionArgument*/)
+{
+    if (row < 0 || row >= m_items.count()) {
+        return false;
+    }
+    m_displayManager.lockSwitchVT(m_items.at(row).session.vt);
+    return true;
+}
+
+void OpenedSessionsModel::updateRow(int row, const SessEnt &session)
+{
+    SessionItem &item = m_items[row];
+    if (SessionsWatcher::sameSession(item.session, session)) {
+        return;
+    }
+    item.session = session;
+    item.text.clear();
+    QModelIndex idx = index(row, 0);
+    dataChanged(idx, idx);
+}
+
+void OpenedSessionsModel::refresh()
+{
+    // Sessions are identified by their VT. Only rows whose session appeared,
+    // disappeared, moved or changed are touched, so that delegates of other
+    // sessions are kept.
+    QList<SessEnt> sessions;
+    QSet<int> vts;
+    Q_FOREACH(const SessEnt &session, m_watcher->sessions()) {
         if (!session.vt || session.self) {
             continue;
         }
+        sessions << session;
+        vts << session.vt;
+    }
+
+    for (int row = m_items.count() - 1; row >= 0; --row) {
+        if (!vts.contains(m_items.at(row).session.vt)) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_items.removeAt(row);
+            endRemoveRows();
+        }
+    }
 
-        appendRow(new SwitchSessionItem(&m_displayManager, session));
+    for (int row = 0; row < sessions.count(); ++row) {
+        const SessEnt &session = sessions.at(row);
+        if (row < m_items.count() && m_items.at(row).session.vt == session.vt) {
+            updateRow(row, session);
+            continue;
+        }
+        int oldRow = row + 1;
+        for (; oldRow < m_items.count(); ++oldRow) {
+            if (m_items.at(oldRow).session.vt == session.vt) {
+                break;
+            }
+        }
+        if (oldRow < m_items.count()) {
+            // Session order changed
+            beginMoveRows(QModelIndex(), oldRow, oldRow, QModelIndex(), row);
+            m_items.move(oldRow, row);
+            endMoveRows();
+            updateRow(row, session);
+        } else {
+            SessionItem item;
+            item.session = session;
+            beginInsertRows(QModelIndex(), row, row);
+            m_items.insert(row, item);
+            endInsertRows();
+        }
     }
 }
 
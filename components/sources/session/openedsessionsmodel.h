@@ -21,9 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define OPENEDSESSIONSMODEL_H
 
 // Local
-#include <standarditemmodel.h>
 
 // Qt
+#include <QAbstractListModel>
 
 // KDE
 #include <kworkspace/kdisplaymanager.h>
@@ -33,16 +33,52 @@ class SessionsWatcher;
 namespace Homerun
 {
 
-class OpenedSessionsModel : public StandardItemModel
+/**
+ * Lists the sessions opened on other VTs, triggering a row switches to its
+ * session
+ */
+class OpenedSessionsModel : public QAbstractListModel
 {
     Q_OBJECT
+    Q_PROPERTY(QString name READ name CONSTANT)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
 public:
     explicit OpenedSessionsModel(QObject *parent = 0);
+
+    /**
+     * Lists the sessions of @p watcher, which the model takes ownership of.
+     * Used by tests.
+     */
+    explicit OpenedSessionsModel(SessionsWatcher *watcher, QObject *parent = 0);
+
     ~OpenedSessionsModel();
 
+    QString name() const;
+    int count() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+    Q_INVOKABLE bool trigger(int row, const QString &actionId, const QVariant &actionArgument);
+
+Q_SIGNALS:
+    void countChanged();
+
 private:
+    struct SessionItem
+    {
+        SessEnt session;
+        // Formatted on first display, for sessions which are shown
+        mutable QString text;
+    };
+
     KDisplayManager m_displayManager;
     SessionsWatcher *m_watcher;
+    QList<SessionItem> m_items;
+
+    void init();
+    void updateRow(int row, const SessEnt &session);
 
 private Q_SLOTS:
     void refresh();
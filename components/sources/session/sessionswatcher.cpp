@@ -23,32 +23,113 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Local
 
 // KDE
+#include <KDebug>
 
 // Qt
+#include <QDBusConnectionInterface>
+#include <QDBusServiceWatcher>
 #include <QTimer>
 
+static const char *LOGIND_SERVICE = "org.freedesktop.login1";
+static const char *LOGIND_PATH = "/org/freedesktop/login1";
+static const char *LOGIND_INTERFACE = "org.freedesktop.login1.Manager";
+
 /*
- * Polling sucks, but I don't know a better way given the wild jungle of
- * display managers available. Let's poll only every 30 seconds to avoid
+ * Polling sucks, but it is the only way to support the wild jungle of display
+ * managers when logind is not there. Let's poll only every 30 seconds to avoid
  * draining batteries.
- * Eventually support for being notified about session changes should be
- * implemented at least for consolekit and systemd-logind
  */
 static const int POLL_INTERVAL = 30 * 1000;
 
+/*
+ * Logind may notify us before the display manager knows about the session,
+ * and sessions often come and go in bursts: wait a bit before listing them.
+ */
+static const int CHECK_DELAY = 500;
+
 SessionsWatcher::SessionsWatcher(QObject *parent)
 : QObject(parent)
+, m_bus(QDBusConnection::systemBus())
 {
-    QTimer *timer = new QTimer(this);
-    timer->setInterval(POLL_INTERVAL);
-    connect(timer, SIGNAL(timeout()), SLOT(checkSessions()));
-    timer->start();
+    init();
+}
+
+SessionsWatcher::SessionsWatcher(const QDBusConnection &bus, QObject *parent)
+: QObject(parent)
+, m_bus(bus)
+{
+    init();
+}
+
+void SessionsWatcher::init()
+{
+    m_pollTimer = new QTimer(this);
+    m_pollTimer->setInterval(POLL_INTERVAL);
+    connect(m_pollTimer, SIGNAL(timeout()), SLOT(checkSessions()));
+
+    m_checkTimer = new QTimer(this);
+    m_checkTimer->setInterval(CHECK_DELAY);
+    m_checkTimer->setSingleShot(true);
+    connect(m_checkTimer, SIGNAL(timeout()), SLOT(checkSessions()));
+
+    QDBusConnectionInterface *interface = m_bus.isConnected() ? m_bus.interface() : 0;
+    if (interface) {
+        QDBusServiceWatcher *watcher = new QDBusServiceWatcher(LOGIND_SERVICE, m_bus,
+            QDBusServiceWatcher::WatchForOwnerChange, this);
+        connect(watcher, SIGNAL(serviceRegistered(QString)), SLOT(slotLogindRegistered()));
+        connect(watcher, SIGNAL(serviceUnregistered(QString)), SLOT(slotLogindUnregistered()));
+        connectToLogind();
+    }
+
+    if (interface && interface->isServiceRegistered(LOGIND_SERVICE)) {
+        kDebug() << "Using logind to track sessions";
+    } else {
+        kDebug() << "logind is not available, polling sessions";
+        m_pollTimer->start();
+    }
 
     QMetaObject::invokeMethod(this, "checkSessions", Qt::QueuedConnection);
 }
 
-// SessEnt has no operator==() :/
-inline bool sameSession(const SessEnt &s1, const SessEnt &s2)
+void SessionsWatcher::connectToLogind()
+{
+    // The service name is resolved by QtDBus, so the connections remain
+    // valid if logind is restarted
+    m_bus.connect(LOGIND_SERVICE, LOGIND_PATH, LOGIND_INTERFACE, "SessionNew",
+        this, SLOT(scheduleCheckSessions()));
+    m_bus.connect(LOGIND_SERVICE, LOGIND_PATH, LOGIND_INTERFACE, "SessionRemoved",
+        this, SLOT(scheduleCheckSessions()));
+}
+
+void SessionsWatcher::slotLogindRegistered()
+{
+    kDebug() << "logind appeared, stop polling sessions";
+    m_pollTimer->stop();
+    scheduleCheckSessions();
+}
+
+void SessionsWatcher::slotLogindUnregistered()
+{
+    kDebug() << "logind disappeared, polling sessions";
+    m_pollTimer->start();
+}
+
+bool SessionsWatcher::isPolling() const
+{
+    return m_pollTimer->isActive();
+}
+
+void SessionsWatcher::scheduleCheckSessions()
+{
+    m_checkTimer->start();
+}
+
+void SessionsWatcher::listSessions(SessList &sessions)
+{
+    m_displayManager.localSessions(sessions);
+}
+
+bool SessionsWatcher::sameSession(const SessEnt &s1, const SessEnt &s2)
 {
 #define CHECK_FIELD(f) if (s1.f != s2.f) { return false; }
     CHECK_FIELD(display)
@@ -65,7 +146,7 @@ inline bool sameSession(const SessEnt &s1, const SessEnt &s2)
 void SessionsWatcher::checkSessions()
 {
     SessList newSessions;
-    m_displayManager.localSessions(newSessions);
+    listSessions(newSessions);
     if (m_sessions.count() != newSessions.count()) {
         m_sessions = newSessions;
         sessionsChanged();
@@ -23,13 +23,19 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Local
 
 // Qt
+#include <QDBusConnection>
 #include <QObject>
 
 // KDE
 #include <kworkspace/kdisplaymanager.h>
 
+class QTimer;
+
 /**
  * Watch sessions, emit a signal when a session is opened or closed
+ *
+ * When systemd-logind is available on the bus, sessions are listed again each
+ * time it reports a new or removed session. Otherwise sessions are polled.
  */
 class SessionsWatcher : public QObject
 {
@@ -37,17 +43,48 @@ class SessionsWatcher : public QObject
 public:
     explicit SessionsWatcher(QObject *parent = 0);
 
+    /**
+     * Listens to logind on @p bus instead of the system bus. Used by tests.
+     */
+    SessionsWatcher(const QDBusConnection &bus, QObject *parent = 0);
+
     SessList sessions() const;
 
+    /**
+     * True if logind is not available and sessions are polled
+     */
+    bool isPolling() const;
+
+    /**
+     * SessEnt has no operator==()
+     */
+    static bool sameSession(const SessEnt &s1, const SessEnt &s2);
+
 Q_SIGNALS:
     void sessionsChanged();
 
+protected:
+    /**
+     * Fills @p sessions with the current sessions. The default implementation
+     * asks the display manager.
+     */
+    virtual void listSessions(SessList &sessions);
+
 private Q_SLOTS:
     void checkSessions();
+    void scheduleCheckSessions();
+    void slotLogindRegistered();
+    void slotLogindUnregistered();
 
 private:
     KDisplayManager m_displayManager;
     SessList m_sessions;
+    QDBusConnection m_bus;
+    QTimer *m_pollTimer;
+    QTimer *m_checkTimer;
+
+    void init();
+    void connectToLogind();
 };
 
 #endif /* SESSIONSWATCHER_H */
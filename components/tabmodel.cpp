@@ -29,6 +29,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <QFile>
 
 // Local
+#include <configtransaction.h>
 #include <sourcemodel.h>
 #include <sourceregistry.h>
 
@@ -65,7 +66,6 @@ public:
         }
         m_name = value;
         saveName();
-        m_group.sync();
         return true;
     }
 
@@ -76,7 +76,6 @@ public:
         }
         m_iconName = value;
         saveIconName();
-        m_group.sync();
         return true;
     }
 
@@ -96,7 +95,6 @@ public:
         m_group.writeEntry("deleted", false);
         saveName();
         saveIconName();
-        m_group.sync();
     }
 
     static Tab *createFromGroup(const KConfigGroup &group, TabModel *tabModel)
@@ -122,7 +120,6 @@ public:
     {
         m_group.deleteGroup();
         m_group.writeEntry("deleted", true);
-        m_group.sync();
     }
 };
 
@@ -195,6 +192,7 @@ static void copyGroup(const KConfigGroup &dst_, const KConfigGroup &src)
 
 void TabModel::resetConfig()
 {
+    ConfigTransaction transaction(m_config);
     KConfigGroup generalGroup = m_config->group(GENERAL_GROUP);
     generalGroup.revertToDefault(GENERAL_TABS_KEY);
 
@@ -214,7 +212,7 @@ void TabModel::resetConfig()
             m_config->deleteGroup(groupName);
         }
     }
-    m_config->sync();
+    transaction.commit();
 
     setConfig(m_config);
 }
@@ -256,6 +254,12 @@ int TabModel::rowCount(const QModelIndex &parent) const
     return m_tabList.count();
 }
 
+SourceModel *TabModel::sourceModelForRow(int row) const
+{
+    Tab *tab = m_tabList.value(row);
+    return tab ? tab->m_sourceModel : 0;
+}
+
 QVariant TabModel::data(const QModelIndex &index, int role) const
 {
     Tab *tab = m_tabList.value(index.row());
@@ -283,6 +287,7 @@ void TabModel::setDataForRow(int row, const QByteArray &roleName, const QVariant
         return;
     }
 
+    ConfigTransaction transaction(m_config);
     if (roleName == "display") {
         if (!tab->setName(value.toString())) {
             return;
@@ -315,6 +320,7 @@ void TabModel::appendRow()
         }
     }
 
+    ConfigTransaction transaction(m_config);
     KConfigGroup tabGroup = m_config->group(QLatin1String(TAB_GROUP_PREFIX) + QString::number(lastId + 1));
     Tab *tab = Tab::createFromGroup(tabGroup, this);
 
@@ -336,6 +342,7 @@ void TabModel::appendRow()
 void TabModel::removeRow(int row)
 {
     CHECK_ROW(row)
+    ConfigTransaction transaction(m_config);
     beginRemoveRows(QModelIndex(), row, row);
     Tab *tab = m_tabList.takeAt(row);
     Q_ASSERT(tab);
@@ -355,6 +362,7 @@ void TabModel::moveRow(int from, int to)
     }
     // See beginMoveRows() doc for an explanation on modelTo
     int modelTo = to + (to > from ? 1 : 0);
+    ConfigTransaction transaction(m_config);
     beginMoveRows(QModelIndex(), from, from, QModelIndex(), modelTo);
     m_tabList.move(from, to);
     writeGeneralTabsEntry();
@@ -369,7 +377,6 @@ void TabModel::writeGeneralTabsEntry()
     }
     KConfigGroup group(m_config, GENERAL_GROUP);
     group.writeEntry(GENERAL_TABS_KEY, lst);
-    m_config->sync();
 }
 
 #include "tabmodel.moc"
@@ -27,6 +27,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 namespace Homerun {
 class AbstractSourceRegistry;
 }
+class SourceModel;
 class Tab;
 
 /**
@@ -57,6 +58,8 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
 
+    SourceModel *sourceModelForRow(int row) const;
+
     Q_INVOKABLE void setDataForRow(int row, const QByteArray &role, const QVariant &value);
 
     Q_INVOKABLE void appendRow();
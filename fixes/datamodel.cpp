@@ -28,6 +28,7 @@ namespace Plasma
 
 SortFilterModel::SortFilterModel(QObject* parent)
     : QSortFilterProxyModel(parent)
+    , m_filterMode(RegExpFilter)
 {
     setObjectName("SortFilterModel");
     setDynamicSortFilter(true);
@@ -54,6 +55,7 @@ void SortFilterModel::syncRoleNames()
     }
     setFilterRole(m_filterRole);
     setSortRole(m_sortRole);
+    resetTextFilter();
 }
 
 int SortFilterModel::roleNameToId(const QString &name)
@@ -85,8 +87,25 @@ void SortFilterModel::setModel(QObject *source)
             this, SLOT(onRowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)));
         disconnect(sourceModel(), SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
             this, SLOT(onRowsMoved(QModelIndex,int,int,QModelIndex,int)));
+        disconnect(sourceModel(), 0, this, SLOT(onSourceRowsInserted(QModelIndex,int,int)));
+        disconnect(sourceModel(), 0, this, SLOT(onSourceRowsRemoved(QModelIndex,int,int)));
+        disconnect(sourceModel(), 0, this, SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+        disconnect(sourceModel(), 0, this, SLOT(resetTextFilter()));
     }
     if (model) {
+        // Keep m_textFilter in sync with the source model. This must be done
+        // before calling setSourceModel() so that our slots are called before
+        // QSortFilterProxyModel ones, which call filterAcceptsRow().
+        connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)),
+            this, SLOT(onSourceRowsInserted(QModelIndex,int,int)));
+        connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)),
+            this, SLOT(onSourceRowsRemoved(QModelIndex,int,int)));
+        connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex)),
+            this, SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+        connect(model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)),
+            this, SLOT(resetTextFilter()));
+        connect(model, SIGNAL(layoutChanged()), this, SLOT(resetTextFilter()));
+        // syncRoleNames() takes care of resetting m_textFilter on modelReset()
         connect(model, SIGNAL(modelReset()), this, SLOT(syncRoleNames()));
         connect(model, SIGNAL(rowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)),
             this, SLOT(onRowsAboutToBeMoved(QModelIndex,int,int,QModelIndex,int)));
@@ -94,6 +113,10 @@ void SortFilterModel::setModel(QObject *source)
             this, SLOT(onRowsMoved(QModelIndex,int,int,QModelIndex,int)));
     }
     QSortFilterProxyModel::setSourceModel(model);
+    if (isTextFilterMode()) {
+        resetTextFilter();
+        invalidateFilter();
+    }
     sourceModelChanged(model);
 }
 
@@ -105,12 +128,22 @@ void SortFilterModel::setFilterRegExp(const QString &exp)
     if (exp == filterRegExp()) {
         return;
     }
-    QSortFilterProxyModel::setFilterRegExp(QRegExp(exp, Qt::CaseInsensitive));
+    if (isTextFilterMode()) {
+        // The filter only rechecks the rows it accepted if exp extends the
+        // previous text, and filterAcceptsRow() is a lookup
+        m_textFilter.setQuery(exp);
+        invalidateFilter();
+    } else {
+        QSortFilterProxyModel::setFilterRegExp(QRegExp(exp, Qt::CaseInsensitive));
+    }
     filterRegExpChanged(exp);
 }
 
 QString SortFilterModel::filterRegExp() const
 {
+    if (isTextFilterMode()) {
+        return m_textFilter.query();
+    }
     return QSortFilterProxyModel::filterRegExp().pattern();
 }
 
@@ -118,6 +151,10 @@ void SortFilterModel::setFilterRole(const QString &role)
 {
     QSortFilterProxyModel::setFilterRole(roleNameToId(role));
     m_filterRole = role;
+    if (isTextFilterMode()) {
+        resetTextFilter();
+        invalidateFilter();
+    }
 }
 
 QString SortFilterModel::filterRole() const
@@ -125,6 +162,107 @@ QString SortFilterModel::filterRole() const
     return m_filterRole;
 }
 
+void SortFilterModel::setFilterMode(SortFilterModel::FilterMode mode)
+{
+    if (m_filterMode == mode) {
+        return;
+    }
+    const QString exp = filterRegExp();
+    m_filterMode = mode;
+    if (isTextFilterMode()) {
+        QSortFilterProxyModel::setFilterRegExp(QRegExp());
+        m_textFilter.setMode(textFilterModeFor(mode));
+        m_textFilter.setQuery(exp);
+        resetTextFilter();
+        invalidateFilter();
+    } else {
+        m_textFilter.clear();
+        m_textFilter.setQuery(QString());
+        QSortFilterProxyModel::setFilterRegExp(QRegExp(exp, Qt::CaseInsensitive));
+    }
+    filterModeChanged();
+}
+
+SortFilterModel::FilterMode SortFilterModel::filterMode() const
+{
+    return m_filterMode;
+}
+
+HomerunInternal::TextFilter::Mode SortFilterModel::textFilterModeFor(SortFilterModel::FilterMode mode)
+{
+    switch (mode) {
+    case PrefixFilter:
+        return HomerunInternal::TextFilter::PrefixMode;
+    case FuzzyFilter:
+        return HomerunInternal::TextFilter::FuzzyMode;
+    case LiteralFilter:
+    case RegExpFilter:
+        break;
+    }
+    return HomerunInternal::TextFilter::LiteralMode;
+}
+
+bool SortFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (!isTextFilterMode()) {
+        return QSortFilterProxyModel::filterAcceptsRow(sourceRow, sourceParent);
+    }
+    if (sourceParent.isValid()) {
+        // Keys are only kept for top-level rows
+        return true;
+    }
+    return m_textFilter.isAccepted(sourceRow);
+}
+
+QString SortFilterModel::filterTextForRow(int row) const
+{
+    return sourceModel()->index(row, 0).data(QSortFilterProxyModel::filterRole()).toString();
+}
+
+void SortFilterModel::onSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (!isTextFilterMode() || parent.isValid()) {
+        return;
+    }
+    QStringList texts;
+    for (int row = first; row <= last; ++row) {
+        texts << filterTextForRow(row);
+    }
+    m_textFilter.insertTexts(first, texts);
+}
+
+void SortFilterModel::onSourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!isTextFilterMode() || parent.isValid()) {
+        return;
+    }
+    m_textFilter.removeRows(first, last);
+}
+
+void SortFilterModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!isTextFilterMode() || topLeft.parent().isValid()) {
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        m_textFilter.updateText(row, filterTextForRow(row));
+    }
+}
+
+void SortFilterModel::resetTextFilter()
+{
+    if (!isTextFilterMode()) {
+        return;
+    }
+    QStringList texts;
+    if (sourceModel()) {
+        for (int row = 0, count = sourceModel()->rowCount(); row < count; ++row) {
+            texts << filterTextForRow(row);
+        }
+    }
+    m_textFilter.setTexts(texts);
+}
+
 void SortFilterModel::setSortRole(const QString &role)
 {
     if (m_sortRole == role) {
@@ -168,6 +306,51 @@ int SortFilterModel::mapRowToSource(int row) const
     return mapToSource(idx).row();
 }
 
+QVariantList SortFilterModel::rowData(int first, int count, const QStringList &roleNames) const
+{
+    QVariantList rows;
+    QAbstractItemModel *source = sourceModel();
+    if (!source) {
+        return rows;
+    }
+    const bool sourceHasRowData = source->metaObject()->indexOfMethod("rowData(int,int,QStringList)") != -1;
+    const QHash<int, QByteArray> roles = this->roleNames();
+    const int end = qMin(first + count, rowCount());
+    int row = qMax(first, 0);
+    while (row < end) {
+        // Find the run of rows which follow each other in the source model
+        const int sourceFirst = mapRowToSource(row);
+        int runCount = 1;
+        while (row + runCount < end && mapRowToSource(row + runCount) == sourceFirst + runCount) {
+            ++runCount;
+        }
+
+        if (sourceHasRowData) {
+            QVariantList sourceRows;
+            QMetaObject::invokeMethod(source, "rowData",
+                Q_RETURN_ARG(QVariantList, sourceRows),
+                Q_ARG(int, sourceFirst),
+                Q_ARG(int, runCount),
+                Q_ARG(QStringList, roleNames));
+            rows += sourceRows;
+        } else {
+            for (int idx = row; idx < row + runCount; ++idx) {
+                const QModelIndex index = this->index(idx, 0);
+                QVariantMap map;
+                Q_FOREACH(const QString &name, roleNames) {
+                    const int role = roles.key(name.toUtf8(), -1);
+                    if (role != -1) {
+                        map.insert(name, data(index, role));
+                    }
+                }
+                rows << map;
+            }
+        }
+        row += runCount;
+    }
+    return rows;
+}
+
 int SortFilterModel::mapRowFromSource(int row) const
 {
     if (!sourceModel()) {
@@ -22,6 +22,8 @@
 
 #include <QSortFilterProxyModel>
 
+#include <textfilter.h>
+
 class QTimer;
 
 namespace Plasma
@@ -33,6 +35,7 @@ class DataModel;
 class SortFilterModel : public QSortFilterProxyModel
 {
     Q_OBJECT
+    Q_ENUMS(FilterMode)
     /**
      * The source model of this sorting proxy model. It has to inherit QAbstractItemModel (ListModel is not supported)
      */
@@ -48,6 +51,13 @@ class SortFilterModel : public QSortFilterProxyModel
      */
     Q_PROPERTY(QString filterRole READ filterRole WRITE setFilterRole)
 
+    /**
+     * How filterRegExp is interpreted. Defaults to RegExpFilter.
+     * Other modes treat filterRegExp as plain text and do not need to rescan
+     * all rows when the text is extended.
+     */
+    Q_PROPERTY(FilterMode filterMode READ filterMode WRITE setFilterMode NOTIFY filterModeChanged)
+
     /**
      * The role of the sourceModel that will be used for sorting. if empty the order will be left unaltered
      */
@@ -66,6 +76,17 @@ class SortFilterModel : public QSortFilterProxyModel
     friend class DataModel;
 
 public:
+    enum FilterMode {
+        /// filterRegExp is a case-insensitive regular expression
+        RegExpFilter,
+        /// filterRegExp must appear anywhere in the text, case-insensitive
+        LiteralFilter,
+        /// filterRegExp must appear at the start of the text, case-insensitive
+        PrefixFilter,
+        /// Characters of filterRegExp must appear in the text, in order
+        FuzzyFilter
+    };
+
     SortFilterModel(QObject* parent=0);
     ~SortFilterModel();
 
@@ -78,6 +99,9 @@ public:
     void setFilterRole(const QString &role);
     QString filterRole() const;
 
+    void setFilterMode(FilterMode mode);
+    FilterMode filterMode() const;
+
     void setSortRole(const QString &role);
     QString sortRole() const;
 
@@ -98,13 +122,23 @@ public:
 
     Q_INVOKABLE int mapRowFromSource(int i) const;
 
+    /**
+     * Homerun bulk data access: returns the data of the roles named
+     * @p roleNames for the @p count rows starting at @p first, one map per
+     * row. Rows which are contiguous in the source model are fetched with a
+     * single call to its own rowData() method, if it has one.
+     */
+    Q_INVOKABLE QVariantList rowData(int first, int count, const QStringList &roleNames) const;
+
 Q_SIGNALS:
     void countChanged();
     void sourceModelChanged(QObject *);
     void filterRegExpChanged(const QString &);
+    void filterModeChanged();
 
 protected:
     int roleNameToId(const QString &name);
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const; // reimp
 
 protected Q_SLOTS:
     void syncRoleNames();
@@ -112,11 +146,22 @@ protected Q_SLOTS:
 private Q_SLOTS:
     void onRowsAboutToBeMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow);
     void onRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow);
+    void onSourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void onSourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void resetTextFilter();
 
 private:
     QString m_filterRole;
     QString m_sortRole;
     QHash<QString, int> m_roleIds;
+    FilterMode m_filterMode;
+    // Keys of the source rows, only kept up to date in text filter modes
+    HomerunInternal::TextFilter m_textFilter;
+
+    bool isTextFilterMode() const { return m_filterMode != RegExpFilter; }
+    QString filterTextForRow(int row) const;
+    static HomerunInternal::TextFilter::Mode textFilterModeFor(FilterMode mode);
 };
 
 }
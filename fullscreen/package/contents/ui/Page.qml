@@ -43,7 +43,14 @@ Item {
 
     //- Read-only properties ---------------------------------------
     // Defined for pages with a single view on a browsable model
-    property QtObject pathModel: tabSourceModel.count == 1 ? tabSourceModel.get(0).model.pathModel : null
+    // The model is null while the tab is evicted
+    property QtObject pathModel: {
+        if (tabSourceModel.count != 1) {
+            return null;
+        }
+        var model = tabSourceModel.get(0).model;
+        return model ? model.pathModel : null;
+    }
 
     signal closeRequested()
     signal openSourceRequested(string sourceId, variant sourceArguments)
@@ -57,6 +64,7 @@ Item {
         id: genericFilterComponent
 
         HomerunFixes.SortFilterModel {
+            filterMode: HomerunFixes.SortFilterModel.LiteralFilter
             filterRegExp: main.searchCriteria
             property string name: sourceModel.name
             property int count: sourceModel.count
@@ -127,6 +135,7 @@ Item {
 
             property bool modelNeedsFiltering: false
             property variant favoriteModels
+            property QtObject favoritesIndex
 
             // Expose the same focus API as ResultsView. Used when focus changes
             // from a single ResultsView source to a multi ResultsView source
@@ -190,6 +199,7 @@ Item {
                         ? createFilterForModel(repeater.model.modelForRow(index))
                         : repeater.model.modelForRow(index)
                     favoriteModels: multiMain.favoriteModels
+                    favoritesIndex: multiMain.favoritesIndex
 
                     onModelChanged: {
                         if ("applicationLaunched" in model) {
@@ -491,10 +501,16 @@ Item {
                         }
 
                         function createViewForRow() {
-                            connectModel(model.model);
                             if (view) {
                                 view.destroy();
+                                view = null;
+                            }
+                            if (!model.model) {
+                                // Model has been evicted, it is recreated
+                                // when the tab is shown again
+                                return;
                             }
+                            connectModel(model.model);
                             view = main.createView(model.model, delegateMain);
                             main.updateRunning();
                         }
@@ -600,7 +616,8 @@ Item {
 
     function updateRunning() {
         for (var idx = 0; idx < tabSourceModel.count; ++idx) {
-            if (tabSourceModel.get(idx).model.running) {
+            var model = tabSourceModel.get(idx).model;
+            if (model && model.running) {
                 busyIndicator.running = true;
                 return;
             }
@@ -645,6 +662,7 @@ Item {
 
         var viewArgs = {};
         viewArgs["favoriteModels"] = sourceRegistry.favoriteModels;
+        viewArgs["favoritesIndex"] = sourceRegistry.favoritesIndex;
         viewArgs["model"] = model;
         viewArgs["showHeader"] = showHeader;
         if (modelNeedsFiltering) {
@@ -665,7 +683,7 @@ Item {
         function nextView() {
             for (var idx = currentIdx + 1; idx < repeater.count; ++idx) {
                 var view = repeater.viewAt(idx);
-                if (!view.isEmpty()) {
+                if (view && !view.isEmpty()) {
                     return view;
                 }
             }
@@ -675,7 +693,7 @@ Item {
         function previousView() {
             for (var idx = currentIdx - 1; idx >= 0; --idx) {
                 var view = repeater.viewAt(idx);
-                if (!view.isEmpty()) {
+                if (view && !view.isEmpty()) {
                     return view;
                 }
             }
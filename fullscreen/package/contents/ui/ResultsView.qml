@@ -23,11 +23,13 @@ import org.kde.plasma.core 0.1 as PlasmaCore
 import org.kde.plasma.components 0.1 as PlasmaComponents
 import org.kde.qtextracomponents 0.1 as QtExtra
 
+
 FocusScope {
     id: main
 
     //- Public --------------------------------------------------
     property variant favoriteModels
+    property QtObject favoritesIndex
 
     property bool showHeader: true
     /* We intentionally do not use an alias for "model" here. With an alias,
@@ -118,6 +120,12 @@ FocusScope {
         return true;
     }
 
+    HomerunComponents.RowDataCache {
+        id: rowDataCache
+        model: main.model
+        roleNames: ["display", "decoration", "favoriteId", "hasActionList"]
+    }
+
     //FIXME: figure out sizing properly..
     property int iconWidth: 64
     property int resultItemWidth: 128
@@ -142,8 +150,12 @@ FocusScope {
                 dragContainer: gridDragContainer
                 dragEnabled: ("canMoveRow" in main.model) ? main.model.canMoveRow : false
 
-                text: model.display
-                icon: model.decoration
+                // Filled with a single rowData() call for a block of rows if
+                // the model supports it
+                property variant rowData: rowDataCache.rowData(model.index, rowDataCache.generation)
+
+                text: rowData ? rowData.display : model.display
+                icon: rowData ? rowData.decoration : model.decoration
                 itemIndex: model.index
 
                 onHighlightedChanged: {
@@ -152,7 +164,7 @@ FocusScope {
                     }
                 }
 
-                hasActionList: model.favoriteId || (("hasActionList" in model) && model.hasActionList)
+                hasActionList: rowData ? (rowData.favoriteId || rowData.hasActionList) : (model.favoriteId || (("hasActionList" in model) && model.hasActionList))
 
                 onAboutToShowActionMenu: {
                     fillActionMenu(actionMenu);
@@ -169,15 +181,14 @@ FocusScope {
                 function fillActionMenu(actionMenu) {
                     // Accessing actionList can be a costly operation, so we don't
                     // access it until we need the menu
-                    var lst = model.hasActionList ? model.actionList : [];
+                    var lst = [];
                     var action = createFavoriteAction();
                     if (action) {
-                        if (lst.length > 0) {
-                            var separator = { "type": "separator" };
-                            lst.unshift(action, separator);
-                        } else {
-                            lst = [action];
-                        }
+                        lst.push(action, { "type": "separator" });
+                    }
+                    if (model.hasActionList) {
+                        // Either a list of actions or an ActionListModel
+                        lst.push(model.actionList);
                     }
                     actionMenu.actionList = lst;
                 }
@@ -188,7 +199,7 @@ FocusScope {
                         return null;
                     }
                     var action = {};
-                    if (favoriteModel.isFavorite(model.favoriteId)) {
+                    if (favoritesIndex.isFavorite(model.favoriteId)) {
                         action.text = i18n("Remove from Favorites");
                         action.icon = QIcon("list-remove");
                         action.actionId = "_homerun_favorite_remove";
@@ -266,6 +277,13 @@ FocusScope {
 
         delegate: result
 
+        onCurrentIndexChanged: {
+            // Let browsable models get ready for the item the user is likely to open
+            if (currentIndex >= 0 && main.model && "prefetch" in main.model) {
+                main.model.prefetch(currentIndex);
+            }
+        }
+
         Keys.onPressed: {
             // We must handle arrow key navigation ourself because 'interactive' is false
             if (event.modifiers == Qt.NoModifier) {
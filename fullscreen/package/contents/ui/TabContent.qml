@@ -309,9 +309,12 @@ Item {
         currentPage.triggerFirstItem();
     }
 
+    // Returns true if the tab shows something else afterwards
     function reset() {
+        var changed = TabContentInternal.currentIndex > 0 || searchCriteria != "";
         TabContentInternal.goTo(0);
         TabContentInternal.clearHistoryAfterCurrentPage();
         searchCriteria = "";
+        return changed;
     }
 }
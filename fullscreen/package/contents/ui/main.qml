@@ -56,6 +56,11 @@ Item {
         sourceRegistry: sourceRegistry
     }
 
+    HomerunComponents.ModelLifecycleManager {
+        tabModel: tabModel
+        currentTab: tabBar.currentIndex
+    }
+
     HomerunComponents.SourceRegistry {
         id: sourceRegistry
         configFileName: main.configFileName
@@ -438,16 +443,19 @@ Item {
         }
     }
 
+    // Returns true if the view shows something else afterwards
     function reset() {
+        var changed = tabBar.currentIndex != 0 || configureMode || searchField.text != "";
         tabBar.currentIndex = 0;
         for (idx = 0; idx < tabGroup.data.length; ++idx) {
             var tabContent = tabGroup.data[idx];
-            if (tabContent && tabContent.reset) {
-                tabContent.reset();
+            if (tabContent && tabContent.reset && tabContent.reset()) {
+                changed = true;
             }
         }
         configureMode = false;
         searchField.text = "";
         searchField.forceActiveFocus();
+        return changed;
     }
 }
@@ -30,10 +30,14 @@
 
 #include "homerunvieweradaptor.h"
 
+#include <trace.h>
+
 #include <QApplication>
 #include <QDeclarativeInfo>
 #include <QDesktopWidget>
 #include <QKeyEvent>
+#include <QPainter>
+#include <QTimer>
 
 #include <kdeclarative.h>
 
@@ -49,11 +53,22 @@
 #include <Plasma/PackageStructure>
 #include <Plasma/WindowEffects>
 
+// Wait a bit after the view has been hidden or the screens changed before
+// preparing the scene, so that we do not compete with what the user is doing
+static const int PREWARM_DELAY = 1000;
+
+static const int MAX_TOGGLE_LATENCIES = 100;
+
 FullView::FullView()
 : QDeclarativeView()
 , m_backgroundSvg(new Plasma::FrameSvg(this))
 , m_lastFocusedItem(0)
 , m_plainWindow(false)
+, m_prewarmTimer(new QTimer(this))
+, m_lastScreen(-1)
+, m_sceneChanged(true)
+, m_toggleTraceTime(-1)
+, m_waitingForFirstFrame(false)
 {
     KCmdLineArgs *args = KCmdLineArgs::parsedArgs();
     m_plainWindow = args->isSet("plain-window");
@@ -76,10 +91,15 @@ FullView::FullView()
     setAutoFillBackground(false);
     viewport()->setAutoFillBackground(false);
     viewport()->setAttribute(Qt::WA_NoSystemBackground);
+
+    m_prewarmTimer->setInterval(PREWARM_DELAY);
+    m_prewarmTimer->setSingleShot(true);
+    connect(m_prewarmTimer, SIGNAL(timeout()), SLOT(prewarm()));
 }
 
 bool FullView::init(QString *errorMessage)
 {
+    Homerun::TraceSpan span("FullView::init");
     HomerunViewerAdaptor *adaptor = new HomerunViewerAdaptor(this);
     qApp->setProperty("HomerunViewerAdaptor", QVariant::fromValue<QObject *>(adaptor));
     QDBusConnection dbus = QDBusConnection::sessionBus();
@@ -93,7 +113,10 @@ bool FullView::init(QString *errorMessage)
     Plasma::PackageStructure::Ptr structure = Plasma::Applet::packageStructure();
     const QString homerunPath = KGlobal::dirs()->locate("data", structure->defaultPackageRoot() + "/org.kde.homerun/");
     Plasma::Package package(homerunPath, structure);
-    setSource(package.filePath("mainscript"));
+    {
+        Homerun::TraceSpan span("FullView::setSource", package.filePath("mainscript"));
+        setSource(package.filePath("mainscript"));
+    }
 
     if (!rootObject()) {
         Q_FOREACH(const QDeclarativeError &error, errors()) {
@@ -106,6 +129,12 @@ bool FullView::init(QString *errorMessage)
 
     setupBackground();
 
+    QDesktopWidget *desktop = QApplication::desktop();
+    connect(desktop, SIGNAL(resized(int)), SLOT(schedulePrewarm()));
+    connect(desktop, SIGNAL(workAreaResized(int)), SLOT(schedulePrewarm()));
+    connect(desktop, SIGNAL(screenCountChanged(int)), SLOT(schedulePrewarm()));
+    schedulePrewarm();
+
     KCmdLineArgs *args = KCmdLineArgs::parsedArgs();
     if (args->isSet("log-focused-item")) {
         QTimer *timer = new QTimer(this);
@@ -155,13 +184,17 @@ void FullView::toggle(int screen, uint appletContainmentId, bool appletContainme
         // login. See https://bugs.kde.org/show_bug.cgi?id=312993
         KWindowSystem::setOnDesktop(winId(), KWindowSystem::currentDesktop());
 
-        QDesktopWidget w;
-        if(screen < 0) {
-            screen = w.screenNumber(QCursor::pos());
-        }
-        QRect rect = w.availableGeometry(screen);
-        setGeometry(rect);
+        m_prewarmTimer->stop();
+        m_lastScreen = screen;
+        m_toggleTime.start();
+        m_toggleTraceTime = Homerun::Trace::now();
+        m_waitingForFirstFrame = true;
+
+        // If the view has been prepared for this screen, this does nothing
+        setGeometry(screenRect(screen));
         show();
+        m_renderedRect = geometry();
+        m_sceneChanged = false;
         KWindowSystem::forceActiveWindow(winId());
 
         qApp->setProperty("appletContainmentId", appletContainmentId);
@@ -178,7 +211,81 @@ void FullView::resetAndHide()
         return;
     }
     hide();
-    QMetaObject::invokeMethod(rootObject(), "reset");
+    QVariant changed;
+    QMetaObject::invokeMethod(rootObject(), "reset", Q_RETURN_ARG(QVariant, changed));
+    if (changed.toBool()) {
+        m_sceneChanged = true;
+    }
+    schedulePrewarm();
+}
+
+QRect FullView::screenRect(int screen) const
+{
+    QDesktopWidget *desktop = QApplication::desktop();
+    if (screen < 0 || screen >= desktop->screenCount()) {
+        screen = desktop->screenNumber(QCursor::pos());
+    }
+    return desktop->availableGeometry(screen);
+}
+
+void FullView::schedulePrewarm()
+{
+    if (!isVisible()) {
+        m_prewarmTimer->start();
+    }
+}
+
+void FullView::prewarm()
+{
+    if (isVisible() || !rootObject()) {
+        return;
+    }
+    // Rendering a full screen pixmap is not cheap: only do it if the caches
+    // do not already hold what the first frame will show
+    const QRect rect = screenRect(m_lastScreen);
+    if (!m_sceneChanged && rect == m_renderedRect) {
+        return;
+    }
+    Homerun::TraceSpan span("FullView::prewarm");
+
+    // Lay the scene out for the screen we are most likely to be shown on.
+    // The resize event of a hidden widget is only delivered when it is
+    // shown, so resize the root object ourselves.
+    setGeometry(rect);
+    rootObject()->setProperty("width", rect.width());
+    rootObject()->setProperty("height", rect.height());
+    m_backgroundSvg->resizeFrame(rect.size());
+
+    // Render once offscreen: this fills the svg, icon and text caches so that
+    // the first frame after toggle() only has to compose them
+    QPixmap pixmap(rect.size());
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    m_backgroundSvg->paintFrame(&painter);
+    scene()->render(&painter, QRectF(pixmap.rect()), QRectF(QPointF(0, 0), rect.size()));
+    m_renderedRect = rect;
+    m_sceneChanged = false;
+}
+
+QList<int> FullView::toggleLatencies() const
+{
+    return m_toggleLatencies;
+}
+
+void FullView::paintEvent(QPaintEvent *event)
+{
+    QDeclarativeView::paintEvent(event);
+    if (!m_waitingForFirstFrame) {
+        return;
+    }
+    m_waitingForFirstFrame = false;
+    const int latency = m_toggleTime.elapsed();
+    m_toggleLatencies << latency;
+    if (m_toggleLatencies.count() > MAX_TOGGLE_LATENCIES) {
+        m_toggleLatencies.removeFirst();
+    }
+    Homerun::Trace::addSpan("FullView toggle to first frame", m_toggleTraceTime);
+    toggleLatencyMeasured(latency);
 }
 
 void FullView::keyPressEvent(QKeyEvent *event)
@@ -28,6 +28,10 @@
 #define FULLVIEW_H
 
 #include <QDeclarativeView>
+#include <QElapsedTimer>
+#include <QList>
+
+class QTimer;
 
 namespace Plasma {
 class FrameSvg;
@@ -57,24 +61,50 @@ public Q_SLOTS:
         int desktopContainmentId, bool desktopContainmentMutable);
     void updateGeometry();
 
+    /**
+     * Returns the time, in milliseconds, between the most recent calls to
+     * toggle() which showed the view and the first frame painted after them.
+     * Oldest first.
+     */
+    QList<int> toggleLatencies() const;
+
+Q_SIGNALS:
+    void toggleLatencyMeasured(int milliseconds);
+
 protected:
     virtual void focusOutEvent(QFocusEvent *event);
     virtual void keyPressEvent(QKeyEvent *event);
     virtual void resizeEvent(QResizeEvent *event);
     virtual void drawBackground(QPainter *painter, const QRectF&rect);
+    virtual void paintEvent(QPaintEvent *event);
 
 private Q_SLOTS:
     void logFocusedItem();
+    void schedulePrewarm();
+    void prewarm();
 
 private:
     void setupBackground();
     void resetAndHide();
+    QRect screenRect(int screen) const;
 
     Plasma::FrameSvg *m_backgroundSvg;
 
     QGraphicsItem *m_lastFocusedItem;
 
     bool m_plainWindow;
+
+    QTimer *m_prewarmTimer;
+    int m_lastScreen;
+    // The geometry the scene was last rendered at, on screen or by prewarm()
+    QRect m_renderedRect;
+    // True if the scene changed since it was last rendered
+    bool m_sceneChanged;
+
+    QElapsedTimer m_toggleTime;
+    qint64 m_toggleTraceTime;
+    bool m_waitingForFirstFrame;
+    QList<int> m_toggleLatencies;
 };
 
 #endif
@@ -35,6 +35,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <fullview.h>
 #include <homerun_config.h>
 
+// libhomerun
+#include <trace.h>
+
 static void showError(const QString &errorMessage)
 {
     int ret = KMessageBox::warningContinueCancel(0,
@@ -64,6 +67,7 @@ int main(int argc, char *argv[])
     KCmdLineOptions options;
     options.add("log-focused-item", ki18n("Log focused item (for debug purposes)"));
     options.add("plain-window", ki18n("Use a plain window (for debug purposes)"));
+    options.add("trace <file>", ki18n("Write a Chrome trace of where time is spent to <file> (for debug purposes)"));
     KCmdLineArgs::addCmdLineOptions(options);
     KUniqueApplication::addCmdLineOptions();
 
@@ -73,19 +77,28 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    // Start tracing after KUniqueApplication::start(), which forks
+    KCmdLineArgs *args = KCmdLineArgs::parsedArgs();
+    if (args->isSet("trace")) {
+        Homerun::Trace::start(args->getOption("trace"));
+    }
+    const qint64 startupTime = Homerun::Trace::now();
+
     KUniqueApplication app;
     app.disableSessionManagement();
     KDeclarative::setupQmlJsDebugger();
+    Homerun::Trace::addSpan("KUniqueApplication", startupTime);
 
     // Create view
-    KCmdLineArgs *args = KCmdLineArgs::parsedArgs();
     KCmdLineArgs *kdeArgs = KCmdLineArgs::parsedArgs("kde");
 
     if (!args->isSet("plain-window")) {
         app.setQuitOnLastWindowClosed(false);
     }
 
+    const qint64 viewTime = Homerun::Trace::now();
     FullView view;
+    Homerun::Trace::addSpan("FullView::FullView", viewTime);
 
     QString errorMessage;
     if (!view.init(&errorMessage)) {
@@ -95,10 +108,17 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-    view.setConfigFileName(
-        kdeArgs->isSet("config")
-        ? kdeArgs->getOption("config")
-        : "homerunrc");
+    {
+        // Loads the tabs and creates their models
+        Homerun::TraceSpan span("FullView::setConfigFileName");
+        view.setConfigFileName(
+            kdeArgs->isSet("config")
+            ? kdeArgs->getOption("config")
+            : "homerunrc");
+    }
 
-    return app.exec();
+    Homerun::Trace::addSpan("startup", startupTime);
+    int ret = app.exec();
+    Homerun::Trace::stop();
+    return ret;
 }
@@ -0,0 +1,233 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <textfilter.h>
+
+// Local
+
+// KDE
+
+// Qt
+
+namespace HomerunInternal
+{
+
+// Scores are laid out so that a prefix match always beats a match at a word
+// boundary, which beats any other substring match, which beats any fuzzy match.
+static const int PREFIX_SCORE = 4000;
+static const int WORD_SCORE = 3000;
+static const int SUBSTRING_SCORE = 2000;
+static const int FUZZY_SCORE = 1000;
+static const int MAX_PENALTY = 999;
+
+static inline bool isWordStart(const QString &key, int pos)
+{
+    return pos == 0 || !key.at(pos - 1).isLetterOrNumber();
+}
+
+static inline int lengthPenalty(const QString &key, const QString &query)
+{
+    // Among equivalent matches, prefer the shortest texts
+    return qMin(key.length() - query.length(), MAX_PENALTY);
+}
+
+static int literalMatch(const QString &key, const QString &query)
+{
+    int pos = key.indexOf(query);
+    if (pos == -1) {
+        return -1;
+    }
+    int score;
+    if (pos == 0) {
+        score = PREFIX_SCORE;
+    } else {
+        score = SUBSTRING_SCORE;
+        // A later occurrence may start a word, "report" should rank
+        // "annual-report" above "sportreport"
+        for (; pos != -1; pos = key.indexOf(query, pos + 1)) {
+            if (isWordStart(key, pos)) {
+                score = WORD_SCORE;
+                break;
+            }
+        }
+    }
+    return score - lengthPenalty(key, query);
+}
+
+static int fuzzyMatch(const QString &key, const QString &query)
+{
+    int score = literalMatch(key, query);
+    if (score != -1) {
+        return score;
+    }
+    // Characters of the query must appear in order. Penalize gaps, reward
+    // characters starting a word.
+    score = FUZZY_SCORE;
+    int keyPos = 0;
+    const int keyLength = key.length();
+    Q_FOREACH(const QChar &ch, query) {
+        int gap = 0;
+        while (keyPos < keyLength && key.at(keyPos) != ch) {
+            ++keyPos;
+            ++gap;
+        }
+        if (keyPos == keyLength) {
+            return -1;
+        }
+        score -= gap;
+        if (isWordStart(key, keyPos)) {
+            score += 10;
+        }
+        ++keyPos;
+    }
+    return qBound(1, score, SUBSTRING_SCORE - MAX_PENALTY - 1);
+}
+
+TextFilter::TextFilter(Mode mode)
+: m_mode(mode)
+{
+}
+
+TextFilter::Mode TextFilter::mode() const
+{
+    return m_mode;
+}
+
+void TextFilter::setMode(TextFilter::Mode mode)
+{
+    if (m_mode == mode) {
+        return;
+    }
+    m_mode = mode;
+    for (auto it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+        updateEntry(it);
+    }
+}
+
+QString TextFilter::query() const
+{
+    return m_query;
+}
+
+bool TextFilter::setQuery(const QString &query)
+{
+    if (m_query == query) {
+        return false;
+    }
+    const QString foldedQuery = foldedKey(query);
+    // If the new query extends the previous one, rows which did not match
+    // before cannot match now: only look at the accepted ones
+    const bool refine = !m_foldedQuery.isEmpty() && foldedQuery.startsWith(m_foldedQuery);
+    m_query = query;
+    m_foldedQuery = foldedQuery;
+    for (auto it = m_entries.begin(), end = m_entries.end(); it != end; ++it) {
+        if (refine && it->score == -1) {
+            continue;
+        }
+        updateEntry(it);
+    }
+    return true;
+}
+
+int TextFilter::count() const
+{
+    return m_entries.count();
+}
+
+void TextFilter::setTexts(const QStringList &texts)
+{
+    m_entries.clear();
+    insertTexts(0, texts);
+}
+
+void TextFilter::insertTexts(int first, const QStringList &texts)
+{
+    Q_ASSERT(first >= 0 && first <= m_entries.count());
+    m_entries.insert(first, texts.count(), Entry());
+    auto it = m_entries.begin() + first;
+    Q_FOREACH(const QString &text, texts) {
+        it->key = foldedKey(text);
+        updateEntry(it);
+        ++it;
+    }
+}
+
+void TextFilter::removeRows(int first, int last)
+{
+    Q_ASSERT(first >= 0 && last < m_entries.count());
+    m_entries.remove(first, last - first + 1);
+}
+
+void TextFilter::updateText(int row, const QString &text)
+{
+    Q_ASSERT(row >= 0 && row < m_entries.count());
+    Entry *entry = m_entries.data() + row;
+    entry->key = foldedKey(text);
+    updateEntry(entry);
+}
+
+void TextFilter::clear()
+{
+    m_entries.clear();
+}
+
+bool TextFilter::isAccepted(int row) const
+{
+    if (row < 0 || row >= m_entries.count()) {
+        return false;
+    }
+    return m_entries.at(row).score != -1;
+}
+
+int TextFilter::score(int row) const
+{
+    if (row < 0 || row >= m_entries.count()) {
+        return 0;
+    }
+    return qMax(m_entries.at(row).score, 0);
+}
+
+QString TextFilter::foldedKey(const QString &text)
+{
+    return text.toCaseFolded();
+}
+
+int TextFilter::match(TextFilter::Mode mode, const QString &key, const QString &query)
+{
+    if (query.isEmpty()) {
+        return 0;
+    }
+    switch (mode) {
+    case LiteralMode:
+        return literalMatch(key, query);
+    case PrefixMode:
+        return key.startsWith(query) ? PREFIX_SCORE - lengthPenalty(key, query) : -1;
+    case FuzzyMode:
+        return fuzzyMatch(key, query);
+    }
+    return -1;
+}
+
+void TextFilter::updateEntry(Entry *entry) const
+{
+    entry->score = match(m_mode, entry->key, m_foldedQuery);
+}
+
+} // namespace
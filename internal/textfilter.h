@@ -0,0 +1,110 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TEXTFILTER_H
+#define TEXTFILTER_H
+
+// Local
+
+// Qt
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// KDE
+
+namespace HomerunInternal
+{
+
+/**
+ * Filters a flat list of strings against a plain-text query.
+ *
+ * TextFilter keeps a casefolded key for each row so that changing the query
+ * does not require recomputing the keys. When the new query extends the
+ * previous one, only rows which were accepted so far are checked again.
+ *
+ * Rows are identified by their position: callers must keep the filter in sync
+ * with their list using setTexts(), insertTexts(), removeRows() and
+ * updateText().
+ */
+class TextFilter
+{
+public:
+    enum Mode {
+        /// Query must appear anywhere in the text
+        LiteralMode,
+        /// Query must appear at the start of the text
+        PrefixMode,
+        /// Query characters must appear in the text, in order
+        FuzzyMode,
+    };
+
+    TextFilter(Mode mode = LiteralMode);
+
+    Mode mode() const;
+    void setMode(Mode mode);
+
+    QString query() const;
+
+    /**
+     * Changes the query and updates the accepted state of each row.
+     * @return true if the query has changed
+     */
+    bool setQuery(const QString &query);
+
+    int count() const;
+
+    void setTexts(const QStringList &texts);
+    void insertTexts(int first, const QStringList &texts);
+    void removeRows(int first, int last);
+    void updateText(int row, const QString &text);
+    void clear();
+
+    bool isAccepted(int row) const;
+
+    /**
+     * Relevance of @p row for the current query, higher is better. Returns 0
+     * for rejected rows and when the query is empty.
+     */
+    int score(int row) const;
+
+    static QString foldedKey(const QString &text);
+
+    /**
+     * Matches an already folded key against an already folded query.
+     * @return -1 if the key does not match, its score otherwise
+     */
+    static int match(Mode mode, const QString &key, const QString &query);
+
+private:
+    struct Entry {
+        QString key;
+        int score;
+    };
+    Mode m_mode;
+    QString m_query;
+    QString m_foldedQuery;
+    QVector<Entry> m_entries;
+
+    void updateEntry(Entry *entry) const;
+};
+
+} // namespace
+
+#endif /* TEXTFILTER_H */
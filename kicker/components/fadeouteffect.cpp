@@ -21,6 +21,9 @@
 #include <QLinearGradient>
 #include <QPainter>
 
+// Height of the gradient between the visible and the covered parts
+static const int FADE_HEIGHT = 8;
+
 FadeOutEffect::FadeOutEffect(QObject *parent) : QGraphicsEffect(parent)
 , m_covered(0)
 {
@@ -37,31 +40,65 @@ int FadeOutEffect::covered() const
 
 void FadeOutEffect::setCovered(int covered)
 {
+    if (m_covered == covered) {
+        return;
+    }
+
     m_covered = covered;
 
     update();
 }
 
-void FadeOutEffect::draw(QPainter* painter)
+void FadeOutEffect::updateMask(int width, int height)
 {
-    QPixmap sourceItem = sourcePixmap(Qt::LogicalCoordinates);
+    if (m_mask.width() == width && m_mask.height() == height) {
+        return;
+    }
 
-    QPixmap pixmap(sourceItem.size());
-    pixmap.fill(Qt::transparent);
+    m_mask = QPixmap(width, height);
+    m_mask.fill(Qt::transparent);
 
-    QLinearGradient gradient(0, qMax(0, pixmap.size().height() - m_covered - 8),
-        0, pixmap.size().height() - m_covered);
+    QLinearGradient gradient(0, 0, 0, height);
     gradient.setColorAt(0, "black");
     gradient.setColorAt(1, Qt::transparent);
 
-    QPainter itemPainter(&pixmap);
-    itemPainter.drawPixmap(0, 0, sourceItem);
-    itemPainter.setBrush(QBrush(gradient));
-    itemPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    itemPainter.drawRect(QRect(0, 0, pixmap.size().width(), pixmap.size().height()));
+    QPainter maskPainter(&m_mask);
+    maskPainter.fillRect(m_mask.rect(), QBrush(gradient));
 
-    painter->drawPixmap(0, 0, pixmap);
+    m_band = QPixmap(width, height);
+    m_band.fill(Qt::transparent);
 }
 
+void FadeOutEffect::draw(QPainter* painter)
+{
+    const QPixmap sourceItem = sourcePixmap(Qt::LogicalCoordinates);
+
+    // The item is drawn as is down to fadeStart, faded out between fadeStart
+    // and fadeEnd, and hidden below fadeEnd. Only the fade band needs
+    // compositing, and its mask only depends on the band size.
+    const int width = sourceItem.width();
+    const int fadeEnd = qMin(sourceItem.height() - m_covered, sourceItem.height());
+    const int fadeStart = qMax(0, fadeEnd - FADE_HEIGHT);
+
+    if (fadeStart > 0) {
+        painter->drawPixmap(0, 0, sourceItem, 0, 0, width, fadeStart);
+    }
+
+    if (fadeEnd <= fadeStart || width <= 0) {
+        return;
+    }
+
+    const int fadeHeight = fadeEnd - fadeStart;
+    updateMask(width, fadeHeight);
+
+    QPainter bandPainter(&m_band);
+    bandPainter.setCompositionMode(QPainter::CompositionMode_Source);
+    bandPainter.drawPixmap(0, 0, sourceItem, 0, fadeStart, width, fadeHeight);
+    bandPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
+    bandPainter.drawPixmap(0, 0, m_mask);
+    bandPainter.end();
+
+    painter->drawPixmap(0, fadeStart, m_band);
+}
 
 #include "fadeouteffect.moc"
@@ -20,6 +20,7 @@
 #define FADEOUTEFFECT_H
 
 #include <QGraphicsEffect>
+#include <QPixmap>
 
 class FadeOutEffect : public QGraphicsEffect
 {
@@ -37,6 +38,12 @@ class FadeOutEffect : public QGraphicsEffect
 
     private:
         int m_covered;
+        // Gradient mask of the fade band and buffer to composite the band in,
+        // both reused as long as the band size does not change
+        QPixmap m_mask;
+        QPixmap m_band;
+
+        void updateMask(int width, int height);
 };
 
 #endif
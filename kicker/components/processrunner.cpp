@@ -18,19 +18,130 @@
 
 #include "processrunner.h"
 
+#include <KDebug>
+#include <KLocalizedString>
 #include <KProcess>
 
 ProcessRunner::ProcessRunner(QObject *parent) : QObject(parent)
+, m_nextId(0)
+, m_lastSpawnLatency(-1)
 {
 }
 
 ProcessRunner::~ProcessRunner()
 {
+    // Watched processes die with the runner, there is no one left to notify
+    foreach (KProcess *process, m_launches.keys()) {
+        process->disconnect(this);
+        process->kill();
+    }
 }
 
-void ProcessRunner::execute(const QString& name)
+int ProcessRunner::execute(const QString& name)
 {
-    KProcess::execute(name);
+    const int id = ++m_nextId;
+    QElapsedTimer timer;
+    timer.start();
+    // Only waits for the fork, not for the child to exit
+    if (KProcess::startDetached(name) == 0) {
+        reportFailure(id, i18n("Could not start %1", name));
+    } else {
+        reportStarted(id, timer);
+    }
+    return id;
+}
+
+int ProcessRunner::start(const QString &program, const QStringList &arguments)
+{
+    const int id = ++m_nextId;
+    KProcess *process = new KProcess(this);
+    process->setProgram(program, arguments);
+    connect(process, SIGNAL(started()), SLOT(processStarted()));
+    connect(process, SIGNAL(finished(int,QProcess::ExitStatus)),
+        SLOT(processFinished(int,QProcess::ExitStatus)));
+    connect(process, SIGNAL(error(QProcess::ProcessError)),
+        SLOT(processError(QProcess::ProcessError)));
+
+    Launch launch;
+    launch.id = id;
+    launch.timer.start();
+    m_launches.insert(process, launch);
+    process->start();
+    emit runningCountChanged();
+    return id;
+}
+
+int ProcessRunner::lastSpawnLatency() const
+{
+    return m_lastSpawnLatency;
+}
+
+QString ProcessRunner::lastError() const
+{
+    return m_lastError;
+}
+
+int ProcessRunner::runningCount() const
+{
+    return m_launches.count();
+}
+
+void ProcessRunner::processStarted()
+{
+    KProcess *process = static_cast<KProcess *>(sender());
+    if (!m_launches.contains(process)) {
+        return;
+    }
+    const Launch launch = m_launches.value(process);
+    reportStarted(launch.id, launch.timer);
+}
+
+void ProcessRunner::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    KProcess *process = static_cast<KProcess *>(sender());
+    if (!m_launches.contains(process)) {
+        // Already reported as failed
+        return;
+    }
+    const int id = m_launches.value(process).id;
+    removeLaunch(process);
+    emit finished(id, exitCode, exitStatus == QProcess::CrashExit);
+}
+
+void ProcessRunner::processError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart) {
+        // finished() follows for the other errors
+        return;
+    }
+    KProcess *process = static_cast<KProcess *>(sender());
+    if (!m_launches.contains(process)) {
+        return;
+    }
+    const int id = m_launches.value(process).id;
+    const QString errorString = process->errorString();
+    removeLaunch(process);
+    reportFailure(id, errorString);
+}
+
+void ProcessRunner::reportStarted(int id, const QElapsedTimer &timer)
+{
+    m_lastSpawnLatency = timer.elapsed();
+    emit started(id, m_lastSpawnLatency);
+}
+
+void ProcessRunner::reportFailure(int id, const QString &errorString)
+{
+    kWarning() << errorString;
+    m_lastError = errorString;
+    emit failed(id, errorString);
+}
+
+void ProcessRunner::removeLaunch(KProcess *process)
+{
+    m_launches.remove(process);
+    process->deleteLater();
+    emit runningCountChanged();
 }
 
 #include "processrunner.moc"
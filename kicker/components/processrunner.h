@@ -20,16 +20,85 @@
 #define PROCESSRUNNER_H
 
 #include <QAction>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QProcess>
+#include <QStringList>
 
+class KProcess;
+
+/**
+ * Launches processes without blocking the GUI thread.
+ *
+ * Each launch gets an id, which is passed to the started(), finished() and
+ * failed() signals. Processes started with start() are watched and killed if
+ * the runner is destroyed, execute() ones are detached.
+ */
 class ProcessRunner : public QObject
 {
     Q_OBJECT
 
+    /**
+     * Time in milliseconds it took to spawn the last process, -1 if no
+     * process has been spawned yet
+     */
+    Q_PROPERTY(int lastSpawnLatency READ lastSpawnLatency NOTIFY started)
+
+    /**
+     * Error message of the last launch failure
+     */
+    Q_PROPERTY(QString lastError READ lastError NOTIFY failed)
+
+    /**
+     * Number of processes started with start() which are still running
+     */
+    Q_PROPERTY(int runningCount READ runningCount NOTIFY runningCountChanged)
+
     public:
         ProcessRunner(QObject *parent = 0);
         ~ProcessRunner();
 
-        Q_INVOKABLE void execute(const QString &name);
+        /**
+         * Starts @p name detached from the runner. Returns the launch id.
+         */
+        Q_INVOKABLE int execute(const QString &name);
+
+        /**
+         * Starts @p program with @p arguments and watches it: finished() is
+         * emitted when it exits. Returns the launch id.
+         */
+        Q_INVOKABLE int start(const QString &program, const QStringList &arguments = QStringList());
+
+        int lastSpawnLatency() const;
+        QString lastError() const;
+        int runningCount() const;
+
+    signals:
+        void started(int id, int latency);
+        void finished(int id, int exitCode, bool crashed);
+        void failed(int id, const QString &errorString);
+        void runningCountChanged();
+
+    private slots:
+        void processStarted();
+        void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+        void processError(QProcess::ProcessError error);
+
+    private:
+        struct Launch {
+            Launch() : id(-1) {}
+            int id;
+            QElapsedTimer timer;
+        };
+
+        int m_nextId;
+        int m_lastSpawnLatency;
+        QString m_lastError;
+        QHash<KProcess *, Launch> m_launches;
+
+        void reportStarted(int id, const QElapsedTimer &timer);
+        void reportFailure(int id, const QString &errorString);
+        void removeLaunch(KProcess *process);
 };
 
 #endif
@@ -101,15 +101,14 @@ DragAndDrop.DragArea {
     function fillActionMenu(actionMenu) {
         // Accessing actionList can be a costly operation, so we don't
         // access it until we need the menu
-        var lst = model.hasActionList ? model.actionList : [];
+        var lst = [];
         var action = createFavoriteAction();
         if (action) {
-            if (lst.length > 0) {
-                var separator = { "type": "separator" };
-                lst.unshift(action, separator);
-            } else {
-                lst = [action];
-            }
+            lst.push(action, { "type": "separator" });
+        }
+        if (model.hasActionList) {
+            // Either a list of actions or an ActionListModel
+            lst.push(model.actionList);
         }
         actionMenu.actionList = lst;
     }
@@ -120,7 +119,7 @@ DragAndDrop.DragArea {
             return null;
         }
         var action = {};
-        if (favoriteModel.isFavorite(model.favoriteId)) {
+        if (sourceRegistry.favoritesIndex.isFavorite(model.favoriteId)) {
             action.text = i18n("Remove from Favorites");
             action.icon = QIcon("list-remove");
             action.actionId = "_homerun_favorite_remove";
@@ -47,7 +47,6 @@ Item {
 
     property string configFileName: "homerunkickerrc"
     property QtObject recentAppsModel
-    property QtObject allAppsModel
     property QtObject runnerModel
 
     property string icon: plasmoid.readConfig("icon")
@@ -264,7 +263,7 @@ Item {
                             parent.height - searchField.height - anchors.topMargin - anchors.bottomMargin)
                             : parent.height - searchField.height - anchors.topMargin - anchors.bottomMargin
 
-                        model: (searchField.text != "") ? allAppsModel : sourcesModel
+                        model: (searchField.text != "") ? globalSearchModel : sourcesModel
 
                         KeyNavigation.up: searchField
                         KeyNavigation.down: searchField
@@ -310,8 +309,8 @@ Item {
                         }
 
                         onAccepted: {
-                            if (allAppsModel && allAppsModel.count) {
-                                allAppsModel.trigger(0, "", null);
+                            if (globalSearchModel.count) {
+                                globalSearchModel.trigger(0, "", null);
                             }
 
                             plasmoid.hidePopup();
@@ -454,6 +453,14 @@ Item {
         id: sourcesModel
     }
 
+    HomerunComponents.GlobalSearchModel {
+        id: globalSearchModel
+        query: searchField.text
+        // The search replaces the whole list of applications, which was never
+        // truncated
+        maxResults: -1
+    }
+
     Repeater {
         model: tabModel
         delegate: Item {
@@ -478,7 +485,6 @@ Item {
 
                 if ("modelForRow" in model.model) {
                     if (model.sourceId == "FilterableInstalledApps") {
-                        queryBindingComponent.createObject(sourceDelegateMain, {"target":  model.model});
                         multiModelExpander.createObject(sourceDelegateMain, {"display": sourceName,
                             "model": model.model});
                         model.model.applicationLaunched.connect(recentAppsModel.addApp);
@@ -510,14 +516,6 @@ Item {
         }
     }
 
-    Component {
-        id: queryBindingComponent
-        Binding {
-            property: "query"
-            value: searchField.text
-        }
-    }
-
     Component {
         id: runnerQueryBindingComponent
         Binding {
@@ -544,7 +542,7 @@ Item {
                 var mdl = model.modelForRow(index);
 
                 if (index == 0) {
-                    allAppsModel = mdl;
+                    globalSearchModel.addModel(mdl);
                 } else {
                     sourcesModel.insertSource(index, item.display, mdl);
                 }
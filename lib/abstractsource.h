@@ -50,6 +50,11 @@ class AbstractSourcePrivate;
  * You don't need to inherit from this class if you want to write a simple
  * source, look at the SimpleSource class instead.
  *
+ * createModelFromConfigGroup() and createModelFromArguments() are called from
+ * the GUI thread, so they must return quickly. Sources whose models are
+ * expensive to fill should return an empty model and fill it later. AsyncModel
+ * does this using a worker thread.
+ *
  * A source can be configurable, to make it configurable, reimplement
  * isConfigurable() to return true, and reimplement createConfigurationWidget()
  * to return a SourceConfigurationWidget initialized from the source
@@ -139,6 +144,9 @@ private:
 /**
  * If your source just creates an argument-less model, you can use this simpler
  * template class.
+ *
+ * If filling the model is expensive, use AsyncSimpleSource instead, so that
+ * the model is filled without blocking the user interface.
  */
 template<class T>
 class HOMERUN_EXPORT SimpleSource : public AbstractSource
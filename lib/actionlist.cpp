@@ -21,6 +21,7 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <actionlist.h>
 
 // Local
+#include <actionlistmodel.h>
 
 // KDE
 #include <KDebug>
@@ -30,12 +31,15 @@ License along with this library.  If not, see <http://www.gnu.org/licenses/>.
 #include <KPropertiesDialog>
 #include <KRun>
 #include <KService>
+#include <KSycoca>
 
 // libkonq
 #include <konq_operations.h>
 
 // Qt
 #include <QApplication>
+#include <QHash>
+#include <QPointer>
 
 namespace Homerun
 {
@@ -69,6 +73,48 @@ QVariantMap createSeparatorActionItem()
     return map;
 }
 
+/**
+ * Keeps the models returned by sharedModelForFileItem()
+ */
+class FileItemModelCache : public QObject
+{
+public:
+    FileItemModelCache()
+    : QObject(qApp)
+    , m_sycocaTimeStamp(KSycoca::self()->timeStamp())
+    , m_trashModel(0)
+    {}
+
+    /**
+     * Refills the models if the application database changed since they
+     * were filled. Models are refilled in place rather than recreated: views
+     * may still hold them.
+     */
+    void update();
+
+    quint32 m_sycocaTimeStamp;
+    ActionListModel *m_trashModel;
+    QString m_trashMimeType;
+    QHash<QString, ActionListModel *> m_modelForMimeType;
+};
+
+static QPointer<FileItemModelCache> s_fileItemModelCache;
+
+static FileItemModelCache *fileItemModelCache()
+{
+    if (!s_fileItemModelCache) {
+        s_fileItemModelCache = new FileItemModelCache;
+    }
+    s_fileItemModelCache->update();
+    return s_fileItemModelCache;
+}
+
+static bool isTrashEmpty()
+{
+    KConfig trashConfig("trashrc", KConfig::SimpleConfig);
+    return trashConfig.group("Status").readEntry("Empty", true);
+}
+
 static QVariantMap createEmptyTrashItem()
 {
     QVariantMap map = createActionItem(
@@ -76,9 +122,7 @@ static QVariantMap createEmptyTrashItem()
         "_homerun_fileItem_emptyTrash");
     map["icon"] = KIcon("trash-empty");
 
-    KConfig trashConfig("trashrc", KConfig::SimpleConfig);
-    const bool isEmpty = trashConfig.group("Status").readEntry("Empty", true);
-    map["enabled"] = !isEmpty;
+    map["enabled"] = !isTrashEmpty();
     return map;
 }
 
@@ -106,6 +150,72 @@ QVariantList createListForFileItem(const KFileItem &fileItem)
     return list;
 }
 
+static void fillModelForMimeType(ActionListModel *model, const QString &mimeType)
+{
+    KService::List services = KMimeTypeTrader::self()->query(mimeType, "Application");
+    if (!services.isEmpty()) {
+        model->addTitle(i18n("Open with:"));
+        Q_FOREACH(const KService::Ptr service, services) {
+            const QString text = service->name().replace('&', "&&");
+            QString iconName = service->icon();
+            model->addAction(text, "_homerun_fileItem_openWith", service->entryPath(),
+                iconName.isEmpty() ? QIcon() : KIcon(iconName));
+        }
+        model->addSeparator();
+    }
+    model->addAction(i18n("Properties"), "_homerun_fileItem_properties");
+}
+
+static void fillTrashModel(ActionListModel *model, const QString &mimeType)
+{
+    model->addAction(
+        i18nc("@action:inmenu", "Empty Trash"),
+        "_homerun_fileItem_emptyTrash", QVariant(), KIcon("trash-empty"));
+    model->addSeparator();
+    fillModelForMimeType(model, mimeType);
+}
+
+void FileItemModelCache::update()
+{
+    const quint32 timeStamp = KSycoca::self()->timeStamp();
+    if (timeStamp == m_sycocaTimeStamp) {
+        return;
+    }
+    m_sycocaTimeStamp = timeStamp;
+    if (m_trashModel) {
+        m_trashModel->clear();
+        fillTrashModel(m_trashModel, m_trashMimeType);
+    }
+    for (auto it = m_modelForMimeType.constBegin(), end = m_modelForMimeType.constEnd(); it != end; ++it) {
+        it.value()->clear();
+        fillModelForMimeType(it.value(), it.key());
+    }
+}
+
+ActionListModel *sharedModelForFileItem(const KFileItem &fileItem)
+{
+    FileItemModelCache *cache = fileItemModelCache();
+    if (fileItem.url() == KUrl("trash:/")) {
+        if (!cache->m_trashModel) {
+            cache->m_trashModel = new ActionListModel(cache);
+            cache->m_trashMimeType = fileItem.mimetype();
+            fillTrashModel(cache->m_trashModel, cache->m_trashMimeType);
+        }
+        // The state of the trash changes, but not its actions
+        cache->m_trashModel->setEnabled(0, !isTrashEmpty());
+        return cache->m_trashModel;
+    }
+
+    const QString mimeType = fileItem.mimetype();
+    ActionListModel *model = cache->m_modelForMimeType.value(mimeType);
+    if (!model) {
+        model = new ActionListModel(cache);
+        fillModelForMimeType(model, mimeType);
+        cache->m_modelForMimeType.insert(mimeType, model);
+    }
+    return model;
+}
+
 bool handleFileItemAction(const KFileItem &fileItem, const QString &actionId, const QVariant &actionArg, bool *close)
 {
     if (actionId == "_homerun_fileItem_properties") {
@@ -33,6 +33,8 @@ class KFileItem;
 namespace Homerun
 {
 
+class ActionListModel;
+
 /**
  * Helper functions to create action list items
  */
@@ -47,6 +49,17 @@ QVariantMap HOMERUN_EXPORT createSeparatorActionItem();
 
 QVariantList HOMERUN_EXPORT createListForFileItem(const KFileItem &fileItem);
 
+/**
+ * Returns the actions of createListForFileItem() as an ActionListModel. The
+ * model is shared by all the file items of the same mime type and is owned by
+ * libhomerun: do not delete it. When the application database changes, shared
+ * models are refilled in place, so a model stays valid as long as the
+ * application runs.
+ *
+ * Available since libhomerun 0.5.
+ */
+HOMERUN_EXPORT ActionListModel *sharedModelForFileItem(const KFileItem &fileItem);
+
 /**
  * Handle action if it has been created by this namespace
  * @param fileItem The file item for which the action was created
@@ -0,0 +1,255 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <actionlistmodel.h>
+
+// Local
+
+// KDE
+#include <KDebug>
+
+// Qt
+#include <QVector>
+
+namespace Homerun {
+
+struct ActionListItem
+{
+    ActionListItem()
+    : type(ActionListModel::ActionItem)
+    , enabled(true)
+    {}
+
+    QString text;
+    QIcon icon;
+    QString actionId;
+    QVariant actionArgument;
+    ActionListModel::ItemType type;
+    bool enabled;
+};
+
+struct ActionListModelPrivate
+{
+    QVector<ActionListItem> m_items;
+
+    const ActionListItem *itemAt(int row) const
+    {
+        if (row < 0 || row >= m_items.count()) {
+            kWarning() << "Invalid row" << row;
+            return 0;
+        }
+        return &m_items.at(row);
+    }
+};
+
+static QString typeName(ActionListModel::ItemType type)
+{
+    switch (type) {
+    case ActionListModel::TitleItem:
+        return "title";
+    case ActionListModel::SeparatorItem:
+        return "separator";
+    case ActionListModel::ActionItem:
+        break;
+    }
+    return "action";
+}
+
+ActionListModel::ActionListModel(QObject *parent)
+: QAbstractListModel(parent)
+, d(new ActionListModelPrivate)
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(TextRole, "text");
+    roles.insert(IconRole, "icon");
+    roles.insert(ActionIdRole, "actionId");
+    roles.insert(ActionArgumentRole, "actionArgument");
+    roles.insert(TypeRole, "type");
+    roles.insert(EnabledRole, "enabled");
+    setRoleNames(roles);
+    connect(this, SIGNAL(modelReset()), SIGNAL(countChanged()));
+    connect(this, SIGNAL(rowsInserted(QModelIndex, int, int)), SIGNAL(countChanged()));
+    connect(this, SIGNAL(rowsRemoved(QModelIndex, int, int)), SIGNAL(countChanged()));
+}
+
+ActionListModel::~ActionListModel()
+{
+    delete d;
+}
+
+int ActionListModel::addAction(const QString &text, const QString &actionId, const QVariant &actionArg, const QIcon &icon)
+{
+    ActionListItem item;
+    item.text = text;
+    item.icon = icon;
+    item.actionId = actionId;
+    item.actionArgument = actionArg;
+    return appendItem(item);
+}
+
+int ActionListModel::addTitle(const QString &text)
+{
+    ActionListItem item;
+    item.text = text;
+    item.type = TitleItem;
+    return appendItem(item);
+}
+
+int ActionListModel::addSeparator()
+{
+    ActionListItem item;
+    item.type = SeparatorItem;
+    return appendItem(item);
+}
+
+int ActionListModel::appendItem(const ActionListItem &item)
+{
+    const int row = d->m_items.count();
+    beginInsertRows(QModelIndex(), row, row);
+    d->m_items << item;
+    endInsertRows();
+    return row;
+}
+
+void ActionListModel::setEnabled(int row, bool enabled)
+{
+    if (!d->itemAt(row)) {
+        return;
+    }
+    ActionListItem &item = d->m_items[row];
+    if (item.enabled == enabled) {
+        return;
+    }
+    item.enabled = enabled;
+    QModelIndex idx = index(row, 0);
+    dataChanged(idx, idx);
+}
+
+void ActionListModel::clear()
+{
+    beginResetModel();
+    d->m_items.clear();
+    endResetModel();
+}
+
+int ActionListModel::count() const
+{
+    return d->m_items.count();
+}
+
+int ActionListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return d->m_items.count();
+}
+
+QVariant ActionListModel::data(const QModelIndex &index, int role) const
+{
+    const ActionListItem *item = d->itemAt(index.row());
+    if (!item) {
+        return QVariant();
+    }
+    switch (role) {
+    case TextRole:
+        return item->text;
+    case IconRole:
+        return item->icon.isNull() ? QVariant() : QVariant(item->icon);
+    case ActionIdRole:
+        return item->actionId;
+    case ActionArgumentRole:
+        return item->actionArgument;
+    case TypeRole:
+        return typeName(item->type);
+    case EnabledRole:
+        return item->enabled;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QString ActionListModel::text(int row) const
+{
+    const ActionListItem *item = d->itemAt(row);
+    return item ? item->text : QString();
+}
+
+QVariant ActionListModel::icon(int row) const
+{
+    return data(index(row, 0), IconRole);
+}
+
+QString ActionListModel::actionId(int row) const
+{
+    const ActionListItem *item = d->itemAt(row);
+    return item ? item->actionId : QString();
+}
+
+QVariant ActionListModel::actionArgument(int row) const
+{
+    const ActionListItem *item = d->itemAt(row);
+    return item ? item->actionArgument : QVariant();
+}
+
+QString ActionListModel::type(int row) const
+{
+    const ActionListItem *item = d->itemAt(row);
+    return item ? typeName(item->type) : QString();
+}
+
+bool ActionListModel::isEnabled(int row) const
+{
+    const ActionListItem *item = d->itemAt(row);
+    return item ? item->enabled : false;
+}
+
+QVariantList ActionListModel::toVariantList() const
+{
+    QVariantList list;
+    Q_FOREACH(const ActionListItem &item, d->m_items) {
+        QVariantMap map;
+        if (item.type != ActionItem) {
+            map["type"] = typeName(item.type);
+        }
+        if (item.type != SeparatorItem) {
+            map["text"] = item.text;
+        }
+        if (!item.icon.isNull()) {
+            map["icon"] = item.icon;
+        }
+        if (item.type == ActionItem) {
+            map["actionId"] = item.actionId;
+            if (item.actionArgument.isValid()) {
+                map["actionArgument"] = item.actionArgument;
+            }
+        }
+        if (!item.enabled) {
+            map["enabled"] = false;
+        }
+        list << map;
+    }
+    return list;
+}
+
+} // namespace Homerun
+
+#include <actionlistmodel.moc>
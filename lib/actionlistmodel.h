@@ -0,0 +1,124 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ACTIONLISTMODEL_H
+#define ACTIONLISTMODEL_H
+
+// Local
+#include <homerun_export.h>
+
+// Qt
+#include <QAbstractListModel>
+#include <QIcon>
+
+// KDE
+
+namespace Homerun {
+
+struct ActionListItem;
+class ActionListModelPrivate;
+
+/**
+ * A typed list of actions, which can be returned by the actionList role of a
+ * Homerun model instead of a QVariantList of QVariantMap.
+ *
+ * Since it does not depend on the item it is returned for, an ActionListModel
+ * can be built once and returned for all the items sharing the same actions.
+ * Homerun menus read the actions from it directly.
+ *
+ * @see @ref homerunmodel
+ *
+ * Available since libhomerun 0.5.
+ */
+class HOMERUN_EXPORT ActionListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+public:
+    enum {
+        TextRole = Qt::DisplayRole,
+        IconRole = Qt::DecorationRole,
+        ActionIdRole = Qt::UserRole + 1,
+        ActionArgumentRole,
+        TypeRole,
+        EnabledRole
+    };
+
+    enum ItemType {
+        ActionItem,
+        TitleItem,
+        SeparatorItem
+    };
+
+    explicit ActionListModel(QObject *parent = 0);
+    ~ActionListModel();
+
+    /**
+     * Appends an action. Returns its row.
+     */
+    int addAction(const QString &text, const QString &actionId, const QVariant &actionArg = QVariant(), const QIcon &icon = QIcon());
+
+    /**
+     * Appends a title. Returns its row.
+     */
+    int addTitle(const QString &text);
+
+    /**
+     * Appends a separator. Returns its row.
+     */
+    int addSeparator();
+
+    void setEnabled(int row, bool enabled);
+
+    void clear();
+
+    int count() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+    Q_INVOKABLE QString text(int row) const;
+    Q_INVOKABLE QVariant icon(int row) const;
+    Q_INVOKABLE QString actionId(int row) const;
+    Q_INVOKABLE QVariant actionArgument(int row) const;
+    /**
+     * Returns "action", "title" or "separator", as in the QVariantMap form
+     * of the actionList role
+     */
+    Q_INVOKABLE QString type(int row) const;
+    Q_INVOKABLE bool isEnabled(int row) const;
+
+    /**
+     * Returns the actions in the QVariantList form of the actionList role,
+     * for code which cannot handle an ActionListModel
+     */
+    Q_INVOKABLE QVariantList toVariantList() const;
+
+Q_SIGNALS:
+    void countChanged();
+
+private:
+    int appendItem(const ActionListItem &item);
+
+    ActionListModelPrivate * const d;
+};
+
+} // namespace Homerun
+
+#endif /* ACTIONLISTMODEL_H */
@@ -0,0 +1,128 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <asyncmodel.h>
+
+// Local
+
+// KDE
+#include <KConfigGroup>
+#include <KDebug>
+
+// Qt
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
+
+namespace Homerun {
+
+struct AsyncModelPrivate
+{
+    AsyncModelPrivate()
+    : m_function(0)
+    , m_watcher(0)
+    {}
+
+    AsyncModel::LoadFunction m_function;
+    QVariantMap m_args;
+    QFutureWatcher<QVariant> *m_watcher;
+};
+
+AsyncModel::AsyncModel(QObject *parent)
+: QAbstractListModel(parent)
+, d(new AsyncModelPrivate)
+{
+    connect(this, SIGNAL(modelReset()), SIGNAL(countChanged()));
+    connect(this, SIGNAL(rowsInserted(QModelIndex, int, int)), SIGNAL(countChanged()));
+    connect(this, SIGNAL(rowsRemoved(QModelIndex, int, int)), SIGNAL(countChanged()));
+}
+
+AsyncModel::~AsyncModel()
+{
+    // Delete the watcher now rather than leaving it to ~QObject(), so that
+    // slotLoadFinished() cannot be called for a load which is still running
+    // once d is gone. The worker thread keeps running and its result is
+    // dropped.
+    delete d->m_watcher;
+    delete d;
+}
+
+void AsyncModel::startLoading(LoadFunction function, const QVariantMap &args)
+{
+    Q_ASSERT(function);
+    d->m_function = function;
+    d->m_args = args;
+
+    bool wasRunning = running();
+    if (d->m_watcher) {
+        // Forget about the previous load, its result is obsolete
+        d->m_watcher->disconnect(this);
+        d->m_watcher->deleteLater();
+    }
+    d->m_watcher = new QFutureWatcher<QVariant>(this);
+    connect(d->m_watcher, SIGNAL(finished()), SLOT(slotLoadFinished()));
+    d->m_watcher->setFuture(QtConcurrent::run(function, args));
+
+    if (!wasRunning) {
+        runningChanged(true);
+    }
+}
+
+void AsyncModel::reload()
+{
+    if (!d->m_function) {
+        kWarning() << "startLoading() has never been called";
+        return;
+    }
+    startLoading(d->m_function, d->m_args);
+}
+
+void AsyncModel::slotLoadFinished()
+{
+    QFutureWatcher<QVariant> *watcher = d->m_watcher;
+    d->m_watcher = 0;
+    populate(watcher->result());
+    watcher->deleteLater();
+    runningChanged(false);
+}
+
+int AsyncModel::count() const
+{
+    return rowCount();
+}
+
+bool AsyncModel::running() const
+{
+    return d->m_watcher;
+}
+
+QVariantMap AsyncModel::argumentsFromConfigGroup(const KConfigGroup &group)
+{
+    QVariantMap args;
+    const QMap<QString, QString> entries = group.entryMap();
+    QMap<QString, QString>::ConstIterator it = entries.constBegin(), end = entries.constEnd();
+    for (; it != end; ++it) {
+        args.insert(it.key(), it.value());
+    }
+    return args;
+}
+
+} // namespace Homerun
+
+#include <asyncmodel.moc>
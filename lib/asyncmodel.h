@@ -0,0 +1,156 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ASYNCMODEL_H
+#define ASYNCMODEL_H
+
+// Local
+#include <abstractsource.h>
+#include <homerun_export.h>
+
+// Qt
+#include <QAbstractListModel>
+#include <QVariant>
+
+// KDE
+
+class KConfigGroup;
+
+namespace Homerun {
+
+class AsyncModelPrivate;
+
+/**
+ * Base class for models which are filled from a worker thread.
+ *
+ * An AsyncModel starts empty, with its running property set to true, so that
+ * Homerun can show it immediately along with a busy indicator. The expensive
+ * part of the work is done by a load function running in a worker thread.
+ * When it is done, the data it returned is handed to populate() in the GUI
+ * thread and running goes back to false.
+ *
+ * The load function is a plain function, not a method, because the model may
+ * be deleted while it runs: the load function must not touch the model or any
+ * other GUI object. If the model is deleted before loading is done, the data
+ * is silently dropped.
+ *
+ * Most sources do not need to call startLoading() themselves: use
+ * AsyncSimpleSource instead.
+ *
+ * Available since libhomerun 0.2.
+ */
+class HOMERUN_EXPORT AsyncModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+public:
+    /**
+     * A function called in a worker thread to produce the model data
+     *
+     * @param args The source arguments
+     * @return data which will be passed to populate()
+     */
+    typedef QVariant (*LoadFunction)(const QVariantMap &args);
+
+    explicit AsyncModel(QObject *parent = 0);
+    ~AsyncModel();
+
+    /**
+     * Runs @p function with @p args in a worker thread. If a previous load is
+     * still in progress, its result is discarded.
+     */
+    void startLoading(LoadFunction function, const QVariantMap &args);
+
+    /**
+     * Starts loading again, with the function and arguments given to the last
+     * call to startLoading()
+     */
+    Q_INVOKABLE void reload();
+
+    int count() const;
+
+    bool running() const;
+
+    /**
+     * Returns the entries of @p group as a map, suitable for a load function.
+     * KConfigGroup must not be used from a worker thread, so the entries must
+     * be read before the load starts.
+     */
+    static QVariantMap argumentsFromConfigGroup(const KConfigGroup &group);
+
+Q_SIGNALS:
+    void countChanged();
+    void runningChanged(bool);
+
+protected:
+    /**
+     * Called in the GUI thread with the data returned by the load function.
+     * Reimplement this method to fill the model, wrapping the changes in
+     * beginResetModel()/endResetModel() or beginInsertRows()/endInsertRows().
+     */
+    virtual void populate(const QVariant &data) = 0;
+
+private Q_SLOTS:
+    void slotLoadFinished();
+
+private:
+    AsyncModelPrivate * const d;
+};
+
+/**
+ * An asynchronous variant of SimpleSource.
+ *
+ * T must inherit from AsyncModel and provide a static load function with this
+ * signature:
+ *
+ * @code
+ * static QVariant load(const QVariantMap &args);
+ * @endcode
+ *
+ * The source returns a new, empty T right away and runs T::load() in a worker
+ * thread. The arguments are either the entries of the source configuration
+ * group or the arguments passed to createModelFromArguments().
+ *
+ * Available since libhomerun 0.2.
+ */
+template<class T>
+class HOMERUN_EXPORT AsyncSimpleSource : public AbstractSource
+{
+public:
+    AsyncSimpleSource(QObject *parent, const QVariantList &args = QVariantList())
+    : AbstractSource(parent, args)
+    {}
+
+    QAbstractItemModel *createModelFromConfigGroup(const KConfigGroup &group)
+    {
+        return createModelFromArguments(AsyncModel::argumentsFromConfigGroup(group));
+    }
+
+    QAbstractItemModel *createModelFromArguments(const QVariantMap &args)
+    {
+        T *model = new T;
+        model->startLoading(&T::load, args);
+        return model;
+    }
+};
+
+} // namespace Homerun
+
+#endif /* ASYNCMODEL_H */
@@ -0,0 +1,67 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <rowdata.h>
+
+// Local
+
+// KDE
+
+// Qt
+
+namespace Homerun
+{
+
+namespace RowData
+{
+
+QVector<int> roleIds(const QAbstractItemModel *model, const QStringList &roleNames)
+{
+    Q_ASSERT(model);
+    const QHash<int, QByteArray> names = model->roleNames();
+    QVector<int> roles;
+    roles.reserve(roleNames.count());
+    Q_FOREACH(const QString &name, roleNames) {
+        roles << names.key(name.toUtf8(), -1);
+    }
+    return roles;
+}
+
+QVariantList fetch(const QAbstractItemModel *model, int first, int count, const QStringList &roleNames)
+{
+    const QVector<int> roles = roleIds(model, roleNames);
+    const int end = qMin(first + count, model->rowCount(QModelIndex()));
+    QVariantList rows;
+    for (int row = qMax(first, 0); row < end; ++row) {
+        const QModelIndex index = model->index(row, 0);
+        QVariantMap map;
+        for (int idx = 0; idx < roles.count(); ++idx) {
+            if (roles.at(idx) != -1) {
+                map.insert(roleNames.at(idx), index.data(roles.at(idx)));
+            }
+        }
+        rows << map;
+    }
+    return rows;
+}
+
+} // namespace RowData
+
+} // namespace Homerun
@@ -0,0 +1,98 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ROWDATA_H
+#define ROWDATA_H
+
+// Local
+#include <homerun_export.h>
+
+// Qt
+#include <QAbstractItemModel>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+// KDE
+
+namespace Homerun
+{
+
+/**
+ * Helper functions to implement the rowData() method of Homerun models, which
+ * returns the data of several roles for a range of rows in one call.
+ *
+ * @see @ref homerunmodel
+ *
+ * Available since libhomerun 0.4.
+ */
+namespace RowData
+{
+
+/**
+ * Returns the role id of each name of @p roleNames, or -1 if @p model does
+ * not define it
+ */
+QVector<int> HOMERUN_EXPORT roleIds(const QAbstractItemModel *model, const QStringList &roleNames);
+
+/**
+ * Generic implementation of rowData(), which calls data() for each role of
+ * each row. Rows outside of the model are skipped.
+ */
+QVariantList HOMERUN_EXPORT fetch(const QAbstractItemModel *model, int first, int count, const QStringList &roleNames);
+
+/**
+ * Implementation of rowData() for models which can look up the object behind
+ * a row once and get the data of all roles from it.
+ *
+ * @code
+ * QVariantList MyModel::rowData(int first, int count, const QStringList &roleNames) const
+ * {
+ *     return RowData::fetch(this, first, count, roleNames, &MyModel::itemAt, &MyModel::itemData);
+ * }
+ * @endcode
+ *
+ * @param rowAt Returns the object behind a row
+ * @param roleData Returns the data of a role for an object returned by @p rowAt
+ */
+template<class Model, class Row, class RowArg>
+QVariantList fetch(const Model *model, int first, int count, const QStringList &roleNames,
+    Row (Model::*rowAt)(int row) const,
+    QVariant (Model::*roleData)(RowArg row, int role) const)
+{
+    const QVector<int> roles = roleIds(model, roleNames);
+    const int end = qMin(first + count, model->rowCount(QModelIndex()));
+    QVariantList rows;
+    for (int row = qMax(first, 0); row < end; ++row) {
+        const Row object = (model->*rowAt)(row);
+        QVariantMap map;
+        for (int idx = 0; idx < roles.count(); ++idx) {
+            if (roles.at(idx) != -1) {
+                map.insert(roleNames.at(idx), (model->*roleData)(object, roles.at(idx)));
+            }
+        }
+        rows << map;
+    }
+    return rows;
+}
+
+} // namespace RowData
+} // namespace Homerun
+
+#endif /* ROWDATA_H */
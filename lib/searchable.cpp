@@ -0,0 +1,185 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <searchable.h>
+
+// Local
+#include <textfilter.h>
+
+// KDE
+
+// Qt
+#include <QAbstractItemModel>
+#include <QSharedData>
+
+using namespace HomerunInternal;
+
+namespace Homerun {
+
+// Number of rows to check between two checks of the canceled state
+static const int CANCEL_CHECK_INTERVAL = 256;
+
+//- SearchQuery --------------------------------------------------------
+class SearchQueryPrivate : public QSharedData
+{
+public:
+    SearchQueryPrivate(const QString &text, int maxResults)
+    : m_text(text)
+    , m_maxResults(maxResults)
+    {}
+
+    QString m_text;
+    int m_maxResults;
+    QAtomicInt m_canceled;
+};
+
+SearchQuery::SearchQuery()
+: d(new SearchQueryPrivate(QString(), 0))
+{}
+
+SearchQuery::SearchQuery(const QString &text, int maxResults)
+: d(new SearchQueryPrivate(text, maxResults))
+{}
+
+SearchQuery::SearchQuery(const SearchQuery &other)
+: d(other.d)
+{}
+
+SearchQuery::~SearchQuery()
+{}
+
+SearchQuery &SearchQuery::operator=(const SearchQuery &other)
+{
+    d = other.d;
+    return *this;
+}
+
+QString SearchQuery::text() const
+{
+    return d->m_text;
+}
+
+int SearchQuery::maxResults() const
+{
+    return d->m_maxResults;
+}
+
+bool SearchQuery::isCanceled() const
+{
+    return d->m_canceled != 0;
+}
+
+void SearchQuery::cancel()
+{
+    d->m_canceled.fetchAndStoreOrdered(1);
+}
+
+//- SearchTask ---------------------------------------------------------
+SearchTask::~SearchTask()
+{}
+
+//- TextSearchTask -----------------------------------------------------
+struct TextSearchTaskPrivate
+{
+    void setTexts(const QStringList &texts)
+    {
+        m_keys.reserve(texts.count());
+        Q_FOREACH(const QString &text, texts) {
+            m_keys << TextFilter::foldedKey(text);
+        }
+    }
+
+    QStringList m_keys;
+    // Folded text of the last query which ran to completion, and the rows it
+    // accepted
+    QString m_lastQuery;
+    QList<SearchResult> m_lastResults;
+};
+
+static bool scoreGreaterThan(const SearchResult &r1, const SearchResult &r2)
+{
+    return r1.score > r2.score;
+}
+
+TextSearchTask::TextSearchTask(const QStringList &texts)
+: d(new TextSearchTaskPrivate)
+{
+    d->setTexts(texts);
+}
+
+TextSearchTask::TextSearchTask(const QAbstractItemModel *model, int role)
+: d(new TextSearchTaskPrivate)
+{
+    Q_ASSERT(model);
+    QStringList texts;
+    const int count = model->rowCount();
+    for (int row = 0; row < count; ++row) {
+        texts << model->index(row, 0).data(role).toString();
+    }
+    d->setTexts(texts);
+}
+
+TextSearchTask::~TextSearchTask()
+{
+    delete d;
+}
+
+QList<SearchResult> TextSearchTask::run(const SearchQuery &query)
+{
+    QList<SearchResult> results;
+    if (query.text().isEmpty() || query.isCanceled()) {
+        return results;
+    }
+    const QString foldedQuery = TextFilter::foldedKey(query.text());
+
+    // Rows are matched here rather than with TextFilter::setQuery(), so that
+    // cancelation is checked while matching. A canceled run leaves the state
+    // of the last completed one untouched.
+    // If the new query extends the previous one, rows which did not match
+    // before cannot match now: only look at the accepted ones
+    const bool refine = !d->m_lastQuery.isEmpty() && foldedQuery.startsWith(d->m_lastQuery);
+    const int count = refine ? d->m_lastResults.count() : d->m_keys.count();
+    for (int idx = 0; idx < count; ++idx) {
+        if (idx % CANCEL_CHECK_INTERVAL == 0 && query.isCanceled()) {
+            return QList<SearchResult>();
+        }
+        const int row = refine ? d->m_lastResults.at(idx).row : idx;
+        const int score = TextFilter::match(TextFilter::LiteralMode, d->m_keys.at(row), foldedQuery);
+        if (score != -1) {
+            results << SearchResult(row, score);
+        }
+    }
+    // Still in model order
+    d->m_lastQuery = foldedQuery;
+    d->m_lastResults = results;
+
+    // Stable, so that equally relevant rows keep the model order
+    qStableSort(results.begin(), results.end(), scoreGreaterThan);
+    if (query.maxResults() >= 0 && results.count() > query.maxResults()) {
+        results.erase(results.begin() + query.maxResults(), results.end());
+    }
+    return results;
+}
+
+//- Searchable ---------------------------------------------------------
+Searchable::~Searchable()
+{}
+
+} // namespace Homerun
@@ -0,0 +1,184 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SEARCHABLE_H
+#define SEARCHABLE_H
+
+// Local
+#include <homerun_export.h>
+
+// Qt
+#include <QExplicitlySharedDataPointer>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+// KDE
+
+class QAbstractItemModel;
+
+namespace Homerun {
+
+class SearchQueryPrivate;
+
+/**
+ * A search query, as passed to SearchTask::run().
+ *
+ * Copies of a SearchQuery share their canceled state: when Homerun cancels a
+ * query because the user typed something else, all copies report it.
+ */
+class HOMERUN_EXPORT SearchQuery
+{
+public:
+    SearchQuery();
+    SearchQuery(const QString &text, int maxResults);
+    SearchQuery(const SearchQuery &other);
+    ~SearchQuery();
+
+    SearchQuery &operator=(const SearchQuery &other);
+
+    QString text() const;
+
+    /**
+     * The maximum number of results to return. Only the most relevant ones
+     * should be returned. A negative value means there is no limit.
+     */
+    int maxResults() const;
+
+    /**
+     * Returns true once the query has been superseded. Long searches should
+     * check it regularly and return early, their results will be ignored.
+     */
+    bool isCanceled() const;
+
+    /**
+     * Marks this query and all its copies as canceled
+     */
+    void cancel();
+
+private:
+    QExplicitlySharedDataPointer<SearchQueryPrivate> d;
+};
+
+/**
+ * A search result: a row of the searched model and its relevance
+ */
+struct SearchResult
+{
+    SearchResult(int row_ = -1, int score_ = 0)
+    : row(row_)
+    , score(score_)
+    {}
+
+    int row;
+
+    /**
+     * Relevance of the row, higher is better. Results of all sources are
+     * merged by score, so sources should stay close to the scores returned
+     * by TextSearchTask.
+     */
+    int score;
+};
+
+/**
+ * Performs searches on a snapshot of a model.
+ *
+ * A task is created in the GUI thread by Searchable::createSearchTask() and
+ * run in a worker thread. It must not access the model or any other object
+ * living in the GUI thread: everything it needs must be copied when it is
+ * created.
+ *
+ * run() is never called concurrently on the same task, and is called with
+ * queries in the order the user typed them, so a task can keep state from
+ * one query to the next, for example to only check the rows which matched
+ * the previous query when the new query extends it.
+ */
+class HOMERUN_EXPORT SearchTask
+{
+public:
+    virtual ~SearchTask();
+
+    /**
+     * Called in a worker thread
+     * @return at most query.maxResults() results, most relevant first
+     */
+    virtual QList<SearchResult> run(const SearchQuery &query) = 0;
+};
+
+class TextSearchTaskPrivate;
+
+/**
+ * A SearchTask matching the query against a list of texts, one per row.
+ *
+ * Texts are matched case-insensitively, the query can appear anywhere in the
+ * text. Texts starting with the query, then texts with a word starting with
+ * the query, rank first. When the query extends the previous one, only texts
+ * which matched the previous query are checked again.
+ */
+class HOMERUN_EXPORT TextSearchTask : public SearchTask
+{
+public:
+    explicit TextSearchTask(const QStringList &texts);
+
+    /**
+     * Takes a snapshot of the @p role data of all the rows of @p model. Must
+     * be called in the thread of @p model.
+     */
+    TextSearchTask(const QAbstractItemModel *model, int role);
+
+    ~TextSearchTask();
+
+    QList<SearchResult> run(const SearchQuery &query); // reimp
+
+private:
+    TextSearchTaskPrivate * const d;
+};
+
+/**
+ * Interface for models which can be searched by Homerun global search.
+ *
+ * Searchable models are searched in parallel with a single query and their
+ * results are merged by relevance, instead of each model filtering itself
+ * through its query property.
+ *
+ * To make a model searchable, inherit from this class and add
+ * Q_INTERFACES(Homerun::Searchable) to the model declaration. The model must
+ * also implement the trigger() method described in @ref homerunmodel, which
+ * is called with the rows of the search results.
+ *
+ * Available since libhomerun 0.3.
+ */
+class HOMERUN_EXPORT Searchable
+{
+public:
+    virtual ~Searchable();
+
+    /**
+     * Called in the GUI thread to create a task searching the current
+     * content of the model. Homerun takes ownership of the task and creates a
+     * new one when the model changes.
+     */
+    virtual SearchTask *createSearchTask() = 0;
+};
+
+} // namespace Homerun
+
+Q_DECLARE_INTERFACE(Homerun::Searchable, "org.kde.homerun.Searchable/1.0")
+
+#endif /* SEARCHABLE_H */
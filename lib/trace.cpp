@@ -0,0 +1,260 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <trace.h>
+
+// Local
+
+// KDE
+#include <KDebug>
+
+// Qt
+#include <QAbstractItemModel>
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaProperty>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+namespace Homerun {
+
+namespace Trace
+{
+
+struct TraceData
+{
+    QMutex mutex;
+    QFile file;
+    QElapsedTimer timer;
+    bool hasEvents;
+};
+
+// Read by spans from any thread, written by start() and stop()
+static QBasicAtomicInt s_enabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static TraceData *traceData()
+{
+    static TraceData data;
+    return &data;
+}
+
+static QByteArray escape(const QString &text)
+{
+    QByteArray out = text.toUtf8();
+    out.replace('\\', "\\\\");
+    out.replace('"', "\\\"");
+    out.replace('\n', "\\n");
+    out.replace('\t', "\\t");
+    return out;
+}
+
+// Events are written as soon as they are complete, in the JSON array format,
+// which does not require a closing bracket: the file can be loaded at any
+// time, even if Homerun is still running
+static void writeEvent(const char *name, char phase, qint64 startTime, qint64 duration, const QString &detail)
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    if (!data->file.isOpen()) {
+        return;
+    }
+    QByteArray line;
+    line += data->hasEvents ? ",\n" : "\n";
+    line += "{\"name\":\"";
+    line += escape(QString::fromUtf8(name));
+    line += "\",\"cat\":\"homerun\",\"ph\":\"";
+    line += phase;
+    line += "\",\"ts\":";
+    line += QByteArray::number(startTime);
+    if (phase == 'X') {
+        line += ",\"dur\":";
+        line += QByteArray::number(duration);
+    } else {
+        // Instant events are drawn across the whole process
+        line += ",\"s\":\"p\"";
+    }
+    line += ",\"pid\":";
+    line += QByteArray::number(QCoreApplication::applicationPid());
+    line += ",\"tid\":";
+    line += QByteArray::number(quint64(quintptr(QThread::currentThreadId())));
+    if (!detail.isEmpty()) {
+        line += ",\"args\":{\"detail\":\"";
+        line += escape(detail);
+        line += "\"}";
+    }
+    line += '}';
+    data->file.write(line);
+    data->file.flush();
+    data->hasEvents = true;
+}
+
+bool start(const QString &fileName)
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    if (data->file.isOpen()) {
+        kWarning() << "Already tracing to" << data->file.fileName();
+        return false;
+    }
+    data->file.setFileName(fileName);
+    if (!data->file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        kWarning() << "Cannot open" << fileName << "for writing. Error" << data->file.error();
+        return false;
+    }
+    data->file.write("[");
+    data->hasEvents = false;
+    data->timer.start();
+    // Publish the timer before spans can use it
+    s_enabled.fetchAndStoreRelease(1);
+    return true;
+}
+
+void stop()
+{
+    TraceData *data = traceData();
+    QMutexLocker locker(&data->mutex);
+    if (!data->file.isOpen()) {
+        return;
+    }
+    s_enabled.fetchAndStoreRelease(0);
+    data->file.write("\n]\n");
+    data->file.close();
+}
+
+bool isEnabled()
+{
+    return s_enabled;
+}
+
+qint64 now()
+{
+    if (!s_enabled) {
+        return -1;
+    }
+    return traceData()->timer.nsecsElapsed() / 1000;
+}
+
+void addSpan(const char *name, qint64 startTime, const QString &detail)
+{
+    if (!s_enabled || startTime < 0) {
+        return;
+    }
+    writeEvent(name, 'X', startTime, now() - startTime, detail);
+}
+
+void addInstant(const char *name, const QString &detail)
+{
+    if (!s_enabled) {
+        return;
+    }
+    writeEvent(name, 'i', now(), 0, detail);
+}
+
+/**
+ * Waits for a model to be populated, then records a span and deletes itself
+ */
+class PopulationWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    PopulationWatcher(QObject *model, const char *name, qint64 startTime, const QString &detail)
+    : QObject(model)
+    , m_model(model)
+    , m_name(name)
+    , m_startTime(startTime)
+    , m_detail(detail)
+    , m_wasRunning(model->property("running").toBool())
+    {
+        connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(check()));
+        connect(model, SIGNAL(modelReset()), SLOT(check()));
+        connect(model, SIGNAL(layoutChanged()), SLOT(check()));
+        const QMetaObject *metaObject = model->metaObject();
+        int index = metaObject->indexOfProperty("running");
+        if (index >= 0 && metaObject->property(index).hasNotifySignal()) {
+            QByteArray signal = QByteArray::number(QSIGNAL_CODE) + metaObject->property(index).notifySignal().signature();
+            connect(model, signal.constData(), SLOT(check()));
+        }
+    }
+
+public Q_SLOTS:
+    void check()
+    {
+        if (!isPopulated()) {
+            return;
+        }
+        addSpan(m_name, m_startTime, m_detail);
+        disconnect(m_model, 0, this, 0);
+        deleteLater();
+    }
+
+private:
+    QObject *m_model;
+    const char *m_name;
+    qint64 m_startTime;
+    QString m_detail;
+    bool m_wasRunning;
+
+    bool isPopulated()
+    {
+        QAbstractItemModel *itemModel = qobject_cast<QAbstractItemModel *>(m_model);
+        if (itemModel && itemModel->rowCount() > 0) {
+            return true;
+        }
+        // Empty models are populated once they are done running
+        if (m_model->property("running").toBool()) {
+            m_wasRunning = true;
+            return false;
+        }
+        return m_wasRunning;
+    }
+};
+
+void addPopulationSpan(QObject *model, const char *name, qint64 startTime, const QString &detail)
+{
+    if (!s_enabled || startTime < 0 || !model) {
+        return;
+    }
+    PopulationWatcher *watcher = new PopulationWatcher(model, name, startTime, detail);
+    // The model may have been populated synchronously
+    watcher->check();
+}
+
+} // namespace Trace
+
+TraceSpan::TraceSpan(const char *name, const QString &detail)
+: m_name(name)
+, m_startTime(Trace::now())
+{
+    if (m_startTime >= 0) {
+        m_detail = detail;
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    Trace::addSpan(m_name, m_startTime, m_detail);
+}
+
+} // namespace Homerun
+
+#include <trace.moc>
@@ -0,0 +1,115 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) version 3, or any
+later version accepted by the membership of KDE e.V. (or its
+successor approved by the membership of KDE e.V.), which shall
+act as a proxy defined in Section 6 of version 3 of the license.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRACE_H
+#define TRACE_H
+
+// Local
+#include <homerun_export.h>
+
+// Qt
+#include <QString>
+
+class QObject;
+
+// KDE
+
+namespace Homerun {
+
+/**
+ * Records the time spent in parts of Homerun, to find out where time goes
+ * during startup.
+ *
+ * Tracing is disabled by default, in which case spans cost a boolean check.
+ * Once start() has been called, each span is appended to a file using the
+ * Chrome trace-event format. Open the file in chrome://tracing to look at it.
+ *
+ * Spans can be recorded from any thread. start() and stop() can be called
+ * while other threads record spans.
+ */
+namespace Trace
+{
+
+/**
+ * Starts recording spans to @p fileName. Timestamps are relative to the call
+ * to this function, so it should be called as early as possible.
+ * @return false if the file could not be created
+ */
+HOMERUN_EXPORT bool start(const QString &fileName);
+
+/**
+ * Stops recording and closes the file
+ */
+HOMERUN_EXPORT void stop();
+
+HOMERUN_EXPORT bool isEnabled();
+
+/**
+ * Microseconds elapsed since start(), -1 if tracing is disabled
+ */
+HOMERUN_EXPORT qint64 now();
+
+/**
+ * Records a span which started at @p startTime, as returned by now(), and
+ * ends now. Useful for operations which do not fit in a scope.
+ */
+HOMERUN_EXPORT void addSpan(const char *name, qint64 startTime, const QString &detail = QString());
+
+/**
+ * Records an event without duration, for example "first frame"
+ */
+HOMERUN_EXPORT void addInstant(const char *name, const QString &detail = QString());
+
+/**
+ * Records a span which started at @p startTime, as returned by now(), and
+ * ends when @p model is first populated: when it has rows, or when its
+ * "running" property, if any, becomes false. Does nothing if tracing is
+ * disabled.
+ */
+HOMERUN_EXPORT void addPopulationSpan(QObject *model, const char *name, qint64 startTime, const QString &detail = QString());
+
+} // namespace Trace
+
+/**
+ * Records the time spent between its construction and its destruction.
+ *
+ * @code
+ * void SomeClass::load()
+ * {
+ *     Homerun::TraceSpan span("SomeClass::load", fileName);
+ *     ...
+ * }
+ * @endcode
+ */
+class HOMERUN_EXPORT TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name, const QString &detail = QString());
+    ~TraceSpan();
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+    const char *m_name;
+    QString m_detail;
+    qint64 m_startTime;
+};
+
+} // namespace Homerun
+
+#endif /* TRACE_H */
@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 // Homerun
 #include <abstractsource.h>
 #include <actionlist.h>
+#include <actionlistmodel.h>
 
 // KDE
 #include <KDebug>
@@ -146,11 +147,10 @@ QVariant RecentDocumentsModel::data(const QModelIndex& index, int role) const
     }
     KUrl url = itm->data(UrlRole).toString();
     KFileItem item(KFileItem::Unknown, KFileItem::Unknown, url);
-    QVariantList actionList = Homerun::ActionList::createListForFileItem(item);
-
-    actionList.prepend(Homerun::ActionList::createSeparatorActionItem());
-    QVariantMap forgetAction = Homerun::ActionList::createActionItem(i18n("Forget Document"), "forget");
-    actionList.prepend(forgetAction);
+    QVariantList actionList;
+    actionList << Homerun::ActionList::createActionItem(i18n("Forget Document"), "forget");
+    actionList << Homerun::ActionList::createSeparatorActionItem();
+    actionList << QVariant::fromValue<QObject *>(Homerun::ActionList::sharedModelForFileItem(item));
 
     return actionList;
 }
@@ -0,0 +1,146 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "actionlistmodeltest.h"
+
+// Local
+#include <actionlistmodel.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QSignalSpy>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(ActionListModelTest, NoGUI)
+
+static void fillModel(ActionListModel *model)
+{
+    model->addTitle("Title");
+    model->addAction("Open", "open", QString("arg"));
+    model->addSeparator();
+    model->addAction("Properties", "properties");
+}
+
+void ActionListModelTest::initTestCase()
+{
+    qRegisterMetaType<QModelIndex>("QModelIndex");
+}
+
+void ActionListModelTest::testAddItems()
+{
+    ActionListModel model;
+    QSignalSpy countSpy(&model, SIGNAL(countChanged()));
+    QCOMPARE(model.addTitle("Title"), 0);
+    QCOMPARE(model.addAction("Open", "open", QString("arg")), 1);
+    QCOMPARE(model.addSeparator(), 2);
+    QCOMPARE(model.count(), 3);
+    QCOMPARE(countSpy.count(), 3);
+
+    QModelIndex index = model.index(1, 0);
+    QCOMPARE(index.data(ActionListModel::TextRole).toString(), QString("Open"));
+    QCOMPARE(index.data(ActionListModel::ActionIdRole).toString(), QString("open"));
+    QCOMPARE(index.data(ActionListModel::ActionArgumentRole).toString(), QString("arg"));
+    QCOMPARE(index.data(ActionListModel::TypeRole).toString(), QString("action"));
+    QCOMPARE(index.data(ActionListModel::EnabledRole).toBool(), true);
+    QVERIFY(!index.data(ActionListModel::IconRole).isValid());
+
+    QCOMPARE(model.index(0, 0).data(ActionListModel::TypeRole).toString(), QString("title"));
+    QCOMPARE(model.index(2, 0).data(ActionListModel::TypeRole).toString(), QString("separator"));
+}
+
+void ActionListModelTest::testAccessors()
+{
+    ActionListModel model;
+    fillModel(&model);
+
+    QCOMPARE(model.text(0), QString("Title"));
+    QCOMPARE(model.type(0), QString("title"));
+    QCOMPARE(model.actionId(1), QString("open"));
+    QCOMPARE(model.actionArgument(1).toString(), QString("arg"));
+    QCOMPARE(model.type(2), QString("separator"));
+    QCOMPARE(model.actionId(3), QString("properties"));
+    QVERIFY(!model.actionArgument(3).isValid());
+    QVERIFY(model.isEnabled(3));
+
+    // Invalid rows
+    QCOMPARE(model.text(4), QString());
+    QCOMPARE(model.type(-1), QString());
+    QVERIFY(!model.isEnabled(4));
+}
+
+void ActionListModelTest::testSetEnabled()
+{
+    ActionListModel model;
+    fillModel(&model);
+    QSignalSpy spy(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+
+    model.setEnabled(1, false);
+    QVERIFY(!model.isEnabled(1));
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<QModelIndex>().row(), 1);
+
+    // Setting the same value again does not emit dataChanged()
+    model.setEnabled(1, false);
+    QCOMPARE(spy.count(), 1);
+}
+
+void ActionListModelTest::testToVariantList()
+{
+    ActionListModel model;
+    fillModel(&model);
+    model.setEnabled(3, false);
+
+    QVariantList list = model.toVariantList();
+    QCOMPARE(list.count(), 4);
+
+    QVariantMap map = list.at(0).toMap();
+    QCOMPARE(map.value("type").toString(), QString("title"));
+    QCOMPARE(map.value("text").toString(), QString("Title"));
+
+    map = list.at(1).toMap();
+    QVERIFY(!map.contains("type"));
+    QCOMPARE(map.value("text").toString(), QString("Open"));
+    QCOMPARE(map.value("actionId").toString(), QString("open"));
+    QCOMPARE(map.value("actionArgument").toString(), QString("arg"));
+    QVERIFY(!map.contains("enabled"));
+
+    map = list.at(2).toMap();
+    QCOMPARE(map.value("type").toString(), QString("separator"));
+
+    map = list.at(3).toMap();
+    QCOMPARE(map.value("actionId").toString(), QString("properties"));
+    QVERIFY(!map.contains("actionArgument"));
+    QCOMPARE(map.value("enabled").toBool(), false);
+}
+
+void ActionListModelTest::testClear()
+{
+    ActionListModel model;
+    fillModel(&model);
+    QSignalSpy countSpy(&model, SIGNAL(countChanged()));
+
+    model.clear();
+    QCOMPARE(model.count(), 0);
+    QCOMPARE(countSpy.count(), 1);
+}
+
+#include "actionlistmodeltest.moc"
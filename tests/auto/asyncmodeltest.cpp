@@ -0,0 +1,167 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "asyncmodeltest.h"
+
+// Local
+#include <asyncmodel.h>
+
+// KDE
+#include <KConfigGroup>
+#include <KTemporaryFile>
+#include <qtest_kde.h>
+
+// Qt
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QThreadPool>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(AsyncModelTest, NoGUI)
+
+// Released by tests which need the load function to block
+static QSemaphore sLoadSemaphore;
+
+class NumberModel : public AsyncModel
+{
+public:
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : m_list.count();
+    }
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const
+    {
+        if (role != Qt::DisplayRole) {
+            return QVariant();
+        }
+        return m_list.value(index.row());
+    }
+
+    static QVariant load(const QVariantMap &args)
+    {
+        if (args.value("block").toBool()) {
+            sLoadSemaphore.acquire();
+        }
+        QStringList list;
+        int count = args.value("count").toInt();
+        for (int idx = 0; idx < count; ++idx) {
+            list << QString::number(idx);
+        }
+        return list;
+    }
+
+protected:
+    void populate(const QVariant &data)
+    {
+        beginResetModel();
+        m_list = data.toStringList();
+        endResetModel();
+    }
+
+private:
+    QStringList m_list;
+};
+
+static bool waitForLoad(AsyncModel *model)
+{
+    for (int idx = 0; idx < 500 && model->running(); ++idx) {
+        QTest::qWait(10);
+    }
+    return !model->running();
+}
+
+void AsyncModelTest::testLoad()
+{
+    QVariantMap args;
+    args.insert("count", 3);
+    args.insert("block", true);
+
+    AsyncSimpleSource<NumberModel> source(0);
+    QAbstractItemModel *itemModel = source.createModelFromArguments(args);
+    NumberModel *model = static_cast<NumberModel *>(itemModel);
+
+    // The model is returned right away, empty
+    QVERIFY(model->running());
+    QCOMPARE(model->count(), 0);
+
+    QSignalSpy countSpy(model, SIGNAL(countChanged()));
+    QSignalSpy runningSpy(model, SIGNAL(runningChanged(bool)));
+    sLoadSemaphore.release();
+    QVERIFY(waitForLoad(model));
+
+    QCOMPARE(model->count(), 3);
+    QCOMPARE(model->data(model->index(2, 0)).toString(), QString("2"));
+    QCOMPARE(countSpy.count(), 1);
+    QCOMPARE(runningSpy.count(), 1);
+    QCOMPARE(runningSpy.first().first().toBool(), false);
+    delete model;
+}
+
+void AsyncModelTest::testReload()
+{
+    QVariantMap args;
+    args.insert("count", 2);
+
+    NumberModel model;
+    model.startLoading(&NumberModel::load, args);
+    QVERIFY(waitForLoad(&model));
+    QCOMPARE(model.count(), 2);
+
+    QSignalSpy runningSpy(&model, SIGNAL(runningChanged(bool)));
+    model.reload();
+    QVERIFY(model.running());
+    QVERIFY(waitForLoad(&model));
+    QCOMPARE(model.count(), 2);
+    QCOMPARE(runningSpy.count(), 2);
+}
+
+void AsyncModelTest::testDeleteWhileLoading()
+{
+    QVariantMap args;
+    args.insert("count", 2);
+    args.insert("block", true);
+
+    NumberModel *model = new NumberModel;
+    model->startLoading(&NumberModel::load, args);
+    delete model;
+
+    // The load function must be able to finish without the model
+    sLoadSemaphore.release();
+    QThreadPool::globalInstance()->waitForDone();
+    QTest::qWait(10);
+}
+
+void AsyncModelTest::testArgumentsFromConfigGroup()
+{
+    KTemporaryFile temp;
+    QVERIFY(temp.open());
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(temp.fileName());
+    KConfigGroup group(config, "Source0");
+    group.writeEntry("sourceId", "Numbers");
+    group.writeEntry("count", 4);
+
+    QVariantMap args = AsyncModel::argumentsFromConfigGroup(group);
+    QCOMPARE(args.count(), 2);
+    QCOMPARE(args.value("sourceId").toString(), QString("Numbers"));
+    QCOMPARE(args.value("count").toInt(), 4);
+}
+
+#include "asyncmodeltest.moc"
@@ -0,0 +1,93 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "configtransactiontest.h"
+
+// Local
+#include <configtransaction.h>
+
+// KDE
+#include <KConfigGroup>
+#include <KTemporaryFile>
+#include <qtest_kde.h>
+
+// Qt
+
+QTEST_KDEMAIN(ConfigTransactionTest, NoGUI)
+
+static QString readEntryFromDisk(const QString &fileName)
+{
+    // Do not use KSharedConfig: it would return the instance being tested
+    KConfig config(fileName, KConfig::SimpleConfig);
+    return config.group("General").readEntry("key");
+}
+
+void ConfigTransactionTest::testDelayedSync()
+{
+    KTemporaryFile temp;
+    QVERIFY(temp.open());
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(temp.fileName(), KConfig::SimpleConfig);
+
+    {
+        ConfigTransaction transaction(config);
+        config->group("General").writeEntry("key", "value");
+    }
+    QCOMPARE(readEntryFromDisk(temp.fileName()), QString());
+
+    ConfigTransaction::flush(config.data());
+    QCOMPARE(readEntryFromDisk(temp.fileName()), QString("value"));
+}
+
+void ConfigTransactionTest::testNestedTransactions()
+{
+    KTemporaryFile temp;
+    QVERIFY(temp.open());
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(temp.fileName(), KConfig::SimpleConfig);
+    KConfigGroup group(config, "General");
+
+    ConfigTransaction outer(config);
+    {
+        ConfigTransaction inner(group);
+        group.writeEntry("key", "value");
+    }
+    // outer is still open, nothing must be written
+    ConfigTransaction::flushAll();
+    QCOMPARE(readEntryFromDisk(temp.fileName()), QString());
+
+    outer.commit();
+    ConfigTransaction::flushAll();
+    QCOMPARE(readEntryFromDisk(temp.fileName()), QString("value"));
+}
+
+void ConfigTransactionTest::testUnsharedConfig()
+{
+    KTemporaryFile temp;
+    QVERIFY(temp.open());
+    KConfig config(temp.fileName(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, "General");
+
+    {
+        ConfigTransaction transaction(group);
+        group.writeEntry("key", "value");
+    }
+    // The config cannot be kept alive, it is synced right away
+    QCOMPARE(readEntryFromDisk(temp.fileName()), QString("value"));
+}
+
+#include "configtransactiontest.moc"
@@ -20,12 +20,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "dirmodeltest.h"
 
 // Local
+#include <dirindex.h>
+#include <dirlistingcache.h>
 #include <dirmodel.h>
+#include <dirsearchmodel.h>
+#include <largedirmodel.h>
 
 // Qt
 #include <QDir>
 #include <QEventLoop>
 #include <QFile>
+#include <QSignalSpy>
+#include <QTime>
 
 // KDE
 #include <KDebug>
@@ -47,11 +53,21 @@ static void touch(const QString &path)
 
 void DirModelTest::initTestCase()
 {
+    qRegisterMetaType<KUrl>("KUrl");
     QString dir = KGlobal::dirs()->localxdgdatadir();
     QFile file(dir + "/user-places.xbel");
     file.remove();
 }
 
+void DirModelTest::cleanup()
+{
+    DirListingCache *cache = DirListingCache::instance();
+    cache->clear();
+    cache->setLimits(16, 20000);
+    cache->setRevalidateLocalListings(false);
+    LargeDirModel::setLargeDirThreshold(10000);
+}
+
 void DirModelTest::testDirModelSortOrder()
 {
     KTempDir tempDir("dirmodeltest");
@@ -146,4 +162,379 @@ void DirModelTest::testSortOrder()
     }
 }
 
+void DirModelTest::testQuery()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    dir.mkdir("Reports");
+    touch(dir.absoluteFilePath("notes (old).txt"));
+    touch(dir.absoluteFilePath("report.odt"));
+    touch(dir.absoluteFilePath("sportreport.odt"));
+
+    DirModel dirModel;
+    QEventLoop loop;
+    connect(dirModel.dirLister(), SIGNAL(completed()), &loop, SLOT(quit()));
+
+    KUrl rootUrl = KUrl::fromLocalFile(dir.absolutePath());
+    dirModel.init(rootUrl, rootUrl.fileName(), rootUrl);
+    loop.exec();
+    QCOMPARE(dirModel.rowCount(), 4);
+
+    // Regular expression characters are not special
+    dirModel.setQuery("(old)");
+    QCOMPARE(dirModel.rowCount(), 1);
+    QCOMPARE(dirModel.index(0, 0).data().toString(), QString("notes (old).txt"));
+
+    // Folders first, then best matches first
+    dirModel.setQuery("REPORT");
+    QStringList expected = QStringList() << "Reports" << "report.odt" << "sportreport.odt";
+    QCOMPARE(dirModel.rowCount(), expected.count());
+    for (int row = 0; row < dirModel.rowCount(); ++row) {
+        QCOMPARE(dirModel.index(row, 0).data().toString(), expected[row]);
+    }
+
+    dirModel.setQuery(QString());
+    QCOMPARE(dirModel.rowCount(), 4);
+}
+
+void DirModelTest::testRecursiveSearch()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    dir.mkpath("sub/deeper");
+    touch(dir.absoluteFilePath("report-top.odt"));
+    touch(dir.absoluteFilePath("sub/report-sub.odt"));
+    touch(dir.absoluteFilePath("sub/deeper/report-deeper.odt"));
+    touch(dir.absoluteFilePath("sub/deeper/unrelated.txt"));
+
+    KUrl rootUrl = KUrl::fromLocalFile(dir.absolutePath());
+    QSharedPointer<DirIndex> index = DirIndex::indexForPath(dir.absolutePath());
+    DirSearchModel model(index, rootUrl, rootUrl.fileName(), rootUrl);
+    model.setQuery("report");
+    while (model.running()) {
+        QVERIFY(QTest::kWaitForSignal(&model, SIGNAL(runningChanged(bool)), 5000));
+    }
+
+    // Direct children of the folder are not listed, DirModel shows them
+    QStringList names;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        names << model.index(row, 0).data().toString();
+    }
+    names.sort();
+    QCOMPARE(names, QStringList() << "report-deeper.odt" << "report-sub.odt");
+}
+
+static void waitForSearch(DirSearchModel *model)
+{
+    while (model->running()) {
+        QVERIFY(QTest::kWaitForSignal(model, SIGNAL(runningChanged(bool)), 5000));
+    }
+}
+
+void DirModelTest::testRecursiveSearchRefresh()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    dir.mkpath("sub");
+    touch(dir.absoluteFilePath("sub/report-sub.odt"));
+
+    KUrl rootUrl = KUrl::fromLocalFile(dir.absolutePath());
+    QSharedPointer<DirIndex> index = DirIndex::indexForPath(dir.absolutePath());
+    DirSearchModel model(index, rootUrl, rootUrl.fileName(), rootUrl);
+    model.setQuery("report");
+    waitForSearch(&model);
+    QCOMPARE(model.rowCount(), 1);
+
+    QSignalSpy resetSpy(&model, SIGNAL(modelReset()));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+
+    // A change which does not affect the results must not touch the model
+    touch(dir.absoluteFilePath("sub/unrelated.txt"));
+    QVERIFY(QTest::kWaitForSignal(index.data(), SIGNAL(updated()), 5000));
+    waitForSearch(&model);
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+
+    // New results replace the current ones in one go: the model is never
+    // empty while the new search runs
+    touch(dir.absoluteFilePath("sub/report-new.odt"));
+    QVERIFY(QTest::kWaitForSignal(index.data(), SIGNAL(updated()), 5000));
+    while (model.running()) {
+        QCOMPARE(model.rowCount(), 1);
+        QVERIFY(QTest::kWaitForSignal(&model, SIGNAL(runningChanged(bool)), 5000));
+    }
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(resetSpy.count(), 1);
+}
+
+void DirModelTest::testDirIndexSharing()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    const int initialCount = DirIndex::sharedIndexCount();
+
+    QSharedPointer<DirIndex> index1 = DirIndex::indexForPath(dir.absolutePath());
+    QSharedPointer<DirIndex> index2 = DirIndex::indexForPath(dir.absolutePath() + '/');
+    QCOMPARE(index1.data(), index2.data());
+    QCOMPARE(DirIndex::sharedIndexCount(), initialCount + 1);
+
+    // Expired indexes are removed
+    index1.clear();
+    index2.clear();
+    QCOMPARE(DirIndex::sharedIndexCount(), initialCount);
+}
+
+void DirModelTest::testLargeDirModelSortOrder()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    QStringList dirNames = QStringList() << "aaa" << "Abc" << "Hello";
+    QStringList fileNames = QStringList() << "foo" << "Goo" << "hoo" << "img1" << "img2" << "img10"
+        // A 100 digit run comes after a 10 digit one
+        << "img" + QString(10, '9') << "img1" + QString(99, '0');
+
+    Q_FOREACH(const QString &name, fileNames) {
+        touch(dir.absoluteFilePath(name));
+    }
+    Q_FOREACH(const QString &name, dirNames) {
+        dir.mkdir(name);
+    }
+
+    LargeDirModel model;
+    KUrl rootUrl = KUrl::fromLocalFile(dir.absolutePath());
+    model.init(rootUrl, rootUrl.fileName(), rootUrl);
+    QVERIFY(QTest::kWaitForSignal(&model, SIGNAL(runningChanged(bool)), 5000));
+    QVERIFY(!model.running());
+
+    // Must match DirModel order
+    QStringList expected = dirNames + fileNames;
+    QCOMPARE(model.rowCount(), expected.length());
+    for (int row = 0; row < model.rowCount(); ++row) {
+        QCOMPARE(model.index(row, 0).data().toString(), expected[row]);
+    }
+
+    model.setQuery("img");
+    QCOMPARE(model.rowCount(), 5);
+}
+
+static KUrl createDir(const QDir &parentDir, const QString &name, int fileCount)
+{
+    parentDir.mkdir(name);
+    QDir dir(parentDir.absoluteFilePath(name));
+    for (int idx = 0; idx < fileCount; ++idx) {
+        touch(dir.absoluteFilePath(QString("file%1").arg(idx)));
+    }
+    return KUrl::fromPath(dir.absolutePath());
+}
+
+static bool prefetchAndWait(const KUrl &url)
+{
+    DirListingCache *cache = DirListingCache::instance();
+    cache->prefetch(url);
+    QTime time;
+    time.start();
+    while (!cache->isCached(url)) {
+        if (time.elapsed() > 5000) {
+            return false;
+        }
+        QTest::qWait(20);
+    }
+    return true;
+}
+
+void DirModelTest::testListingCacheHit()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    KUrl aUrl = createDir(dir, "a", 2);
+    KUrl bUrl = createDir(dir, "b", 2);
+
+    DirListingCache *cache = DirListingCache::instance();
+    QVERIFY(!cache->isCached(aUrl));
+    QVERIFY(prefetchAndWait(aUrl));
+    QVERIFY(cache->isCached(aUrl));
+    QVERIFY(prefetchAndWait(bUrl));
+    QCOMPARE(cache->cachedUrls(), KUrl::List() << aUrl << bUrl);
+
+    // Prefetching a cached folder does not list it again, but makes it the
+    // most recently used one
+    const QString aKey = aUrl.url(KUrl::RemoveTrailingSlash);
+    KDirLister *aLister = cache->m_listings.value(aKey).lister;
+    cache->prefetch(aUrl);
+    QCOMPARE(cache->cachedUrls(), KUrl::List() << bUrl << aUrl);
+    QTest::qWait(300);
+    QCOMPARE(cache->m_listings.value(aKey).lister, aLister);
+    QVERIFY(aLister->isFinished());
+
+    // Local listings are kept up to date by KDirWatch
+    QVERIFY(!cache->needsRevalidation(aUrl));
+}
+
+void DirModelTest::testListingCachePrefetchDelay()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    KUrl aUrl = createDir(dir, "a", 1);
+    KUrl bUrl = createDir(dir, "b", 1);
+
+    // Only the last folder passed within the delay is listed
+    DirListingCache *cache = DirListingCache::instance();
+    cache->prefetch(aUrl);
+    QTest::qWait(50);
+    QVERIFY(cache->cachedUrls().isEmpty());
+    QVERIFY(prefetchAndWait(bUrl));
+    QCOMPARE(cache->cachedUrls(), KUrl::List() << bUrl);
+}
+
+void DirModelTest::testListingCacheEvictionOrder()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    KUrl aUrl = createDir(dir, "a", 1);
+    KUrl bUrl = createDir(dir, "b", 1);
+    KUrl cUrl = createDir(dir, "c", 1);
+
+    DirListingCache *cache = DirListingCache::instance();
+    cache->setLimits(2, 20000);
+    QVERIFY(prefetchAndWait(aUrl));
+    QVERIFY(prefetchAndWait(bUrl));
+    cache->prefetch(aUrl);
+
+    // b is now the least recently used listing
+    QVERIFY(prefetchAndWait(cUrl));
+    QCOMPARE(cache->cachedUrls(), KUrl::List() << aUrl << cUrl);
+    QVERIFY(!cache->isCached(bUrl));
+}
+
+void DirModelTest::testListingCacheItemCap()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    KUrl aUrl = createDir(dir, "a", 2);
+    KUrl bUrl = createDir(dir, "b", 2);
+    KUrl cUrl = createDir(dir, "c", 5);
+
+    DirListingCache *cache = DirListingCache::instance();
+    cache->setLimits(16, 4);
+    QVERIFY(prefetchAndWait(aUrl));
+    QVERIFY(prefetchAndWait(bUrl));
+    QCOMPARE(cache->cachedUrls(), KUrl::List() << aUrl << bUrl);
+
+    // The most recent listing is kept even if it is over the cap on its own
+    QVERIFY(prefetchAndWait(cUrl));
+    QCOMPARE(cache->cachedUrls(), KUrl::List() << cUrl);
+}
+
+void DirModelTest::testDirModelRevalidation()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    KUrl url = createDir(dir, "a", 3);
+
+    // Local listings are not revalidated, pretend this one is remote
+    DirListingCache *cache = DirListingCache::instance();
+    cache->setRevalidateLocalListings(true);
+    QVERIFY(prefetchAndWait(url));
+    QVERIFY(cache->needsRevalidation(url));
+
+    DirModel model;
+    QSignalSpy completedSpy(model.dirLister(), SIGNAL(completed()));
+    model.init(KUrl::fromPath(dir.absolutePath()), "root", url);
+
+    // Cached listing
+    if (completedSpy.isEmpty()) {
+        QVERIFY(QTest::kWaitForSignal(model.dirLister(), SIGNAL(completed()), 5000));
+    }
+    QCOMPARE(model.rowCount(), 3);
+    QVERIFY(!model.running());
+
+    // Revalidation: cached rows stay and the model does not claim to be busy
+    QSignalSpy runningSpy(&model, SIGNAL(runningChanged(bool)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex, int, int)));
+    QSignalSpy resetSpy(&model, SIGNAL(modelReset()));
+    if (completedSpy.count() < 2) {
+        QVERIFY(QTest::kWaitForSignal(model.dirLister(), SIGNAL(completed()), 5000));
+    }
+    QCOMPARE(model.rowCount(), 3);
+    QVERIFY(!model.running());
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(resetSpy.count(), 0);
+    for (int idx = 0; idx < runningSpy.count(); ++idx) {
+        QVERIFY(!runningSpy.at(idx).at(0).toBool());
+    }
+}
+
+void DirModelTest::testLargeDirThreshold()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    QString bigPath = createDir(dir, "big", 6).toLocalFile();
+    QString smallPath = createDir(dir, "small", 2).toLocalFile();
+    LargeDirModel::setLargeDirThreshold(5);
+
+    // Counting stops at the threshold
+    QCOMPARE(LargeDirModel::countEntries(bigPath), 5);
+    QCOMPARE(LargeDirModel::countEntries(smallPath), 2);
+
+    // isLargeDir() does not read folders, it only knows recorded counts
+    QVERIFY(!LargeDirModel::isLargeDir(bigPath));
+    LargeDirModel::recordEntryCount(bigPath, 5);
+    QVERIFY(LargeDirModel::isLargeDir(bigPath));
+    QVERIFY(LargeDirModel::isLargeDir(bigPath + '/'));
+    LargeDirModel::recordEntryCount(smallPath, 2);
+    QVERIFY(!LargeDirModel::isLargeDir(smallPath));
+
+    // A large folder which shrunk is not large anymore
+    LargeDirModel::recordEntryCount(bigPath, 4);
+    QVERIFY(!LargeDirModel::isLargeDir(bigPath));
+}
+
+void DirModelTest::testLargeDirDetection()
+{
+    KTempDir tempDir("dirmodeltest");
+    QDir dir(tempDir.name());
+    KUrl rootUrl = KUrl::fromPath(dir.absolutePath());
+    KUrl prefetchedUrl = createDir(dir, "prefetched", 6);
+    KUrl listedUrl = createDir(dir, "listed", 6);
+    KUrl smallUrl = createDir(dir, "small", 2);
+    LargeDirModel::setLargeDirThreshold(5);
+
+    // Prefetching counts the folder in a worker thread, large folders are
+    // not held by the cache
+    DirListingCache *cache = DirListingCache::instance();
+    cache->prefetch(prefetchedUrl);
+    QTime time;
+    time.start();
+    while (!LargeDirModel::isLargeDir(prefetchedUrl.toLocalFile()) && time.elapsed() < 5000) {
+        QTest::qWait(20);
+    }
+    QVERIFY(LargeDirModel::isLargeDir(prefetchedUrl.toLocalFile()));
+    QVERIFY(cache->cachedUrls().isEmpty());
+
+    // Small folders are still prefetched
+    QVERIFY(prefetchAndWait(smallUrl));
+    QVERIFY(!LargeDirModel::isLargeDir(smallUrl.toLocalFile()));
+
+    // DirModel records the size of the folders it lists
+    {
+        DirModel model;
+        QEventLoop loop;
+        connect(model.dirLister(), SIGNAL(completed()), &loop, SLOT(quit()));
+        model.init(rootUrl, "root", listedUrl);
+        loop.exec();
+    }
+    QVERIFY(LargeDirModel::isLargeDir(listedUrl.toLocalFile()));
+
+    // DirSource picks the model from the recorded counts
+    DirSource source(0);
+    QAbstractItemModel *model = source.createModelFromArguments(DirModel::sourceArguments(rootUrl, "root", prefetchedUrl));
+    QVERIFY(qobject_cast<LargeDirModel *>(model));
+    delete model;
+
+    model = source.createModelFromArguments(DirModel::sourceArguments(rootUrl, "root", smallUrl));
+    QVERIFY(qobject_cast<DirModel *>(model));
+    delete model;
+}
+
 #include <dirmodeltest.moc>
@@ -28,12 +28,26 @@ class DirModelTest : public QObject
 
 private Q_SLOTS:
     void initTestCase();
+    void cleanup();
 
     // FIXME: Those DirModel tests should be moved to a DirModelTest class
     void testDirModelSortOrder();
     void testDirModelFavoriteId();
 
     void testSortOrder();
+    void testQuery();
+    void testRecursiveSearch();
+    void testRecursiveSearchRefresh();
+    void testDirIndexSharing();
+    void testLargeDirModelSortOrder();
+    void testLargeDirThreshold();
+    void testLargeDirDetection();
+
+    void testListingCacheHit();
+    void testListingCachePrefetchDelay();
+    void testListingCacheEvictionOrder();
+    void testListingCacheItemCap();
+    void testDirModelRevalidation();
 };
 
 #endif /* DIRMODELTEST_H */
@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <qtest_kde.h>
 
 #include <favoriteappsmodel.h>
+#include <favoritesindex.h>
 
 using namespace Homerun;
 
@@ -221,6 +222,33 @@ void FavoriteAppsModelTest::testRemove()
     checkRole(&model2, 1, Qt::DisplayRole, "Konsole");
 }
 
+void FavoriteAppsModelTest::testRemoveWithIndex()
+{
+    writeTestXml(
+        "<apps version='1'>\n"
+        "<app serviceId='kde4-konqbrowser.desktop'/>\n"
+        "<app serviceId='kde4-dolphin.desktop'/>\n"
+        "<app serviceId='kde4-konsole.desktop'/>\n"
+        "</apps>");
+
+    FavoriteAppsModel model;
+    FavoritesIndex index;
+    index.addModel(&model);
+    model.setFavoritesIndex(&index);
+    QVERIFY(model.isFavorite("app:kde4-dolphin.desktop"));
+
+    // Lookups go through the index, which follows the model changes
+    model.removeFavorite("app:kde4-dolphin.desktop");
+    QCOMPARE(model.rowCount(), 2);
+    checkRole(&model, 1, Qt::DisplayRole, "Konsole");
+    QVERIFY(!model.isFavorite("app:kde4-dolphin.desktop"));
+    QVERIFY(model.isFavorite("app:kde4-konsole.desktop"));
+
+    model.removeFavorite("app:kde4-konsole.desktop");
+    QCOMPARE(model.rowCount(), 1);
+    checkRole(&model, 0, Qt::DisplayRole, "Konqueror");
+}
+
 void FavoriteAppsModelTest::testMove()
 {
     QModelIndex index;
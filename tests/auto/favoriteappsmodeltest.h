@@ -35,6 +35,7 @@ private Q_SLOTS:
     void testAdd();
     void testAddToEmptyFavoriteList();
     void testRemove();
+    void testRemoveWithIndex();
     void testMove();
     void testImport();
     void testFirstLoad();
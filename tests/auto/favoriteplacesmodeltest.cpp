@@ -22,20 +22,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // Local
 #include <favoriteplacesmodel.h>
+#include <favoritesindex.h>
+#include <kfileplacesitem.h>
 
 // KDE
+#include <KBookmarkManager>
 #include <KDebug>
 #include <KGlobal>
 #include <KStandardDirs>
 #include <qtest_kde.h>
 
 // Qt
+#include <QCoreApplication>
 #include <QFile>
+#include <QSignalSpy>
 
 using namespace Homerun;
 
 QTEST_KDEMAIN(FavoritePlacesModelTest, NoGUI)
 
+static const char *FAKE_VOLUME_UDI = "/org/kde/solid/fakehw/volume_uuid_c0ffee";
+
 static void checkRole(QAbstractItemModel *model, int row, int role, const QVariant &expected)
 {
     QModelIndex index = model->index(row, 0);
@@ -44,11 +51,81 @@ static void checkRole(QAbstractItemModel *model, int row, int role, const QVaria
     QCOMPARE(value, expected);
 }
 
+static KBookmarkManager *placesBookmarkManager()
+{
+    // Returns the same manager as the one used by the model
+    const QString file = KStandardDirs::locateLocal("data", "kfileplaces/bookmarks.xml");
+    return KBookmarkManager::managerForFile(file, "kfilePlaces");
+}
+
+static KBookmarkManager *sharedBookmarkManager()
+{
+    // Returns the same manager as the one used by KFilePlacesSharedBookmarks
+    const QString file = KGlobal::dirs()->localxdgdatadir() + "user-places.xbel";
+    return KBookmarkManager::managerForExternalFile(file);
+}
+
+static KBookmark findBookmark(const QString &text, KBookmarkManager *manager = placesBookmarkManager())
+{
+    KBookmarkGroup root = manager->root();
+    for (KBookmark bookmark = root.first(); !bookmark.isNull(); bookmark = root.next(bookmark)) {
+        if (bookmark.text() == text) {
+            return bookmark;
+        }
+    }
+    return KBookmark();
+}
+
+// Returns the texts of the non-system bookmarks of manager
+static QStringList bookmarkTexts(KBookmarkManager *manager)
+{
+    QStringList texts;
+    KBookmarkGroup root = manager->root();
+    for (KBookmark bookmark = root.first(); !bookmark.isNull(); bookmark = root.next(bookmark)) {
+        if (bookmark.metaDataItem("isSystemItem") != "true") {
+            texts << bookmark.text();
+        }
+    }
+    return texts;
+}
+
+static void clearBookmarks(KBookmarkManager *manager)
+{
+    KBookmarkGroup root = manager->root();
+    while (!root.first().isNull()) {
+        root.deleteBookmark(root.first());
+    }
+}
+
+static int rowForDisplay(QAbstractItemModel *model, const QString &text)
+{
+    for (int row = 0; row < model->rowCount(); ++row) {
+        if (model->index(row, 0).data(Qt::DisplayRole).toString() == text) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void FavoritePlacesModelTest::initTestCase()
+{
+    qRegisterMetaType<QModelIndex>("QModelIndex");
+    // Make the device list predictable: Solid reads this variable when its
+    // manager is first used, which happens the first time a model lists
+    // devices
+    qputenv("SOLID_FAKEHW", QByteArray(KDESRCDIR) + "/fakehw.xml");
+}
+
 void FavoritePlacesModelTest::init()
 {
     QString dir = KGlobal::dirs()->localxdgdatadir();
     QFile::remove(dir + "/user-places.xbel");
     QFile::remove(KStandardDirs::locateLocal("data", "kfileplaces/bookmarks.xml"));
+
+    // The bookmark managers are shared with models from previous tests, empty
+    // them so that tests do not find each other's places
+    clearBookmarks(placesBookmarkManager());
+    clearBookmarks(sharedBookmarkManager());
 }
 
 void FavoritePlacesModelTest::testFavoriteId()
@@ -102,4 +179,222 @@ void FavoritePlacesModelTest::testMoveRow()
     QVERIFY(checkOrder(&model, QStringList() << "Foo" << "Bar" << "Baz"));
 }
 
+void FavoritePlacesModelTest::testFavoritesIndex()
+{
+    FavoritePlacesModel model;
+    FavoritesIndex index;
+    index.addModel(&model);
+    model.setFavoritesIndex(&index);
+
+    QVERIFY(!index.isFavorite("place:file:///foo"));
+    int row1 = model.count();
+    model.addPlace("Foo", KUrl("/foo"));
+    int row2 = model.count();
+    model.addPlace("Bar", KUrl("/bar/"));
+
+    // Trailing slashes do not matter
+    QVERIFY(index.isFavorite("place:file:///foo/"));
+    QVERIFY(index.isFavorite("place:file:///bar"));
+    QVERIFY(model.isFavorite("place:file:///bar"));
+    QCOMPARE(index.rowForFavoriteId("place:file:///bar/"), row2);
+    QCOMPARE(index.modelForFavoriteId("place:file:///foo"), static_cast<QObject *>(&model));
+    QCOMPARE(index.rowForFavoriteId("app:foo.desktop"), -1);
+
+    // Moving rows updates the rows
+    model.moveRow(row1, row2);
+    QCOMPARE(index.rowForFavoriteId("place:file:///foo"), row2);
+    QCOMPARE(index.rowForFavoriteId("place:file:///bar"), row1);
+
+    // The model finds the row to remove through the index
+    model.removeFavorite("place:file:///foo/");
+    QVERIFY(!index.isFavorite("place:file:///foo"));
+    QVERIFY(!model.isFavorite("place:file:///foo"));
+    QVERIFY(index.isFavorite("place:file:///bar"));
+    QCOMPARE(index.rowForFavoriteId("place:file:///bar"), row1);
+}
+
+void FavoritePlacesModelTest::testReloadReorder()
+{
+    FavoritePlacesModel model;
+    model.addPlace("Foo", KUrl("/foo"));
+    model.addPlace("Bar", KUrl("/bar"));
+    model.addPlace("Baz", KUrl("/baz"));
+    int fooRow = rowForDisplay(&model, "Foo");
+    QVERIFY(checkOrder(&model, QStringList() << "Foo" << "Bar" << "Baz"));
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy movedSpy(&model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // Reorder behind the model back, as another process would do
+    KBookmarkManager *manager = placesBookmarkManager();
+    manager->root().moveBookmark(findBookmark("Foo"), findBookmark("Baz"));
+    manager->emitChanged(manager->root());
+
+    QVERIFY(checkOrder(&model, QStringList() << "Bar" << "Baz" << "Foo"));
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(dataChangedSpy.count(), 0);
+    // Only "Foo" moved
+    QCOMPARE(movedSpy.count(), 1);
+    QVariantList args = movedSpy.first();
+    QCOMPARE(args.at(1).toInt(), fooRow);
+    QCOMPARE(args.at(2).toInt(), fooRow);
+    QCOMPARE(args.at(4).toInt(), fooRow + 3);
+}
+
+void FavoritePlacesModelTest::testReloadInsertAndRemove()
+{
+    FavoritePlacesModel model;
+    model.addPlace("Foo", KUrl("/foo"));
+    model.addPlace("Bar", KUrl("/bar"));
+    model.addPlace("Baz", KUrl("/baz"));
+    int barRow = rowForDisplay(&model, "Bar");
+    int count = model.count();
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy movedSpy(&model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // Replace "Bar" with "New" in a single change
+    KBookmarkManager *manager = placesBookmarkManager();
+    KBookmarkGroup root = manager->root();
+    root.deleteBookmark(findBookmark("Bar"));
+    KBookmark bookmark = KFilePlacesItem::createBookmark(manager, "New", KUrl("/new"), "folder");
+    root.moveBookmark(bookmark, findBookmark("Foo"));
+    manager->emitChanged(root);
+
+    QVERIFY(checkOrder(&model, QStringList() << "Foo" << "New" << "Baz"));
+    QCOMPARE(model.count(), count);
+
+    QCOMPARE(removedSpy.count(), 1);
+    QVariantList args = removedSpy.first();
+    QCOMPARE(args.at(1).toInt(), barRow);
+    QCOMPARE(args.at(2).toInt(), barRow);
+
+    QCOMPARE(insertedSpy.count(), 1);
+    args = insertedSpy.first();
+    QCOMPARE(args.at(1).toInt(), barRow);
+    QCOMPARE(args.at(2).toInt(), barRow);
+
+    // "Foo" and "Baz" are kept as is
+    QCOMPARE(movedSpy.count(), 0);
+    QCOMPARE(dataChangedSpy.count(), 0);
+}
+
+void FavoritePlacesModelTest::testReloadDataChanged()
+{
+    FavoritePlacesModel model;
+    model.addPlace("Foo", KUrl("/foo"));
+    model.addPlace("Bar", KUrl("/bar"));
+    int barRow = rowForDisplay(&model, "Bar");
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // Reloading without any change emits nothing
+    KBookmarkManager *manager = placesBookmarkManager();
+    manager->emitChanged(manager->root());
+    QCOMPARE(dataChangedSpy.count(), 0);
+
+    // Renaming a place only emits dataChanged() for its row
+    KBookmark bookmark = findBookmark("Bar");
+    bookmark.setFullText("Renamed");
+    manager->emitChanged(manager->root());
+
+    QVERIFY(checkOrder(&model, QStringList() << "Foo" << "Renamed"));
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(dataChangedSpy.count(), 1);
+    QVariantList args = dataChangedSpy.first();
+    QCOMPARE(args.at(0).value<QModelIndex>().row(), barRow);
+    QCOMPARE(args.at(1).value<QModelIndex>().row(), barRow);
+}
+
+void FavoritePlacesModelTest::testReloadDevices()
+{
+    FavoritePlacesModel model;
+    // Let the model list the devices
+    QCoreApplication::processEvents();
+    int deviceRow = rowForDisplay(&model, "Test Volume");
+    QVERIFY(deviceRow != -1);
+    QVERIFY(model.isDevice(model.index(deviceRow, 0)));
+    QCOMPARE(model.deviceForIndex(model.index(deviceRow, 0)).udi(), QString(FAKE_VOLUME_UDI));
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy movedSpy(&model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+
+    // Adding a place keeps the device item
+    model.addPlace("Foo", KUrl("/foo"));
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(movedSpy.count(), 0);
+    QCOMPARE(dataChangedSpy.count(), 0);
+    QCOMPARE(rowForDisplay(&model, "Test Volume"), deviceRow);
+    insertedSpy.clear();
+
+    // Unplugging the device only removes its row, its bookmark is kept
+    QMetaObject::invokeMethod(&model, "_k_deviceRemoved", Q_ARG(QString, FAKE_VOLUME_UDI));
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.first().at(1).toInt(), deviceRow);
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(rowForDisplay(&model, "Test Volume"), -1);
+
+    // Plugging it back reuses its bookmark, so it comes back at the same row
+    QMetaObject::invokeMethod(&model, "_k_deviceAdded", Q_ARG(QString, FAKE_VOLUME_UDI));
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.first().at(1).toInt(), deviceRow);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(movedSpy.count(), 0);
+    QCOMPARE(rowForDisplay(&model, "Test Volume"), deviceRow);
+}
+
+void FavoritePlacesModelTest::testIntegrateSharedBookmarks()
+{
+    FavoritePlacesModel model;
+    model.addPlace("Foo", KUrl("/foo"));
+    model.addPlace("Bar", KUrl("/bar"));
+    QCOMPARE(bookmarkTexts(sharedBookmarkManager()), QStringList() << "Foo" << "Bar");
+
+    // Change the shared bookmarks: ours must end up a copy of them
+    KBookmarkManager *sharedManager = sharedBookmarkManager();
+    findBookmark("Bar", sharedManager).setFullText("Shared");
+    sharedManager->emitChanged(sharedManager->root());
+
+    QCOMPARE(bookmarkTexts(placesBookmarkManager()), QStringList() << "Foo" << "Shared");
+    QVERIFY(checkOrder(&model, QStringList() << "Foo" << "Shared"));
+}
+
+void FavoritePlacesModelTest::testExportSharedBookmarks()
+{
+    FavoritePlacesModel model;
+    model.addPlace("Foo", KUrl("/foo"));
+    model.addPlace("Bar", KUrl("/bar"));
+    model.addPlace("Baz", KUrl("/baz"));
+    KBookmarkManager *sharedManager = sharedBookmarkManager();
+    QCOMPARE(bookmarkTexts(sharedManager), QStringList() << "Foo" << "Bar" << "Baz");
+    const QDomElement fooElement = findBookmark("Foo", sharedManager).internalElement();
+    const QDomElement bazElement = findBookmark("Baz", sharedManager).internalElement();
+
+    // Insert a bookmark before Foo and remove Bar
+    KBookmarkManager *manager = placesBookmarkManager();
+    KBookmarkGroup root = manager->root();
+    KBookmark foo = findBookmark("Foo");
+    KBookmark added = root.addBookmark("New", KUrl("/new"));
+    root.moveBookmark(added, root.previous(foo));
+    root.deleteBookmark(findBookmark("Bar"));
+    manager->emitChanged(root);
+
+    QCOMPARE(bookmarkTexts(sharedManager), QStringList() << "New" << "Foo" << "Baz");
+    // Bookmarks are matched by content, not by position: the unchanged ones
+    // have not been rewritten
+    QVERIFY(findBookmark("Foo", sharedManager).internalElement() == fooElement);
+    QVERIFY(findBookmark("Baz", sharedManager).internalElement() == bazElement);
+}
+
 #include <favoriteplacesmodeltest.moc>
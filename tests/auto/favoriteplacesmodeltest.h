@@ -34,9 +34,17 @@ class FavoritePlacesModelTest : public QObject
 {
     Q_OBJECT
 private Q_SLOTS:
+    void initTestCase();
     void init();
     void testFavoriteId();
     void testMoveRow();
+    void testFavoritesIndex();
+    void testReloadReorder();
+    void testReloadInsertAndRemove();
+    void testReloadDataChanged();
+    void testReloadDevices();
+    void testIntegrateSharedBookmarks();
+    void testExportSharedBookmarks();
 };
 
 #endif /* FAVORITEPLACESMODELTEST_H */
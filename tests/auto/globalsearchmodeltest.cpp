@@ -0,0 +1,216 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "globalsearchmodeltest.h"
+
+// Local
+#include <globalsearchmodel.h>
+#include <searchable.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QStringListModel>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(GlobalSearchModelTest, NoGUI)
+
+class SearchableModel : public QStringListModel, public Searchable
+{
+    Q_OBJECT
+    Q_INTERFACES(Homerun::Searchable)
+public:
+    SearchableModel(const QStringList &list)
+    : QStringListModel(list)
+    {}
+
+    SearchTask *createSearchTask()
+    {
+        return new TextSearchTask(this, Qt::DisplayRole);
+    }
+
+    Q_INVOKABLE bool trigger(int row, const QString &/*actionId*/, const QVariant &/*actionArgument*/)
+    {
+        m_triggeredRows << row;
+        return true;
+    }
+
+    QList<int> m_triggeredRows;
+};
+
+static QStringList rowTexts(const QList<SearchResult> &results, const QStringList &texts)
+{
+    QStringList lst;
+    Q_FOREACH(const SearchResult &result, results) {
+        lst << texts.at(result.row);
+    }
+    return lst;
+}
+
+static QStringList modelTexts(const QAbstractItemModel *model)
+{
+    QStringList lst;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        lst << model->index(row, 0).data().toString();
+    }
+    return lst;
+}
+
+static bool waitForSearch(GlobalSearchModel *model)
+{
+    for (int idx = 0; idx < 500 && model->running(); ++idx) {
+        QTest::qWait(10);
+    }
+    return !model->running();
+}
+
+void GlobalSearchModelTest::testTextSearchTask()
+{
+    QStringList texts = QStringList() << "Sport report" << "Annual-report" << "Reporter" << "Kate";
+    TextSearchTask task(texts);
+
+    QList<SearchResult> results = task.run(SearchQuery("report", 10));
+    QCOMPARE(rowTexts(results, texts), QStringList() << "Reporter" << "Sport report" << "Annual-report");
+
+    // Refining the query
+    results = task.run(SearchQuery("reporte", 10));
+    QCOMPARE(rowTexts(results, texts), QStringList() << "Reporter");
+
+    results = task.run(SearchQuery(QString(), 10));
+    QVERIFY(results.isEmpty());
+}
+
+void GlobalSearchModelTest::testTextSearchTaskMaxResults()
+{
+    QStringList texts = QStringList() << "ab" << "abc" << "abcd" << "xab";
+    TextSearchTask task(texts);
+    QList<SearchResult> results = task.run(SearchQuery("ab", 2));
+    QCOMPARE(rowTexts(results, texts), QStringList() << "ab" << "abc");
+
+    // No limit
+    results = task.run(SearchQuery("ab", -1));
+    QCOMPARE(rowTexts(results, texts), QStringList() << "ab" << "abc" << "abcd" << "xab");
+}
+
+void GlobalSearchModelTest::testCanceledQuery()
+{
+    TextSearchTask task(QStringList() << "kate" << "kwrite");
+    SearchQuery query("k", 10);
+    SearchQuery copy = query;
+    copy.cancel();
+    QVERIFY(query.isCanceled());
+    QVERIFY(task.run(query).isEmpty());
+
+    // A canceled run does not affect the following ones
+    QStringList texts = QStringList() << "kate" << "kwrite" << "konsole";
+    TextSearchTask task2(texts);
+    QCOMPARE(task2.run(SearchQuery("k", 10)).count(), 3);
+    query = SearchQuery("kw", 10);
+    query.cancel();
+    QVERIFY(task2.run(query).isEmpty());
+    QCOMPARE(rowTexts(task2.run(SearchQuery("ka", 10)), texts), QStringList() << "kate");
+}
+
+void GlobalSearchModelTest::testMerge()
+{
+    SearchableModel model1(QStringList() << "Dolphin" << "Konsole" << "Kate");
+    SearchableModel model2(QStringList() << "Calculator" << "Okular" << "Kalzium");
+
+    GlobalSearchModel model;
+    QVERIFY(model.addModel(&model1));
+    QVERIFY(model.addModel(&model2));
+
+    model.setQuery("k");
+    QVERIFY(waitForSearch(&model));
+    // Prefix matches first, shortest ones first, then substring matches
+    QCOMPARE(modelTexts(&model), QStringList() << "Kate" << "Konsole" << "Kalzium" << "Okular");
+
+    model.setMaxResults(2);
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(modelTexts(&model), QStringList() << "Kate" << "Konsole");
+
+    model.setMaxResults(-1);
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(modelTexts(&model), QStringList() << "Kate" << "Konsole" << "Kalzium" << "Okular");
+
+    model.setQuery(QString());
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(model.count(), 0);
+}
+
+void GlobalSearchModelTest::testTrigger()
+{
+    SearchableModel model1(QStringList() << "Dolphin" << "Konsole");
+    SearchableModel model2(QStringList() << "Calculator" << "Okular");
+
+    GlobalSearchModel model;
+    model.addModel(&model1);
+    model.addModel(&model2);
+    model.setQuery("o");
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(modelTexts(&model), QStringList() << "Okular" << "Dolphin" << "Konsole" << "Calculator");
+
+    QVERIFY(model.trigger(1));
+    QCOMPARE(model1.m_triggeredRows, QList<int>() << 0);
+    QCOMPARE(model2.m_triggeredRows, QList<int>());
+
+    QVERIFY(model.trigger(0));
+    QCOMPARE(model2.m_triggeredRows, QList<int>() << 1);
+}
+
+void GlobalSearchModelTest::testModelChange()
+{
+    SearchableModel model1(QStringList() << "Dolphin");
+
+    GlobalSearchModel model;
+    model.addModel(&model1);
+    model.setQuery("k");
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(model.count(), 0);
+
+    model1.setStringList(QStringList() << "Dolphin" << "Kate");
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(modelTexts(&model), QStringList() << "Kate");
+
+    // Results of the previous rows are dropped right away
+    model1.setStringList(QStringList() << "Kate" << "Dolphin");
+    QCOMPARE(model.count(), 0);
+    QVERIFY(waitForSearch(&model));
+    QCOMPARE(modelTexts(&model), QStringList() << "Kate");
+
+    {
+        SearchableModel model2(QStringList() << "Konsole");
+        model.addModel(&model2);
+        QVERIFY(waitForSearch(&model));
+        QCOMPARE(model.count(), 2);
+    }
+    // model2 has been deleted
+    QCOMPARE(modelTexts(&model), QStringList() << "Kate");
+}
+
+void GlobalSearchModelTest::testNotSearchable()
+{
+    QStringListModel listModel(QStringList() << "Kate");
+    GlobalSearchModel model;
+    QVERIFY(!model.addModel(&listModel));
+}
+
+#include "globalsearchmodeltest.moc"
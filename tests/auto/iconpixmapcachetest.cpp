@@ -0,0 +1,177 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <iconpixmapcachetest.h>
+
+// Local
+#include <iconpixmapcache.h>
+
+// KDE
+#include <KTempDir>
+#include <qtest_kde.h>
+
+// Qt
+#include <QImage>
+
+QTEST_KDEMAIN(IconPixmapCacheTest, GUI)
+
+bool PixmapWaiter::waitForKey(const QString &key)
+{
+    while (!m_keys.contains(key)) {
+        if (!QTest::kWaitForSignal(this, SIGNAL(notified()), 5000)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PixmapWaiter::slotPixmapReady(const QString &key)
+{
+    m_keys << key;
+    notified();
+}
+
+void IconPixmapCacheTest::initTestCase()
+{
+    m_tempDir = new KTempDir("iconpixmapcachetest");
+}
+
+void IconPixmapCacheTest::cleanupTestCase()
+{
+    delete m_tempDir;
+}
+
+QString IconPixmapCacheTest::createIcon(const QString &name, int extent)
+{
+    QImage image(extent, extent, QImage::Format_ARGB32);
+    image.fill(0xff336699);
+    QString path = m_tempDir->name() + name + ".png";
+    bool ok = image.save(path);
+    Q_ASSERT(ok);
+    Q_UNUSED(ok);
+    return path;
+}
+
+void IconPixmapCacheTest::testWaiters()
+{
+    IconPixmapCache *cache = IconPixmapCache::instance();
+    QString path1 = createIcon("waiter1", 64);
+    QString path2 = createIcon("waiter2", 64);
+    const QString key1 = IconPixmapCache::key(path1, 32, QIcon::Normal);
+    const QString key2 = IconPixmapCache::key(path2, 32, QIcon::Normal);
+
+    PixmapWaiter waiter1, waiter2, cancelledWaiter;
+    bool exact;
+    cache->pixmap(path1, 32, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    cache->addWaiter(key1, &waiter1, "slotPixmapReady");
+    cache->addWaiter(key1, &cancelledWaiter, "slotPixmapReady");
+    cache->removeWaiter(key1, &cancelledWaiter);
+    cache->pixmap(path2, 32, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    cache->addWaiter(key2, &waiter2, "slotPixmapReady");
+
+    // Each waiter is only told about its own key
+    QVERIFY(waiter1.waitForKey(key1));
+    QVERIFY(waiter2.waitForKey(key2));
+    QCOMPARE(waiter1.m_keys, QStringList() << key1);
+    QCOMPARE(waiter2.m_keys, QStringList() << key2);
+    QVERIFY(cancelledWaiter.m_keys.isEmpty());
+
+    QPixmap pix = cache->pixmap(path1, 32, QIcon::Normal, &exact);
+    QVERIFY(exact);
+    QCOMPARE(pix.size(), QSize(32, 32));
+}
+
+void IconPixmapCacheTest::testSizeFallback()
+{
+    IconPixmapCache *cache = IconPixmapCache::instance();
+    QString path = createIcon("fallback", 128);
+    PixmapWaiter waiter;
+    bool exact;
+
+    // Nothing to fall back to yet
+    QPixmap pix = cache->pixmap(path, 32, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    QVERIFY(pix.isNull());
+    QString key = IconPixmapCache::key(path, 32, QIcon::Normal);
+    cache->addWaiter(key, &waiter, "slotPixmapReady");
+    QVERIFY(waiter.waitForKey(key));
+
+    // Only 32 is available, use it for any size
+    pix = cache->pixmap(path, 64, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    QCOMPARE(pix.size(), QSize(32, 32));
+    key = IconPixmapCache::key(path, 64, QIcon::Normal);
+    cache->addWaiter(key, &waiter, "slotPixmapReady");
+    QVERIFY(waiter.waitForKey(key));
+
+    // The smallest bigger size is preferred
+    pix = cache->pixmap(path, 48, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    QCOMPARE(pix.size(), QSize(64, 64));
+
+    // Then the biggest smaller size
+    pix = cache->pixmap(path, 96, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    QCOMPARE(pix.size(), QSize(64, 64));
+
+    // Let the sizes requested above finish rendering
+    key = IconPixmapCache::key(path, 48, QIcon::Normal);
+    cache->addWaiter(key, &waiter, "slotPixmapReady");
+    QVERIFY(waiter.waitForKey(key));
+    key = IconPixmapCache::key(path, 96, QIcon::Normal);
+    cache->addWaiter(key, &waiter, "slotPixmapReady");
+    QVERIFY(waiter.waitForKey(key));
+}
+
+void IconPixmapCacheTest::testCostLimit()
+{
+    IconPixmapCache *cache = IconPixmapCache::instance();
+    // Cost is in KB of 32 bit pixel data
+    QCOMPARE(cache->maxCost(), 32 * 1024);
+
+    // Each icon costs 1 MB, fill the cache past its limit
+    const int extent = 512;
+    const int iconCount = 40;
+    PixmapWaiter waiter;
+    QStringList paths;
+    for (int idx = 0; idx < iconCount; ++idx) {
+        QString path = createIcon(QString("big%1").arg(idx), extent);
+        paths << path;
+        bool exact;
+        cache->pixmap(path, extent, QIcon::Normal, &exact);
+        QVERIFY(!exact);
+        QString key = IconPixmapCache::key(path, extent, QIcon::Normal);
+        cache->addWaiter(key, &waiter, "slotPixmapReady");
+        QVERIFY(waiter.waitForKey(key));
+        QVERIFY(cache->totalCost() <= cache->maxCost());
+    }
+
+    // The most recent icons are still there, the oldest ones were evicted
+    bool exact;
+    cache->pixmap(paths.last(), extent, QIcon::Normal, &exact);
+    QVERIFY(exact);
+    QPixmap pix = cache->pixmap(paths.first(), extent, QIcon::Normal, &exact);
+    QVERIFY(!exact);
+    QVERIFY(pix.isNull());
+}
+
+#include <iconpixmapcachetest.moc>
@@ -0,0 +1,129 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <openedsessionsmodeltest.h>
+
+// Local
+#include <openedsessionsmodel.h>
+
+// KDE
+#include <KDebug>
+#include <qtest_kde.h>
+
+// Qt
+#include <QSignalSpy>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(OpenedSessionsModelTest, NoGUI)
+
+static SessEnt createSession(int vt, const QString &user)
+{
+    SessEnt session;
+    session.display = QString(":%1").arg(vt - 7);
+    session.user = user;
+    session.session = "KDE";
+    session.vt = vt;
+    session.self = false;
+    session.tty = false;
+    return session;
+}
+
+static QList<int> vts(QAbstractItemModel *model)
+{
+    QList<int> list;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        QString text = model->index(row, 0).data().toString();
+        QRegExp rx("F(\\d+)\\)$");
+        if (rx.indexIn(text) == -1) {
+            kWarning() << "Unexpected text" << text;
+            return QList<int>();
+        }
+        list << rx.cap(1).toInt();
+    }
+    return list;
+}
+
+void OpenedSessionsModelTest::initTestCase()
+{
+    qRegisterMetaType<QModelIndex>("QModelIndex");
+}
+
+void OpenedSessionsModelTest::testRefresh()
+{
+    ListSessionsWatcher *watcher = new ListSessionsWatcher;
+    OpenedSessionsModel model(watcher);
+
+    SessEnt self = createSession(7, "me");
+    self.self = true;
+    SessList sessions;
+    sessions << self << createSession(8, "alice") << createSession(9, "bob") << createSession(10, "carol");
+    watcher->updateSessions(sessions);
+    // Our own session is not listed
+    QCOMPARE(vts(&model), QList<int>() << 8 << 9 << 10);
+    QVERIFY(model.index(0, 0).data().toString().contains("alice"));
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy movedSpy(&model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex)));
+    QSignalSpy resetSpy(&model, SIGNAL(modelReset()));
+
+    // Add
+    sessions << createSession(11, "dave");
+    watcher->updateSessions(sessions);
+    QCOMPARE(vts(&model), QList<int>() << 8 << 9 << 10 << 11);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.takeFirst().at(1).toInt(), 3);
+
+    // Remove
+    sessions.removeAt(2); // bob
+    watcher->updateSessions(sessions);
+    QCOMPARE(vts(&model), QList<int>() << 8 << 10 << 11);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.takeFirst().at(1).toInt(), 1);
+
+    // Reorder: moving dave first is a single move
+    sessions.move(3, 1);
+    watcher->updateSessions(sessions);
+    QCOMPARE(vts(&model), QList<int>() << 11 << 8 << 10);
+    QCOMPARE(movedSpy.count(), 1);
+    QVariantList args = movedSpy.takeFirst();
+    QCOMPARE(args.at(1).toInt(), 2);
+    QCOMPARE(args.at(2).toInt(), 2);
+    QCOMPARE(args.at(4).toInt(), 0);
+
+    // Change the user of a session
+    sessions[2].user = "eve"; // alice
+    watcher->updateSessions(sessions);
+    QCOMPARE(vts(&model), QList<int>() << 11 << 8 << 10);
+    QCOMPARE(dataChangedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy.takeFirst().at(0).value<QModelIndex>().row(), 1);
+    QVERIFY(model.index(1, 0).data().toString().contains("eve"));
+
+    // Each step only emitted its own signal
+    QCOMPARE(insertedSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 0);
+    QCOMPARE(movedSpy.count(), 0);
+    QCOMPARE(dataChangedSpy.count(), 0);
+    QCOMPARE(resetSpy.count(), 0);
+}
+
+#include <openedsessionsmodeltest.moc>
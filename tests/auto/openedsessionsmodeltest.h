@@ -0,0 +1,65 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef OPENEDSESSIONSMODELTEST_H
+#define OPENEDSESSIONSMODELTEST_H
+
+// Local
+#include <sessionswatcher.h>
+
+// Qt
+#include <QObject>
+
+/**
+ * A SessionsWatcher which lists the sessions set by the test when
+ * updateSessions() is called
+ */
+class ListSessionsWatcher : public SessionsWatcher
+{
+    Q_OBJECT
+public:
+    ListSessionsWatcher()
+    : SessionsWatcher(QDBusConnection("homerun-no-bus"))
+    {}
+
+    void updateSessions(const SessList &sessions)
+    {
+        m_fakeSessions = sessions;
+        QMetaObject::invokeMethod(this, "checkSessions");
+    }
+
+protected:
+    void listSessions(SessList &sessions)
+    {
+        sessions = m_fakeSessions;
+    }
+
+private:
+    SessList m_fakeSessions;
+};
+
+class OpenedSessionsModelTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testRefresh();
+};
+
+#endif /* OPENEDSESSIONSMODELTEST_H */
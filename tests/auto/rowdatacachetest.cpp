@@ -0,0 +1,202 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <rowdatacachetest.h>
+
+// Local
+#include <datamodel.h>
+#include <rowdata.h>
+#include <rowdatacache.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QSignalSpy>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(RowDataCacheTest, NoGUI)
+
+typedef QPair<int, int> Range;
+typedef QList<Range> RangeList;
+
+static QStandardItemModel *fillModel(QStandardItemModel *model, int rowCount)
+{
+    QHash<int, QByteArray> roles;
+    roles.insert(Qt::DisplayRole, "display");
+    model->setRoleNames(roles);
+    for (int row = 0; row < rowCount; ++row) {
+        model->appendRow(new QStandardItem(QString("item%1").arg(row)));
+    }
+    return model;
+}
+
+static QString display(const QVariant &rowData)
+{
+    return rowData.toMap().value("display").toString();
+}
+
+static QStringList displays(const QVariantList &rows)
+{
+    QStringList lst;
+    Q_FOREACH(const QVariant &row, rows) {
+        lst << display(row);
+    }
+    return lst;
+}
+
+//- RowDataModel ------------------------------------------------------
+RowDataModel::RowDataModel(int rowCount)
+{
+    fillModel(this, rowCount);
+}
+
+QVariantList RowDataModel::rowData(int first, int count, const QStringList &roleNames) const
+{
+    m_calls << Range(first, count);
+    return RowData::fetch(this, first, count, roleNames);
+}
+
+//- RowDataCacheTest --------------------------------------------------
+void RowDataCacheTest::testFetchByBlock()
+{
+    RowDataModel model(100);
+    RowDataCache cache;
+    cache.setModel(&model);
+    cache.setRoleNames(QStringList() << "display");
+
+    QCOMPARE(display(cache.rowData(0)), QString("item0"));
+    QCOMPARE(display(cache.rowData(31)), QString("item31"));
+    QCOMPARE(model.m_calls, RangeList() << Range(0, RowDataCache::BlockSize));
+
+    QCOMPARE(display(cache.rowData(99)), QString("item99"));
+    QCOMPARE(model.m_calls.last(), Range(96, RowDataCache::BlockSize));
+
+    QVERIFY(!cache.rowData(100).isValid());
+    QVERIFY(!cache.rowData(-1).isValid());
+    QCOMPARE(model.m_calls.count(), 2);
+}
+
+void RowDataCacheTest::testNoRowData()
+{
+    QStandardItemModel model;
+    fillModel(&model, 10);
+    RowDataCache cache;
+    cache.setModel(&model);
+    cache.setRoleNames(QStringList() << "display");
+
+    // Views fall back to the roles of the model
+    QVERIFY(!cache.rowData(0).isValid());
+}
+
+void RowDataCacheTest::testDataChanged()
+{
+    RowDataModel model(100);
+    RowDataCache cache;
+    cache.setModel(&model);
+    cache.setRoleNames(QStringList() << "display");
+    cache.rowData(0);
+    cache.rowData(32);
+    model.m_calls.clear();
+
+    // Only the block of the changed row is dropped
+    QSignalSpy spy(&cache, SIGNAL(generationChanged()));
+    model.item(40)->setText("changed");
+    QCOMPARE(spy.count(), 1);
+    cache.rowData(0);
+    QCOMPARE(display(cache.rowData(40)), QString("changed"));
+    QCOMPARE(model.m_calls, RangeList() << Range(32, RowDataCache::BlockSize));
+
+    // Changing a row which is not cached does not update the views
+    model.item(80)->setText("changed");
+    QCOMPARE(spy.count(), 1);
+}
+
+void RowDataCacheTest::testRowsInserted()
+{
+    RowDataModel model(100);
+    RowDataCache cache;
+    cache.setModel(&model);
+    cache.setRoleNames(QStringList() << "display");
+    cache.rowData(0);
+    cache.rowData(32);
+    cache.rowData(64);
+    model.m_calls.clear();
+
+    // Rows after the inserted one move: their blocks are dropped as well
+    model.insertRow(40, new QStandardItem("new"));
+    cache.rowData(0);
+    QCOMPARE(display(cache.rowData(40)), QString("new"));
+    QCOMPARE(display(cache.rowData(65)), QString("item64"));
+    QCOMPARE(model.m_calls, RangeList()
+        << Range(32, RowDataCache::BlockSize)
+        << Range(64, RowDataCache::BlockSize));
+}
+
+void RowDataCacheTest::testRowsMoved()
+{
+    RowDataModel model(100);
+    RowDataCache cache;
+    cache.setModel(&model);
+    cache.setRoleNames(QStringList() << "display");
+    cache.rowData(0);
+    cache.rowData(32);
+    cache.rowData(64);
+    model.m_calls.clear();
+
+    // QStandardItemModel cannot move rows, call the slot directly. Rows 2 and
+    // 3 move before row 10: only the first block changes.
+    QMetaObject::invokeMethod(&cache, "slotRowsMoved",
+        Q_ARG(QModelIndex, QModelIndex()), Q_ARG(int, 2), Q_ARG(int, 3),
+        Q_ARG(QModelIndex, QModelIndex()), Q_ARG(int, 10));
+    cache.rowData(0);
+    cache.rowData(32);
+    cache.rowData(64);
+    QCOMPARE(model.m_calls, RangeList() << Range(0, RowDataCache::BlockSize));
+}
+
+void RowDataCacheTest::testSortFilterModelRowData()
+{
+    RowDataModel model(10);
+    Plasma::SortFilterModel proxy;
+    proxy.setModel(&model);
+    proxy.setFilterRole("display");
+    proxy.setFilterRegExp("^item[0-37-9]$");
+    QCOMPARE(proxy.count(), 7);
+
+    // Rows which follow each other in the source model are fetched together
+    QStringList roles = QStringList() << "display";
+    QCOMPARE(displays(proxy.rowData(0, 10, roles)), QStringList()
+        << "item0" << "item1" << "item2" << "item3" << "item7" << "item8" << "item9");
+    QCOMPARE(model.m_calls, RangeList() << Range(0, 4) << Range(7, 3));
+
+    model.m_calls.clear();
+    QCOMPARE(displays(proxy.rowData(2, 3, roles)), QStringList() << "item2" << "item3" << "item7");
+    QCOMPARE(model.m_calls, RangeList() << Range(2, 2) << Range(7, 1));
+
+    // Source models without rowData() are read through data()
+    QStandardItemModel plainModel;
+    fillModel(&plainModel, 10);
+    proxy.setModel(&plainModel);
+    QCOMPARE(displays(proxy.rowData(3, 2, roles)), QStringList() << "item3" << "item7");
+}
+
+#include <rowdatacachetest.moc>
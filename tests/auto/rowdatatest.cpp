@@ -0,0 +1,116 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "rowdatatest.h"
+
+// Local
+#include <rowdata.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QStandardItemModel>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(RowDataTest, NoGUI)
+
+enum {
+    FavoriteIdRole = Qt::UserRole + 1
+};
+
+class TestModel : public QStandardItemModel
+{
+public:
+    TestModel()
+    : m_lookupCount(0)
+    {
+        QHash<int, QByteArray> roles;
+        roles.insert(Qt::DisplayRole, "display");
+        roles.insert(FavoriteIdRole, "favoriteId");
+        setRoleNames(roles);
+        for (int row = 0; row < 5; ++row) {
+            QStandardItem *item = new QStandardItem(QString("item%1").arg(row));
+            item->setData(QString("app:item%1").arg(row), FavoriteIdRole);
+            appendRow(item);
+        }
+    }
+
+    QVariantList rowData(int first, int count, const QStringList &roleNames) const
+    {
+        return RowData::fetch(this, first, count, roleNames, &TestModel::itemAt, &TestModel::itemData);
+    }
+
+    QStandardItem *itemAt(int row) const
+    {
+        ++m_lookupCount;
+        return item(row);
+    }
+
+    QVariant itemData(QStandardItem *item, int role) const
+    {
+        return item->data(role);
+    }
+
+    mutable int m_lookupCount;
+};
+
+void RowDataTest::testRoleIds()
+{
+    TestModel model;
+    QVector<int> roles = RowData::roleIds(&model, QStringList() << "favoriteId" << "unknown" << "display");
+    QCOMPARE(roles, QVector<int>() << FavoriteIdRole << -1 << Qt::DisplayRole);
+}
+
+void RowDataTest::testFetch()
+{
+    TestModel model;
+    QVariantList rows = RowData::fetch(&model, 1, 2, QStringList() << "display" << "favoriteId" << "unknown");
+    QCOMPARE(rows.count(), 2);
+
+    QVariantMap map = rows.at(0).toMap();
+    QCOMPARE(map.count(), 2);
+    QCOMPARE(map.value("display").toString(), QString("item1"));
+    QCOMPARE(map.value("favoriteId").toString(), QString("app:item1"));
+
+    map = rows.at(1).toMap();
+    QCOMPARE(map.value("display").toString(), QString("item2"));
+}
+
+void RowDataTest::testFetchRange()
+{
+    TestModel model;
+    QStringList roles = QStringList() << "display";
+    QCOMPARE(RowData::fetch(&model, 3, 10, roles).count(), 2);
+    QCOMPARE(RowData::fetch(&model, -2, 3, roles).count(), 1);
+    QCOMPARE(RowData::fetch(&model, 5, 3, roles).count(), 0);
+}
+
+void RowDataTest::testFetchWithLookup()
+{
+    TestModel model;
+    QVariantList rows = model.rowData(0, 10, QStringList() << "display" << "favoriteId");
+    QCOMPARE(rows.count(), 5);
+    QCOMPARE(rows.at(4).toMap().value("favoriteId").toString(), QString("app:item4"));
+    // One lookup per row, not per role
+    QCOMPARE(model.m_lookupCount, 5);
+}
+
+#include "rowdatatest.moc"
@@ -0,0 +1,116 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <sessionswatchertest.h>
+
+// Local
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+
+QTEST_KDEMAIN(SessionsWatcherTest, NoGUI)
+
+static const char *LOGIND_SERVICE = "org.freedesktop.login1";
+static const char *LOGIND_PATH = "/org/freedesktop/login1";
+
+static SessEnt createSession(int vt, const QString &user)
+{
+    SessEnt session;
+    session.display = QString(":%1").arg(vt - 7);
+    session.user = user;
+    session.session = "KDE";
+    session.vt = vt;
+    session.self = false;
+    session.tty = false;
+    return session;
+}
+
+static bool waitForSessionCount(SessionsWatcher *watcher, int count)
+{
+    while (watcher->sessions().count() != count) {
+        if (!QTest::kWaitForSignal(watcher, SIGNAL(sessionsChanged()), 5000)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SessionsWatcherTest::init()
+{
+    m_logind = 0;
+    if (!QDBusConnection::sessionBus().isConnected()) {
+        QSKIP("No D-Bus session bus", SkipAll);
+    }
+}
+
+void SessionsWatcherTest::cleanup()
+{
+    if (m_logind) {
+        QDBusConnection bus = QDBusConnection::sessionBus();
+        bus.unregisterService(LOGIND_SERVICE);
+        bus.unregisterObject(LOGIND_PATH);
+        delete m_logind;
+        m_logind = 0;
+    }
+}
+
+void SessionsWatcherTest::testPollingWithoutLogind()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    QVERIFY(!bus.interface()->isServiceRegistered(LOGIND_SERVICE));
+    FakeSessionsWatcher watcher(bus);
+    QVERIFY(watcher.isPolling());
+}
+
+void SessionsWatcherTest::testLogindSignals()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    m_logind = new FakeLogind;
+    QVERIFY(bus.registerObject(LOGIND_PATH, m_logind, QDBusConnection::ExportAllSignals));
+    QVERIFY(bus.registerService(LOGIND_SERVICE));
+
+    FakeSessionsWatcher watcher(bus);
+    QVERIFY(!watcher.isPolling());
+    watcher.m_fakeSessions << createSession(7, "alice");
+    QVERIFY(waitForSessionCount(&watcher, 1));
+
+    // A new session is picked up without polling
+    watcher.m_fakeSessions << createSession(8, "bob");
+    m_logind->SessionNew("2", QDBusObjectPath("/org/freedesktop/login1/session/_32"));
+    QVERIFY(waitForSessionCount(&watcher, 2));
+    QCOMPARE(watcher.sessions().at(1).user, QString("bob"));
+
+    watcher.m_fakeSessions.removeLast();
+    m_logind->SessionRemoved("2", QDBusObjectPath("/org/freedesktop/login1/session/_32"));
+    QVERIFY(waitForSessionCount(&watcher, 1));
+
+    // Fall back to polling when logind goes away
+    bus.unregisterService(LOGIND_SERVICE);
+    for (int retry = 0; retry < 50 && !watcher.isPolling(); ++retry) {
+        QTest::qWait(100);
+    }
+    QVERIFY(watcher.isPolling());
+}
+
+#include <sessionswatchertest.moc>
@@ -0,0 +1,80 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SESSIONSWATCHERTEST_H
+#define SESSIONSWATCHERTEST_H
+
+// Local
+#include <sessionswatcher.h>
+
+// Qt
+#include <QDBusObjectPath>
+#include <QObject>
+
+/**
+ * Pretends to be systemd-logind
+ */
+class FakeLogind : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.freedesktop.login1.Manager")
+Q_SIGNALS:
+    void SessionNew(const QString &id, const QDBusObjectPath &path);
+    void SessionRemoved(const QString &id, const QDBusObjectPath &path);
+};
+
+/**
+ * A SessionsWatcher which returns a list of sessions set by the test instead
+ * of asking the display manager
+ */
+class FakeSessionsWatcher : public SessionsWatcher
+{
+    Q_OBJECT
+public:
+    FakeSessionsWatcher(const QDBusConnection &bus)
+    : SessionsWatcher(bus)
+    {}
+
+    SessList m_fakeSessions;
+
+protected:
+    void listSessions(SessList &sessions)
+    {
+        sessions = m_fakeSessions;
+    }
+};
+
+/**
+ * Runs on the session bus, which acts as the system bus. Run it with a private
+ * bus, for example using "dbus-launch --exit-with-session sessionswatchertest".
+ */
+class SessionsWatcherTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testPollingWithoutLogind();
+    void testLogindSignals();
+
+private:
+    FakeLogind *m_logind;
+};
+
+#endif /* SESSIONSWATCHERTEST_H */
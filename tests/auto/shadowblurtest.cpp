@@ -0,0 +1,190 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "shadowblurtest.h"
+
+// Local
+#include <shadowblur.h>
+
+// KDE
+#include <Plasma/PaintUtils>
+#include <qtest_kde.h>
+
+// Qt
+#include <QPainter>
+
+QTEST_KDEMAIN(ShadowBlurTest, NoGUI)
+
+Q_DECLARE_METATYPE(ShadowBlur::Implementation)
+
+static QImage createSourceImage(const QSize &size)
+{
+    // Something looking vaguely like text: a few opaque vertical strokes
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    QPainter painter(&image);
+    for (int x = 2; x < size.width() - 2; x += 5) {
+        painter.fillRect(x, 2, 2, size.height() - 4, Qt::white);
+    }
+    return image;
+}
+
+void ShadowBlurTest::testImplementationsMatch_data()
+{
+    QTest::addColumn<ShadowBlur::Implementation>("implementation");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("radius");
+
+    // Odd sizes exercise the scalar tails of the SIMD loops
+    QTest::newRow("sse2-label") << ShadowBlur::Sse2Implementation << QSize(123, 21) << 3;
+    QTest::newRow("sse2-icon") << ShadowBlur::Sse2Implementation << QSize(64, 64) << 5;
+    QTest::newRow("avx2-label") << ShadowBlur::Avx2Implementation << QSize(123, 21) << 3;
+    QTest::newRow("avx2-icon") << ShadowBlur::Avx2Implementation << QSize(64, 64) << 5;
+    QTest::newRow("avx2-tiny") << ShadowBlur::Avx2Implementation << QSize(7, 3) << 8;
+}
+
+void ShadowBlurTest::testImplementationsMatch()
+{
+    QFETCH(ShadowBlur::Implementation, implementation);
+    QFETCH(QSize, size);
+    QFETCH(int, radius);
+    if (!ShadowBlur::isSupported(implementation)) {
+        QSKIP("Implementation not supported by this CPU", SkipSingle);
+    }
+
+    QImage expected = createSourceImage(size);
+    ShadowBlur::blur(expected, radius, Qt::black, ShadowBlur::ScalarImplementation);
+    QImage image = createSourceImage(size);
+    ShadowBlur::blur(image, radius, Qt::black, implementation);
+    QCOMPARE(image, expected);
+}
+
+void ShadowBlurTest::testColor()
+{
+    QImage image(40, 40, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    QPainter painter(&image);
+    painter.fillRect(10, 10, 20, 20, Qt::white);
+    painter.end();
+
+    ShadowBlur::blur(image, 2, Qt::red);
+
+    // Inside of the square is still opaque, but red
+    QCOMPARE(image.pixel(20, 20), qRgba(255, 0, 0, 255));
+    // Far from the square is still transparent
+    QCOMPARE(qAlpha(image.pixel(0, 0)), 0);
+    // The edge is blurred
+    const int alpha = qAlpha(image.pixel(10, 20));
+    QVERIFY(alpha > 0);
+    QVERIFY(alpha < 255);
+}
+
+void ShadowBlurTest::testNoRadius()
+{
+    QImage image = createSourceImage(QSize(20, 10));
+    QImage expected = image;
+    ShadowBlur::blur(image, 0, Qt::white);
+    QCOMPARE(image, expected);
+}
+
+void ShadowBlurTest::testMatchesPlasma_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("2") << 2;
+    QTest::newRow("3") << 3;
+    QTest::newRow("5") << 5;
+    QTest::newRow("8") << 8;
+}
+
+void ShadowBlurTest::testMatchesPlasma()
+{
+    QFETCH(int, radius);
+    // A box blur does not have the same profile as the exponential blur of
+    // Plasma, but shadows must keep about the same size and softness
+    static const int MAX_DIFFERENCE = 40;
+    static const qreal MAX_MEAN_DIFFERENCE = 8;
+
+    QImage expected(48, 48, QImage::Format_ARGB32_Premultiplied);
+    expected.fill(0);
+    QPainter painter(&expected);
+    painter.fillRect(12, 12, 24, 24, Qt::white);
+    painter.end();
+    QImage image = expected;
+
+    Plasma::PaintUtils::shadowBlur(expected, radius, Qt::black);
+    ShadowBlur::blur(image, radius, Qt::black);
+
+    int maxDifference = 0;
+    qint64 totalDifference = 0;
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            const int difference = qAbs(qAlpha(image.pixel(x, y)) - qAlpha(expected.pixel(x, y)));
+            maxDifference = qMax(maxDifference, difference);
+            totalDifference += difference;
+        }
+    }
+    const qreal meanDifference = qreal(totalDifference) / (image.width() * image.height());
+    QVERIFY2(maxDifference <= MAX_DIFFERENCE, qPrintable(QString("Max difference: %1").arg(maxDifference)));
+    QVERIFY2(meanDifference <= MAX_MEAN_DIFFERENCE, qPrintable(QString("Mean difference: %1").arg(meanDifference)));
+}
+
+static void addBenchmarkRows()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("label") << QSize(160, 24) << 3;
+    QTest::newRow("icon") << QSize(64, 64) << 3;
+    QTest::newRow("big-icon") << QSize(128, 128) << 3;
+}
+
+void ShadowBlurTest::benchmarkPlasma_data()
+{
+    addBenchmarkRows();
+}
+
+void ShadowBlurTest::benchmarkPlasma()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, radius);
+    const QImage source = createSourceImage(size);
+    QBENCHMARK {
+        QImage image = source;
+        Plasma::PaintUtils::shadowBlur(image, radius, Qt::black);
+    }
+}
+
+void ShadowBlurTest::benchmarkShadowBlur_data()
+{
+    addBenchmarkRows();
+}
+
+void ShadowBlurTest::benchmarkShadowBlur()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, radius);
+    const QImage source = createSourceImage(size);
+    QBENCHMARK {
+        QImage image = source;
+        ShadowBlur::blur(image, radius, Qt::black);
+    }
+}
+
+#include "shadowblurtest.moc"
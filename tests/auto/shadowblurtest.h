@@ -0,0 +1,42 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SHADOWBLURTEST_H
+#define SHADOWBLURTEST_H
+
+#include <QObject>
+
+class ShadowBlurTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testImplementationsMatch_data();
+    void testImplementationsMatch();
+    void testColor();
+    void testNoRadius();
+    void testMatchesPlasma_data();
+    void testMatchesPlasma();
+    void benchmarkPlasma_data();
+    void benchmarkPlasma();
+    void benchmarkShadowBlur_data();
+    void benchmarkShadowBlur();
+};
+
+#endif /* SHADOWBLURTEST_H */
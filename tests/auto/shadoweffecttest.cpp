@@ -0,0 +1,158 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <shadoweffecttest.h>
+
+// Local
+#include <shadoweffect.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+
+QTEST_KDEMAIN(ShadowEffectTest, GUI)
+
+static const QSizeF ITEM_SIZE(80, 20);
+
+//- TextItem ---------------------------------------------------------------------
+QString TextItem::text() const
+{
+    return m_text;
+}
+
+void TextItem::setText(const QString &text)
+{
+    m_text = text;
+    update();
+}
+
+QRectF TextItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), ITEM_SIZE);
+}
+
+void TextItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    painter->setPen(Qt::white);
+    painter->drawText(boundingRect(), m_text);
+}
+
+//- RectItem ---------------------------------------------------------------------
+QRectF RectItem::boundingRect() const
+{
+    return QRectF(QPointF(0, 0), ITEM_SIZE);
+}
+
+void RectItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    painter->fillRect(boundingRect().adjusted(10, 5, -10, -5), Qt::white);
+}
+
+//- ShadowEffectTest -------------------------------------------------------------
+static void renderScene(QGraphicsScene *scene)
+{
+    QImage image(200, 200, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    QPainter painter(&image);
+    scene->render(&painter, QRectF(0, 0, 200, 200), QRectF(0, 0, 200, 200));
+}
+
+static ShadowEffect *createEffect()
+{
+    ShadowEffect *effect = new ShadowEffect;
+    effect->setColor(Qt::black);
+    effect->setBlurRadius(2);
+    return effect;
+}
+
+void ShadowEffectTest::testSharedTextShadows()
+{
+    QGraphicsScene scene;
+    TextItem *item1 = new TextItem;
+    item1->setText("Shared label");
+    item1->setGraphicsEffect(createEffect());
+    scene.addItem(item1);
+
+    TextItem *item2 = new TextItem;
+    item2->setText("Shared label");
+    item2->setGraphicsEffect(createEffect());
+    item2->setPos(0, 50);
+    scene.addItem(item2);
+
+    // Identical labels are only blurred once
+    int count = ShadowEffect::s_generatedShadowCount;
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 1);
+
+    // Repainting does not blur again, even if the items moved
+    item1->setPos(0, 100);
+    item2->update();
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 1);
+
+    // A different text gets its own shadow
+    item2->setText("Other label");
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 2);
+
+    // Changing a shadow parameter too
+    static_cast<ShadowEffect *>(item1->graphicsEffect())->setBlurRadius(3);
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 3);
+
+    // Going back to the first text uses the cached shadow
+    item2->setText("Shared label");
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 3);
+}
+
+void ShadowEffectTest::testPixmapShadows()
+{
+    QGraphicsScene scene;
+    RectItem *item1 = new RectItem;
+    item1->setGraphicsEffect(createEffect());
+    scene.addItem(item1);
+
+    RectItem *item2 = new RectItem;
+    item2->setGraphicsEffect(createEffect());
+    item2->setPos(0, 50);
+    scene.addItem(item2);
+
+    // Items without text are keyed by their source pixmap: each one gets its
+    // own shadow
+    int count = ShadowEffect::s_generatedShadowCount;
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 2);
+
+    // Repainting unchanged items does not blur again
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 2);
+
+    // An invalidated item gets a new source pixmap, so a new shadow
+    item1->update();
+    renderScene(&scene);
+    QCOMPARE(ShadowEffect::s_generatedShadowCount, count + 3);
+}
+
+#include <shadoweffecttest.moc>
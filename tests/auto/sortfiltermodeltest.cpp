@@ -0,0 +1,217 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <sortfiltermodeltest.h>
+
+// Local
+#include <datamodel.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+#include <QSignalSpy>
+
+using namespace Plasma;
+
+QTEST_KDEMAIN(SortFilterModelTest, NoGUI)
+
+static QStringList modelTexts(const QAbstractItemModel *model)
+{
+    QStringList lst;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        lst << model->index(row, 0).data().toString();
+    }
+    return lst;
+}
+
+//- ListModel ---------------------------------------------------------
+ListModel::ListModel(const QStringList &texts)
+: m_texts(texts)
+{
+}
+
+int ListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_texts.count();
+}
+
+QVariant ListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_texts.count() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    return m_texts.at(index.row());
+}
+
+void ListModel::insertText(int row, const QString &text)
+{
+    beginInsertRows(QModelIndex(), row, row);
+    m_texts.insert(row, text);
+    endInsertRows();
+}
+
+void ListModel::removeText(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    m_texts.removeAt(row);
+    endRemoveRows();
+}
+
+void ListModel::setText(int row, const QString &text)
+{
+    m_texts[row] = text;
+    const QModelIndex idx = index(row, 0);
+    dataChanged(idx, idx);
+}
+
+void ListModel::setTexts(const QStringList &texts)
+{
+    beginResetModel();
+    m_texts = texts;
+    endResetModel();
+}
+
+void ListModel::moveText(int from, int to)
+{
+    beginMoveRows(QModelIndex(), from, from, QModelIndex(), to);
+    m_texts.move(from, to > from ? to - 1 : to);
+    endMoveRows();
+}
+
+//- SortFilterModelTest -----------------------------------------------
+void SortFilterModelTest::testSourceChanges()
+{
+    ListModel source(QStringList() << "Kate" << "Dolphin");
+    SortFilterModel proxy;
+    proxy.setFilterMode(SortFilterModel::LiteralFilter);
+    proxy.setModel(&source);
+    proxy.setFilterRegExp("k");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate");
+
+    source.insertText(1, "Konsole");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate" << "Konsole");
+    source.insertText(0, "Gwenview");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate" << "Konsole");
+
+    // Source is now Kate, Konsole, Dolphin
+    source.removeText(0);
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate" << "Konsole");
+
+    source.setText(2, "Kdenlive");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate" << "Konsole" << "Kdenlive");
+    source.setText(0, "Dolphin");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Konsole" << "Kdenlive");
+
+    // Refining the query only checks the accepted rows, their keys must be
+    // up to date
+    proxy.setFilterRegExp("kd");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kdenlive");
+    proxy.setFilterRegExp("k");
+
+    source.setTexts(QStringList() << "Okular" << "Gwenview" << "Krita");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Okular" << "Krita");
+    proxy.setFilterRegExp("kr");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Krita");
+}
+
+void SortFilterModelTest::testSourceMove()
+{
+    ListModel source(QStringList() << "Kate" << "Konsole" << "Dolphin");
+    SortFilterModel proxy;
+    proxy.setFilterMode(SortFilterModel::LiteralFilter);
+    proxy.setModel(&source);
+    proxy.setFilterRegExp("k");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate" << "Konsole");
+
+    source.moveText(0, 2);
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Konsole" << "Kate");
+
+    // Keys follow the rows
+    proxy.setFilterRegExp("ka");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate");
+    proxy.setFilterRegExp("kon");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Konsole");
+}
+
+void SortFilterModelTest::testModeSwitch()
+{
+    ListModel source(QStringList() << "Kate" << "Konsole" << "Dolphin");
+    SortFilterModel proxy;
+    proxy.setModel(&source);
+    QSignalSpy spy(&proxy, SIGNAL(filterModeChanged()));
+    QCOMPARE(proxy.filterMode(), SortFilterModel::RegExpFilter);
+
+    proxy.setFilterRegExp("ke");
+    QCOMPARE(proxy.count(), 0);
+
+    // The query is kept when switching modes
+    proxy.setFilterMode(SortFilterModel::FuzzyFilter);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(proxy.filterRegExp(), QString("ke"));
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Kate" << "Konsole");
+
+    proxy.setFilterMode(SortFilterModel::PrefixFilter);
+    QCOMPARE(proxy.count(), 0);
+
+    proxy.setFilterRegExp("ko");
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Konsole");
+
+    proxy.setFilterMode(SortFilterModel::LiteralFilter);
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Konsole");
+
+    proxy.setFilterMode(SortFilterModel::RegExpFilter);
+    QCOMPARE(proxy.filterRegExp(), QString("ko"));
+    QCOMPARE(modelTexts(&proxy), QStringList() << "Konsole");
+
+    // Setting the current mode again does nothing
+    proxy.setFilterMode(SortFilterModel::RegExpFilter);
+    QCOMPARE(spy.count(), 4);
+}
+
+void SortFilterModelTest::testLiteralMatchesRegExp_data()
+{
+    QTest::addColumn<QString>("query");
+
+    QTest::newRow("empty") << QString();
+    QTest::newRow("letter") << "k";
+    QTest::newRow("case") << "KON";
+    QTest::newRow("middle") << "ph";
+    QTest::newRow("no-match") << "xyz";
+}
+
+void SortFilterModelTest::testLiteralMatchesRegExp()
+{
+    QFETCH(QString, query);
+    ListModel source(QStringList() << "Kate" << "Konsole" << "Dolphin" << "Okular" << "KWrite");
+
+    SortFilterModel regExpProxy;
+    regExpProxy.setModel(&source);
+    regExpProxy.setFilterRegExp(query);
+
+    SortFilterModel literalProxy;
+    literalProxy.setFilterMode(SortFilterModel::LiteralFilter);
+    literalProxy.setModel(&source);
+    literalProxy.setFilterRegExp(query);
+
+    QCOMPARE(modelTexts(&literalProxy), modelTexts(&regExpProxy));
+}
+
+#include <sortfiltermodeltest.moc>
@@ -0,0 +1,66 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SORTFILTERMODELTEST_H
+#define SORTFILTERMODELTEST_H
+
+// Local
+
+// Qt
+#include <QAbstractListModel>
+#include <QStringList>
+
+// KDE
+
+/**
+ * A flat list model which can move rows, unlike QStandardItemModel
+ */
+class ListModel : public QAbstractListModel
+{
+public:
+    ListModel(const QStringList &texts);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const; // reimp
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const; // reimp
+
+    void insertText(int row, const QString &text);
+    void removeText(int row);
+    void setText(int row, const QString &text);
+    void setTexts(const QStringList &texts);
+    /**
+     * Moves @p from before @p to, see QAbstractItemModel::beginMoveRows()
+     */
+    void moveText(int from, int to);
+
+private:
+    QStringList m_texts;
+};
+
+class SortFilterModelTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testSourceChanges();
+    void testSourceMove();
+    void testModeSwitch();
+    void testLiteralMatchesRegExp_data();
+    void testLiteralMatchesRegExp();
+};
+
+#endif /* SORTFILTERMODELTEST_H */
@@ -28,10 +28,33 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <qtest_kde.h>
 
 // Qt
-#include <QStandardItemModel>
+#include <QSignalSpy>
 
 QTEST_KDEMAIN(SourceModelTest, NoGUI)
 
+static QStandardItemModel *createModelWithRows(int rowCount, QObject *parent)
+{
+    QStandardItemModel *model = new QStandardItemModel(parent);
+    for (int row = 0; row < rowCount; ++row) {
+        model->appendRow(new QStandardItem(QString::number(row)));
+    }
+    return model;
+}
+
+GroupedMockModel::GroupedMockModel(const QList<int> &subModelRowCounts, QObject *parent)
+: QStandardItemModel(parent)
+{
+    Q_FOREACH(int rowCount, subModelRowCounts) {
+        appendRow(new QStandardItem(QString::number(rowCount)));
+        m_subModels << createModelWithRows(rowCount, this);
+    }
+}
+
+QObject *GroupedMockModel::modelForRow(int row) const
+{
+    return m_subModels.value(row);
+}
+
 class MockRegistry : public Homerun::AbstractSourceRegistry
 {
 public:
@@ -40,8 +63,22 @@ public:
         if (sourceId == "broken") {
             return 0;
         }
+        if (sourceId == "grouped") {
+            return new GroupedMockModel(QList<int>() << 3 << 4, parent);
+        }
+        if (sourceId == "flat") {
+            return createModelWithRows(5, parent);
+        }
         return new QStandardItemModel(parent);
     }
+
+    void releaseModel(QObject *model)
+    {
+        m_releasedModels << model;
+        delete model;
+    }
+
+    QList<QObject *> m_releasedModels;
 };
 
 void SourceModelTest::initTestCase()
@@ -72,4 +109,76 @@ void SourceModelTest::testAppendSource()
     QCOMPARE(sourceGroup.readEntry("sourceId"), QString("foo"));
 }
 
+void SourceModelTest::testReleaseModel()
+{
+    m_registry->m_releasedModels.clear();
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, "Tab0");
+    SourceModel *model = new SourceModel(m_registry, group, 0);
+    model->appendSource("foo");
+
+    QModelIndex index = model->index(0, 0);
+    QObject *sourceModel1 = index.data(SourceModel::ModelRole).value<QObject *>();
+    QVERIFY(sourceModel1);
+
+    // Recreating the model must release the old one
+    model->recreateModel(0);
+    QCOMPARE(m_registry->m_releasedModels, QList<QObject *>() << sourceModel1);
+
+    QObject *sourceModel2 = index.data(SourceModel::ModelRole).value<QObject *>();
+    QVERIFY(sourceModel2);
+
+    // Deleting the source model must release the current one
+    delete model;
+    QCOMPARE(m_registry->m_releasedModels, QList<QObject *>() << sourceModel1 << sourceModel2);
+}
+
+void SourceModelTest::testEvictModels()
+{
+    m_registry->m_releasedModels.clear();
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, "Tab0");
+    SourceModel model(m_registry, group, 0);
+    model.appendSource("foo");
+    QModelIndex index = model.index(0, 0);
+
+    // Models are not created before being accessed
+    QVERIFY(!model.hasLoadedModels());
+    model.preloadModels();
+    QVERIFY(model.hasLoadedModels());
+    QObject *sourceModel = index.data(SourceModel::ModelRole).value<QObject *>();
+    QVERIFY(sourceModel);
+
+    QSignalSpy spy(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+    model.evictModels();
+    QVERIFY(model.isEvicted());
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(m_registry->m_releasedModels, QList<QObject *>() << sourceModel);
+    QVERIFY(!index.data(SourceModel::ModelRole).value<QObject *>());
+    QVERIFY(!model.hasLoadedModels());
+    QCOMPARE(index.data(SourceModel::SourceIdRole).toString(), QString("foo"));
+
+    model.restoreModels();
+    QVERIFY(!model.isEvicted());
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(index.data(SourceModel::ModelRole).value<QObject *>());
+}
+
+void SourceModelTest::testLoadedRowCount()
+{
+    KConfig config(QString(), KConfig::SimpleConfig);
+    KConfigGroup group(&config, "Tab0");
+    SourceModel model(m_registry, group, 0);
+    model.appendSource("flat");
+    model.appendSource("grouped");
+    QCOMPARE(model.loadedRowCount(), 0);
+
+    // Rows of sub-models count as much as top-level rows
+    model.preloadModels();
+    QCOMPARE(model.loadedRowCount(), 5 + 2 + 3 + 4);
+
+    model.evictModels();
+    QCOMPARE(model.loadedRowCount(), 0);
+}
+
 #include <sourcemodeltest.moc>
@@ -24,11 +24,27 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 // Qt
 #include <QObject>
+#include <QStandardItemModel>
 
 // KDE
 
 class MockRegistry;
 
+/**
+ * A model showing its rows through sub-models, like GroupedInstalledAppsModel
+ */
+class GroupedMockModel : public QStandardItemModel
+{
+    Q_OBJECT
+public:
+    GroupedMockModel(const QList<int> &subModelRowCounts, QObject *parent);
+
+    Q_INVOKABLE QObject *modelForRow(int row) const;
+
+private:
+    QList<QStandardItemModel *> m_subModels;
+};
+
 class SourceModelTest : public QObject
 {
     Q_OBJECT
@@ -37,6 +53,9 @@ private Q_SLOTS:
     void initTestCase();
     void cleanupTestCase();
     void testAppendSource();
+    void testReleaseModel();
+    void testEvictModels();
+    void testLoadedRowCount();
 
 private:
     MockRegistry *m_registry;
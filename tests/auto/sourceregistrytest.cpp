@@ -0,0 +1,296 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+// Self
+#include <sourceregistrytest.h>
+
+// Local
+#include <sourceregistry.h>
+
+// KDE
+#include <KConfig>
+#include <KConfigGroup>
+#include <KGlobal>
+#include <KStandardDirs>
+#include <KSycoca>
+#include <KTempDir>
+#include <qtest_kde.h>
+
+// Qt
+#include <QAbstractItemModel>
+#include <QAbstractProxyModel>
+#include <QMetaProperty>
+#include <QProcess>
+#include <QSignalSpy>
+
+using namespace Homerun;
+
+QTEST_KDEMAIN(SourceRegistryTest, GUI)
+
+static const char *OPEN_SOURCE_REQUESTED_SIGNATURE = "openSourceRequested(QString,QVariantMap)";
+
+// The plugin source built with Homerun
+static const char *PLUGIN_SOURCE_ID = "RecentDocuments";
+
+static QStringList sourceIds(SourceRegistry *registry)
+{
+    QAbstractItemModel *model = qobject_cast<QAbstractItemModel *>(registry->availableSourcesModel());
+    Q_ASSERT(model);
+    const int role = model->roleNames().key("sourceId");
+    QStringList ids;
+    for (int row = 0; row < model->rowCount(); ++row) {
+        ids << model->index(row, 0).data(role).toString();
+    }
+    return ids;
+}
+
+// Returns the shared model @p object stands for, if it is a view proxy
+static QObject *sharedModel(QObject *object)
+{
+    QAbstractProxyModel *proxy = qobject_cast<QAbstractProxyModel *>(object);
+    return proxy ? proxy->sourceModel() : object;
+}
+
+static KConfigGroup createSourceGroup(KConfig *config, const QString &name, const QString &sourceId)
+{
+    KConfigGroup group(config, name);
+    group.writeEntry("sourceId", sourceId);
+    return group;
+}
+
+void SourceRegistryTest::initTestCase()
+{
+    m_tempDir = new KTempDir("sourceregistrytest");
+}
+
+void SourceRegistryTest::cleanupTestCase()
+{
+    delete m_tempDir;
+}
+
+void SourceRegistryTest::testShareableModelsHaveNoViewState()
+{
+    SourceRegistry registry;
+    KConfig config(m_tempDir->name() + "shareablerc", KConfig::SimpleConfig);
+
+    QStringList shareableIds;
+    Q_FOREACH(const QString &id, sourceIds(&registry)) {
+        if (registry.isSourceShareable(id)) {
+            shareableIds << id;
+        }
+    }
+    QVERIFY(shareableIds.contains("Power"));
+    QVERIFY(shareableIds.contains("InstalledApps"));
+    QVERIFY(shareableIds.contains("GroupedInstalledApps"));
+    QVERIFY(shareableIds.contains("RecentApps"));
+    // The query of the view drives their content
+    QVERIFY(!shareableIds.contains("Runner"));
+    QVERIFY(!shareableIds.contains("Dir"));
+
+    // Recent apps models are only shared by views of the same group, see
+    // testRecentAppsModelsAreSharedByGroup()
+    shareableIds.removeOne("RecentApps");
+
+    Q_FOREACH(const QString &id, shareableIds) {
+        KConfigGroup group1 = createSourceGroup(&config, id + "1", id);
+        KConfigGroup group2 = createSourceGroup(&config, id + "2", id);
+        QObject parent1, parent2;
+        QObject *model1 = registry.createModelFromConfigGroup(id, group1, &parent1);
+        QObject *model2 = registry.createModelFromConfigGroup(id, group2, &parent2);
+        QVERIFY(model1);
+        QVERIFY(model2);
+        QCOMPARE(sharedModel(model1), sharedModel(model2));
+        if (model1 != model2) {
+            // Each view has its own proxy, which holds its state
+            QCOMPARE(model1->parent(), &parent1);
+            QCOMPARE(model2->parent(), &parent2);
+            registry.releaseModel(model1);
+            registry.releaseModel(model2);
+            continue;
+        }
+
+        // Views of a shared model must not be able to change each other: the
+        // model can have neither writable properties nor navigation signals
+        const QMetaObject *metaObject = model1->metaObject();
+        for (int idx = QObject::staticMetaObject.propertyCount(); idx < metaObject->propertyCount(); ++idx) {
+            QMetaProperty property = metaObject->property(idx);
+            QVERIFY2(!property.isWritable(), qPrintable(id + ": " + property.name() + " is writable"));
+        }
+        QVERIFY2(metaObject->indexOfSignal(OPEN_SOURCE_REQUESTED_SIGNATURE) == -1, qPrintable(id));
+
+        registry.releaseModel(model1);
+        registry.releaseModel(model2);
+    }
+}
+
+void SourceRegistryTest::testInstalledAppsViewsAreIndependent_data()
+{
+    QTest::addColumn<QString>("sourceId");
+    QTest::newRow("InstalledApps") << "InstalledApps";
+    QTest::newRow("GroupedInstalledApps") << "GroupedInstalledApps";
+}
+
+void SourceRegistryTest::testInstalledAppsViewsAreIndependent()
+{
+    QFETCH(QString, sourceId);
+    SourceRegistry registry;
+    KConfig config(m_tempDir->name() + "installedappsrc", KConfig::SimpleConfig);
+
+    // Two views with the same configuration
+    QObject parent1, parent2;
+    QObject *model1 = registry.createModelFromConfigGroup(sourceId, createSourceGroup(&config, "Source1", sourceId), &parent1);
+    QObject *model2 = registry.createModelFromConfigGroup(sourceId, createSourceGroup(&config, "Source2", sourceId), &parent2);
+    QVERIFY(model1);
+    QVERIFY(model2);
+    QVERIFY(model1 != model2);
+    QCOMPARE(sharedModel(model1), sharedModel(model2));
+
+    // GroupedInstalledApps shows its groups through sub-models
+    QAbstractItemModel *itemModel = qobject_cast<QAbstractItemModel *>(model1);
+    if (model1->metaObject()->indexOfMethod("modelForRow(int)") >= 0) {
+        if (itemModel->rowCount() == 0) {
+            QSKIP("No application installed", SkipSingle);
+        }
+        QObject *subModel1 = 0, *subModel2 = 0;
+        QMetaObject::invokeMethod(model1, "modelForRow", Q_RETURN_ARG(QObject *, subModel1), Q_ARG(int, 0));
+        QMetaObject::invokeMethod(model2, "modelForRow", Q_RETURN_ARG(QObject *, subModel2), Q_ARG(int, 0));
+        QVERIFY(subModel1);
+        QVERIFY(subModel1 != subModel2);
+        QCOMPARE(sharedModel(subModel1), sharedModel(subModel2));
+        model1 = subModel1;
+        model2 = subModel2;
+        itemModel = qobject_cast<QAbstractItemModel *>(model1);
+    }
+
+    // Kicker sets the containment of the model of its view
+    QObject containment;
+    model1->setProperty("containment", QVariant::fromValue<QObject *>(&containment));
+    QCOMPARE(model1->property("containment").value<QObject *>(), &containment);
+    QCOMPARE(model2->property("containment").value<QObject *>(), static_cast<QObject *>(0));
+
+    // Opening a group only navigates the view which triggered it
+    const int favoriteIdRole = itemModel->roleNames().key("favoriteId");
+    int groupRow = -1;
+    for (int row = 0; row < itemModel->rowCount(); ++row) {
+        // Applications have a favorite id, groups do not
+        if (itemModel->index(row, 0).data(favoriteIdRole).toString().isEmpty()) {
+            groupRow = row;
+            break;
+        }
+    }
+    if (groupRow == -1) {
+        QSKIP("No application group installed", SkipSingle);
+    }
+    QSignalSpy spy1(model1, SIGNAL(openSourceRequested(QString,QVariantMap)));
+    QSignalSpy spy2(model2, SIGNAL(openSourceRequested(QString,QVariantMap)));
+    bool ok = false;
+    QMetaObject::invokeMethod(model1, "trigger", Q_RETURN_ARG(bool, ok),
+        Q_ARG(int, groupRow), Q_ARG(QString, QString()), Q_ARG(QVariant, QVariant()));
+    QCOMPARE(spy1.count(), 1);
+    QCOMPARE(spy2.count(), 0);
+}
+
+void SourceRegistryTest::testRecentAppsModelsAreSharedByGroup()
+{
+    SourceRegistry registry;
+    KConfig config(m_tempDir->name() + "recentappsrc", KConfig::SimpleConfig);
+    KConfigGroup group1 = createSourceGroup(&config, "Source1", "RecentApps");
+    KConfigGroup group2 = createSourceGroup(&config, "Source2", "RecentApps");
+
+    // Views of the same group share the model, but not its containment
+    QObject *model1 = registry.createModelFromConfigGroup("RecentApps", group1, 0);
+    QObject *sameGroupModel = registry.createModelFromConfigGroup("RecentApps", group1, 0);
+    QVERIFY(model1);
+    QVERIFY(model1 != sameGroupModel);
+    QCOMPARE(sharedModel(model1), sharedModel(sameGroupModel));
+    QObject containment;
+    model1->setProperty("containment", QVariant::fromValue<QObject *>(&containment));
+    QCOMPARE(sameGroupModel->property("containment").value<QObject *>(), static_cast<QObject *>(0));
+
+    // Models store their list in their group: groups with the same entries
+    // must not share them
+    QObject *model2 = registry.createModelFromConfigGroup("RecentApps", group2, 0);
+    QVERIFY(sharedModel(model2) != sharedModel(model1));
+
+    registry.releaseModel(model1);
+    registry.releaseModel(sameGroupModel);
+    registry.releaseModel(model2);
+}
+
+void SourceRegistryTest::testPreloadConfiguredPlugins_data()
+{
+    QTest::addColumn<QString>("tabs");
+    QTest::addColumn<QString>("sources");
+    QTest::addColumn<bool>("preloaded");
+    QTest::newRow("listed") << "Tab0" << "Source0" << true;
+    // Groups of removed tabs and sources stay in the config
+    QTest::newRow("removed-tab") << "" << "Source0" << false;
+    QTest::newRow("removed-source") << "Tab0" << "" << false;
+}
+
+void SourceRegistryTest::testPreloadConfiguredPlugins()
+{
+    QFETCH(QString, tabs);
+    QFETCH(QString, sources);
+    QFETCH(bool, preloaded);
+
+    SourceRegistry registry;
+    if (!sourceIds(&registry).contains(PLUGIN_SOURCE_ID)) {
+        QSKIP("The RecentDocuments plugin is not installed", SkipAll);
+    }
+
+    const QString configFileName = m_tempDir->name() + "preload-" + QTest::currentDataTag() + "rc";
+    {
+        KConfig config(configFileName, KConfig::SimpleConfig);
+        config.group("General").writeEntry("tabs", tabs);
+        KConfigGroup tabGroup(&config, "Tab0");
+        tabGroup.writeEntry("sources", sources);
+        KConfigGroup sourceGroup(&tabGroup, "Source0");
+        sourceGroup.writeEntry("sourceId", PLUGIN_SOURCE_ID);
+    }
+    registry.setConfigFileName(configFileName);
+    QCOMPARE(registry.pendingPluginPreloads().contains(PLUGIN_SOURCE_ID), preloaded);
+
+    // Using the source picks up the library loaded by the worker thread
+    registry.isSourceConfigurable(PLUGIN_SOURCE_ID);
+    QVERIFY(!registry.pendingPluginPreloads().contains(PLUGIN_SOURCE_ID));
+}
+
+void SourceRegistryTest::testPluginMetadataCacheFollowsSycoca()
+{
+    const QString kbuildsycoca = KGlobal::dirs()->findExe("kbuildsycoca4");
+    if (kbuildsycoca.isEmpty()) {
+        QSKIP("kbuildsycoca4 not found", SkipAll);
+    }
+
+    // Registries share the metadata as long as sycoca does not change
+    delete new SourceRegistry;
+    const int queryCount = SourceRegistry::pluginMetadataQueryCount();
+    QVERIFY(queryCount > 0);
+    delete new SourceRegistry;
+    QCOMPARE(SourceRegistry::pluginMetadataQueryCount(), queryCount);
+
+    // Rebuilding sycoca invalidates it
+    QProcess::execute(kbuildsycoca, QStringList() << "--noincremental");
+    QVERIFY(QTest::kWaitForSignal(KSycoca::self(), SIGNAL(databaseChanged(QStringList)), 10000));
+    delete new SourceRegistry;
+    QCOMPARE(SourceRegistry::pluginMetadataQueryCount(), queryCount + 1);
+}
+
+#include <sourceregistrytest.moc>
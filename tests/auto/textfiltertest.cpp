@@ -0,0 +1,136 @@
+/*
+Copyright 2013 Aurélien Gâteau <agateau@kde.org>
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of
+the License or (at your option) version 3 or any later version
+accepted by the membership of KDE e.V. (or its successor approved
+by the membership of KDE e.V.), which shall act as a proxy
+defined in Section 14 of version 3 of the license.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "textfiltertest.h"
+
+// Local
+#include <textfilter.h>
+
+// KDE
+#include <qtest_kde.h>
+
+// Qt
+
+using namespace HomerunInternal;
+
+QTEST_KDEMAIN(TextFilterTest, NoGUI)
+
+Q_DECLARE_METATYPE(TextFilter::Mode)
+
+void TextFilterTest::testMatch_data()
+{
+    QTest::addColumn<TextFilter::Mode>("mode");
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<bool>("expected");
+
+    QTest::newRow("literal-empty") << TextFilter::LiteralMode << "Report.odt" << "" << true;
+    QTest::newRow("literal-case") << TextFilter::LiteralMode << "Report.odt" << "rEPORT" << true;
+    QTest::newRow("literal-middle") << TextFilter::LiteralMode << "Report.odt" << "port" << true;
+    QTest::newRow("literal-regexp-chars") << TextFilter::LiteralMode << "notes (old).txt" << "(old)" << true;
+    QTest::newRow("literal-no-dot-wildcard") << TextFilter::LiteralMode << "Report.odt" << "rt.o.t" << false;
+    QTest::newRow("literal-subsequence") << TextFilter::LiteralMode << "Report.odt" << "rpt" << false;
+    QTest::newRow("prefix") << TextFilter::PrefixMode << "Report.odt" << "rep" << true;
+    QTest::newRow("prefix-middle") << TextFilter::PrefixMode << "Report.odt" << "port" << false;
+    QTest::newRow("fuzzy-literal") << TextFilter::FuzzyMode << "Report.odt" << "port" << true;
+    QTest::newRow("fuzzy-subsequence") << TextFilter::FuzzyMode << "Report.odt" << "rpt" << true;
+    QTest::newRow("fuzzy-wrong-order") << TextFilter::FuzzyMode << "Report.odt" << "tpr" << false;
+}
+
+void TextFilterTest::testMatch()
+{
+    QFETCH(TextFilter::Mode, mode);
+    QFETCH(QString, text);
+    QFETCH(QString, query);
+    QFETCH(bool, expected);
+
+    TextFilter filter(mode);
+    filter.setTexts(QStringList() << text);
+    filter.setQuery(query);
+    QCOMPARE(filter.isAccepted(0), expected);
+}
+
+void TextFilterTest::testScoreOrder()
+{
+    TextFilter filter(TextFilter::FuzzyMode);
+    filter.setTexts(QStringList()
+        << "sportreport"    // 0: substring
+        << "report"         // 1: prefix
+        << "annual-report"  // 2: word start
+        << "ReallyPoorTool" // 3: subsequence
+        );
+    filter.setQuery("report");
+    QVERIFY(filter.score(1) > filter.score(2));
+    QVERIFY(filter.score(2) > filter.score(0));
+    QVERIFY(filter.score(0) > filter.score(3));
+
+    filter.setQuery("rpt");
+    QVERIFY(filter.isAccepted(3));
+    QVERIFY(filter.score(3) > filter.score(0));
+}
+
+void TextFilterTest::testRefine()
+{
+    TextFilter filter;
+    filter.setTexts(QStringList() << "abc" << "abd" << "xyz");
+
+    QVERIFY(filter.setQuery("a"));
+    QVERIFY(filter.isAccepted(0));
+    QVERIFY(filter.isAccepted(1));
+    QVERIFY(!filter.isAccepted(2));
+
+    QVERIFY(filter.setQuery("ab"));
+    QVERIFY(filter.isAccepted(0));
+    QVERIFY(filter.isAccepted(1));
+    QVERIFY(!filter.isAccepted(2));
+
+    QVERIFY(filter.setQuery("abc"));
+    QVERIFY(filter.isAccepted(0));
+    QVERIFY(!filter.isAccepted(1));
+
+    // Shrinking the query must bring back rejected rows
+    QVERIFY(filter.setQuery("ab"));
+    QVERIFY(filter.isAccepted(1));
+
+    QVERIFY(!filter.setQuery("ab"));
+}
+
+void TextFilterTest::testRowChanges()
+{
+    TextFilter filter;
+    filter.setTexts(QStringList() << "one" << "two");
+    filter.setQuery("o");
+
+    filter.insertTexts(1, QStringList() << "three" << "four");
+    QCOMPARE(filter.count(), 4);
+    QVERIFY(filter.isAccepted(0));
+    QVERIFY(!filter.isAccepted(1));
+    QVERIFY(filter.isAccepted(2));
+    QVERIFY(filter.isAccepted(3));
+
+    filter.removeRows(0, 1);
+    QCOMPARE(filter.count(), 2);
+    QVERIFY(filter.isAccepted(0));
+    QVERIFY(filter.isAccepted(1));
+
+    filter.updateText(0, "five");
+    QVERIFY(!filter.isAccepted(0));
+}
+
+#include "textfiltertest.moc"